@@ -4,20 +4,37 @@
       "target_name": "tensai",
       "sources": [
         "src/tensai.cpp",
-        "src/core/vec2.cpp",
+        "src/core/batch.cpp",
         "src/core/color.cpp",
+        "src/core/frame_arena.cpp",
+        "src/core/thread_pool.cpp",
         "src/core/transform.cpp",
         "src/resources/texture.cpp",
+        "src/resources/texture_cache.cpp",
         "src/resources/font.cpp",
         "src/resources/sound.cpp",
         "src/resources/music.cpp",
+        "src/resources/asset_pack.cpp",
         "src/modules/input.cpp",
+        "src/modules/input_log.cpp",
         "src/modules/camera.cpp",
+        "src/modules/capture.cpp",
         "src/modules/graphics.cpp",
         "src/modules/timer.cpp",
+        "src/modules/noise.cpp",
         "src/modules/random.cpp",
+        "src/modules/rasterizer.cpp",
+        "src/modules/render_thread.cpp",
+        "src/modules/simulation.cpp",
         "src/modules/physics.cpp",
+        "src/modules/physics_world.cpp",
+        "src/modules/spatial_index.cpp",
+        "src/modules/tile_map.cpp",
+        "src/modules/assets.cpp",
         "src/modules/audio.cpp",
+        "src/modules/ecs.cpp",
+        "src/modules/music_loader.cpp",
+        "src/modules/texture_residency.cpp",
       ],
       "include_dirs": [
         "<!@(node -p \"require('node-addon-api').include\")"
@@ -20,6 +20,159 @@ export interface Transform {
   originY?: number;
 }
 
+export interface AudioStats {
+  voices: number;
+  activeVoices: number;
+  peakVoices: number;
+  played: number;
+  stolen: number;
+  dropped: number;
+  frequency: number;
+  bufferFrames: number;
+  bufferMs: number;
+  mixCallbacks: number;
+  underruns: number;
+  avgCallbackGapMs: number;
+  maxCallbackGapMs: number;
+}
+
+export interface EcsStats {
+  entities: number;
+  archetypes: number;
+}
+
+export interface RenderStats {
+  backend: "sdl" | "software";
+  threaded: boolean;
+  commands: number;
+  presentWaitMs: number;
+  retained: boolean;
+  dirty: { x: number; y: number; width: number; height: number };
+  dirtyRects: number;
+  arena: { used: number; capacity: number; highWater: number };
+}
+
+export interface CaptureStats {
+  recording: boolean;
+  captured: number;
+  dropped: number;
+  written: number;
+  failed: number;
+  pending: number;
+}
+
+export interface CaptureOptions {
+  format?: "png" | "y4m" | "rgba";
+  buffers?: number;
+  threads?: number;
+  fps?: number;
+}
+
+export interface InputStats {
+  recording: boolean;
+  replaying: boolean;
+  recordFrame: number;
+  replayFrame: number;
+}
+
+export interface RecordingOptions {
+  seed?: number;
+  timestep?: number;
+}
+
+export interface EngineStats {
+  audio: AudioStats;
+  render: RenderStats;
+  capture: CaptureStats;
+  input: InputStats;
+  ecs: EcsStats;
+}
+
+export interface EngineOptions {
+  audioLatency?: "default" | "low";
+  audioFrequency?: number;
+  audioBufferFrames?: number;
+  renderThread?: boolean;
+  renderer?: "sdl" | "software";
+  rasterThreads?: number;
+}
+
+export interface NoiseOptions {
+  type?: "value" | "perlin" | "simplex";
+  octaves?: number;
+  frequency?: number;
+  lacunarity?: number;
+  gain?: number;
+}
+
+export interface NoiseGridOptions extends NoiseOptions {
+  x?: number;
+  y?: number;
+  z?: number;
+  step?: number;
+  threads?: number;
+}
+
+export interface TileBody {
+  x: number;
+  y: number;
+  width: number;
+  height: number;
+  vx?: number;
+  vy?: number;
+}
+
+export interface TileContact {
+  x: number;
+  y: number;
+  tileX: number;
+  tileY: number;
+}
+
+export interface MoveResult {
+  dx: number;
+  dy: number;
+  grounded: boolean;
+  contacts: TileContact[];
+}
+
+export interface BodyOptions {
+  x?: number;
+  y?: number;
+  vx?: number;
+  vy?: number;
+  radius?: number;
+  width?: number;
+  height?: number;
+  mass?: number;
+  friction?: number;
+  restitution?: number;
+  kinematic?: boolean;
+  bullet?: boolean;
+}
+
+export interface EntityProps {
+  x?: number;
+  y?: number;
+  rotation?: number;
+  scaleX?: number;
+  scaleY?: number;
+  vx?: number;
+  vy?: number;
+  life?: number;
+  halfWidth?: number;
+  halfHeight?: number;
+  texture?: string | number;
+  tint?: number;
+}
+
+export interface EntityState extends Omit<EntityProps, 'texture'> {
+  mask: number;
+  texture?: number;
+}
+
+export type EntityField = keyof EntityState | 'entity';
+
 export declare class TensaiEngine {
   constructor(
     title: string,
@@ -27,6 +180,7 @@ export declare class TensaiEngine {
     height: number,
     fullscreen: boolean,
     vsync: boolean,
+    options?: EngineOptions,
   );
 
   load: (() => void) | null;
@@ -41,10 +195,29 @@ export declare class TensaiEngine {
   setTitle(title: string): void;
   setFullscreen(fullscreen: boolean): void;
 
+  mountPack(path: string): boolean;
+  setTextureCache(directory: string | null, premultiply?: boolean): void;
+  setTextureBudget(bytes: number): void;
+  setTexturePlaceholder(r: number, g: number, b: number, a?: number): void;
   loadTexture(path: string): string | undefined;
   loadFont(path: string, size: number): string | undefined;
-  loadSound(path: string): string | undefined;
+  loadSound(path: string, bank?: string): string | undefined;
   loadMusic(path: string): string | undefined;
+  unloadSound(path: string): void;
+  unloadSoundBank(bank: string): void;
+  unloadMusic(path: string): void;
+  getSoundBanks(): Record<string, { sounds: number; bytes: number }>;
+  unloadTexture(texture: string): void;
+  unloadFont(font: string): void;
+  getMemoryStats(): {
+    textures: { count: number; bytes: number };
+    fonts: { count: number; bytes: number };
+    sounds: { count: number; bytes: number };
+    music: { count: number; bytes: number };
+    total: number;
+    budget: { soft: number; hard: number };
+  };
+  setMemoryBudget(softBytes: number, hardBytes?: number): void;
 
   isKeyDown(key: number): boolean;
   isKeyPressed(key: number): boolean;
@@ -61,6 +234,11 @@ export declare class TensaiEngine {
   getDelta(): number;
   getTime(): number;
   getFPS(): number;
+  setFixedTimestep(seconds: number): void;
+  startRecording(path: string, options?: RecordingOptions): boolean;
+  stopRecording(): boolean;
+  startReplay(path: string): boolean;
+  stopReplay(): void;
 
   clear(r?: number, g?: number, b?: number, a?: number): void;
   setColor(r: number, g: number, b: number, a?: number): void;
@@ -92,6 +270,24 @@ export declare class TensaiEngine {
     angleUnit?: "radians" | "degrees",
   ): void;
 
+  createCanvas(width: number, height: number): string | undefined;
+  setCanvas(canvas?: string | null): void;
+  drawCanvas(
+    canvas: string,
+    x: number,
+    y: number,
+    rotation?: number,
+    scaleX?: number,
+    scaleY?: number,
+    originX?: number,
+    originY?: number,
+    tintR?: number,
+    tintG?: number,
+    tintB?: number,
+    tintA?: number,
+    angleUnit?: "radians" | "degrees",
+  ): void;
+
   drawText(
     text: string,
     x: number,
@@ -104,14 +300,180 @@ export declare class TensaiEngine {
 
   setFont(fontKey: string): void;
 
+  setDeferred(enabled: boolean): void;
+  setLayer(layer: number): void;
+  flush(): void;
+  setRenderThread(enabled: boolean): void;
+  setRetained(enabled: boolean): void;
+  setIdleFrameRate(fps: number): void;
+  invalidate(): void;
+  startCapture(path: string, options?: CaptureOptions): boolean;
+  stopCapture(): void;
+
   playSound(path: string, volume?: number): void;
+  playSoundAt(path: string, emitter: number, volume?: number): number;
   playMusic(path: string, loops?: number): void;
   stopMusic(): void;
+  preloadMusic(path: string): void;
+  crossfadeMusic(path: string, fadeMs: number, loops?: number): void;
+  setMusicLoopPoints(start: number, end: number): void;
   setMusicVolume(volume: number): void;
+  setVoices(count: number): void;
+  setVoiceStealPolicy(policy: "oldest" | "quietest"): void;
+  setSoundPriority(path: string, priority: number): void;
+  setSoundMaxInstances(path: string, maxInstances: number): void;
+
+  createEmitter(x: number, y: number, range: number): number;
+  destroyEmitter(emitter: number): void;
+  setEmitterPosition(emitter: number, x: number, y: number): void;
+  setEmitterPositions(ids: Int32Array, positions: Float32Array): void;
+  setCamera(x: number, y: number, rotation?: number, zoom?: number): void;
+
+  createSpatialIndex(cellSize?: number): number;
+  destroySpatialIndex(index: number): void;
+  buildSpatialIndex(index: number, boxes: Float32Array): void;
+  updateSpatialIndex(
+    index: number,
+    id: number,
+    minX: number,
+    minY: number,
+    maxX: number,
+    maxY: number,
+  ): void;
+  removeFromSpatialIndex(index: number, id: number): void;
+  queryAABB(
+    index: number,
+    minX: number,
+    minY: number,
+    maxX: number,
+    maxY: number,
+  ): Int32Array;
+  queryCircle(index: number, x: number, y: number, radius: number): Int32Array;
+  raycast(
+    index: number,
+    x: number,
+    y: number,
+    dx: number,
+    dy: number,
+    maxDistance?: number,
+  ): Int32Array;
+  queryPairs(index: number): Int32Array;
+
+  createTileMap(
+    width: number,
+    height: number,
+    tileSize: number,
+    originX?: number,
+    originY?: number,
+  ): number;
+  destroyTileMap(map: number): void;
+  setTiles(map: number, tiles: Uint8Array): void;
+  setTile(map: number, x: number, y: number, tile: number): void;
+  getTile(map: number, x: number, y: number): number;
+  moveAndCollide(map: number, body: TileBody, dx: number, dy: number): MoveResult;
+
+  createPhysicsWorld(cellSize?: number): number;
+  destroyPhysicsWorld(world: number): void;
+  setGravity(world: number, x: number, y: number): void;
+  addBody(world: number, options: BodyOptions): number;
+  removeBody(world: number, body: number): void;
+  setBodyPosition(world: number, body: number, x: number, y: number): void;
+  setBodyVelocity(world: number, body: number, vx: number, vy: number): void;
+  setBodyBullet(world: number, body: number, bullet: boolean): void;
+  applyForce(world: number, body: number, fx: number, fy: number): void;
+  getBodyStates(world: number, out: Float32Array): Float32Array;
+  stepPhysics(world: number, dt: number): Int32Array;
+
+  getTextureId(texture: string): number;
+  createEntity(mask: number, props?: EntityProps): number;
+  createEntities(count: number, mask: number, props?: EntityProps): Uint32Array;
+  destroyEntity(entity: number): void;
+  isEntityAlive(entity: number): boolean;
+  addComponents(entity: number, mask: number, props?: EntityProps): void;
+  removeComponents(entity: number, mask: number): void;
+  setEntity(entity: number, props: EntityProps): void;
+  getEntity(entity: number): EntityState | undefined;
+  getArchetypes(mask?: number): Int32Array;
+  getArchetypeMask(archetype: number): number;
+  getArchetypeSize(archetype: number): number;
+  getColumn(archetype: number, field: 'texture'): Int32Array | undefined;
+  getColumn(archetype: number, field: 'tint' | 'entity'): Uint32Array | undefined;
+  getColumn(archetype: number, field: EntityField): Float32Array | undefined;
+  updateEntities(dt?: number): Uint32Array;
+  cullEntities(x: number, y: number, width: number, height: number, mask?: number): Uint32Array;
+  collideEntities(maskA: number, maskB: number): Uint32Array;
+  drawEntities(): void;
+
+  getStats(): EngineStats;
 
   randomInt(min: number, max: number): number;
   randomFloat(min?: number, max?: number): number;
   randomBool(): boolean;
+  setSeed(seed: number): void;
+  getSeed(): number;
+  fillRandomFloat(out: Float32Array, min?: number, max?: number): Float32Array;
+  fillRandomInt(out: Int32Array, min: number, max: number): Int32Array;
+
+  noise(x: number, options?: NoiseOptions): number;
+  noise(x: number, y: number, options?: NoiseOptions): number;
+  noise(x: number, y: number, z: number, options?: NoiseOptions): number;
+  fillNoise(
+    out: Float32Array,
+    width: number,
+    height: number,
+    options?: NoiseGridOptions,
+  ): Float32Array;
+  sampleNoise(
+    points: Float32Array,
+    out: Float32Array,
+    dimensions: 1 | 2 | 3,
+    options?: NoiseOptions,
+  ): Float32Array;
+  createNoiseTexture(
+    width: number,
+    height: number,
+    options?: NoiseGridOptions,
+  ): string | undefined;
+  updateNoiseTexture(texture: string, options?: NoiseGridOptions): boolean;
+}
+
+export interface SimulationOptions {
+  seed?: number;
+  cellSize?: number;
+  timestep?: number;
+}
+
+export interface SimulationSnapshot {
+  tick: number;
+  time: number;
+  bodies: Float32Array;
+  contacts: Int32Array;
+}
+
+export declare class Simulation {
+  constructor(options?: SimulationOptions);
+
+  static stepAll(simulations: Simulation[], ticks?: number): SimulationSnapshot[];
+
+  step(ticks?: number): SimulationSnapshot;
+  getTick(): number;
+  getTime(): number;
+  setGravity(x: number, y: number): void;
+  addBody(options: BodyOptions): number;
+  removeBody(body: number): void;
+  setBodyPosition(body: number, x: number, y: number): void;
+  setBodyVelocity(body: number, vx: number, vy: number): void;
+  applyForce(body: number, fx: number, fy: number): void;
+  setKey(key: number, pressed: boolean, tick?: number): void;
+  setMouse(button: number, pressed: boolean, tick?: number): void;
+  isKeyDown(key: number): boolean;
+  isKeyPressed(key: number): boolean;
+  isKeyReleased(key: number): boolean;
+  isMouseDown(button: number): boolean;
+  randomInt(min?: number, max?: number): number;
+  randomFloat(min?: number, max?: number): number;
+  randomBool(): boolean;
+  getSeed(): number;
 }
 
 export declare function Tensai(
@@ -120,6 +482,7 @@ export declare function Tensai(
   height: number,
   fullscreen: boolean,
   vsync: boolean,
+  options?: EngineOptions,
 ): TensaiEngine;
 
 export declare const Keys: {
@@ -198,3 +561,27 @@ export declare const Mouse: {
   readonly MIDDLE: number;
   readonly RIGHT: number;
 };
+
+export declare const Tiles: {
+  readonly EMPTY: number;
+  readonly SOLID: number;
+  readonly ONE_WAY: number;
+  readonly SLOPE_UP: number;
+  readonly SLOPE_DOWN: number;
+};
+
+export declare const Components: {
+  readonly TRANSFORM: number;
+  readonly VELOCITY: number;
+  readonly LIFETIME: number;
+  readonly SPRITE: number;
+  readonly COLLIDER: number;
+  readonly TAG0: number;
+  readonly TAG1: number;
+  readonly TAG2: number;
+  readonly TAG3: number;
+  readonly TAG4: number;
+  readonly TAG5: number;
+  readonly TAG6: number;
+  readonly TAG7: number;
+};
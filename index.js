@@ -3,6 +3,9 @@ const tensai = require('./build/Release/tensai.node');
 module.exports = {
   Tensai: tensai.Tensai,
   TensaiEngine: tensai.TensaiEngine,
+  Simulation: tensai.Simulation,
   Keys: tensai.Keys,
-  Mouse: tensai.Mouse
+  Mouse: tensai.Mouse,
+  Tiles: tensai.Tiles,
+  Components: tensai.Components
 };
@@ -0,0 +1,92 @@
+#include "batch.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define TENSAI_SSE2 1
+#endif
+
+static_assert(sizeof(Vec2) == 2 * sizeof(float), "Vec2 must be two packed floats");
+
+void transformPoints(const Mat &m, const Vec2 *in, Vec2 *out, size_t count) {
+  size_t i = 0;
+#ifdef TENSAI_SSE2
+  const __m128 col0 = _mm_setr_ps(m.a, m.b, m.a, m.b);
+  const __m128 col1 = _mm_setr_ps(m.c, m.d, m.c, m.d);
+  const __m128 offset = _mm_setr_ps(m.tx, m.ty, m.tx, m.ty);
+  for (; i + 2 <= count; i += 2) {
+    __m128 p = _mm_loadu_ps(&in[i].x);
+    __m128 xs = _mm_shuffle_ps(p, p, _MM_SHUFFLE(2, 2, 0, 0));
+    __m128 ys = _mm_shuffle_ps(p, p, _MM_SHUFFLE(3, 3, 1, 1));
+    __m128 r = _mm_add_ps(_mm_add_ps(_mm_mul_ps(xs, col0), _mm_mul_ps(ys, col1)),
+                          offset);
+    _mm_storeu_ps(&out[i].x, r);
+  }
+#endif
+  for (; i < count; i++)
+    out[i] = m.apply(in[i]);
+}
+
+Rect computeBounds(const Vec2 *points, size_t count) {
+  if (count == 0)
+    return Rect();
+  float minX = points[0].x, minY = points[0].y;
+  float maxX = minX, maxY = minY;
+  size_t i = 1;
+#ifdef TENSAI_SSE2
+  if (count >= 3) {
+    __m128 lo = _mm_loadu_ps(&points[0].x);
+    __m128 hi = lo;
+    for (i = 2; i + 2 <= count; i += 2) {
+      __m128 p = _mm_loadu_ps(&points[i].x);
+      lo = _mm_min_ps(lo, p);
+      hi = _mm_max_ps(hi, p);
+    }
+    // Fold the two (x, y) lanes together.
+    lo = _mm_min_ps(lo, _mm_movehl_ps(lo, lo));
+    hi = _mm_max_ps(hi, _mm_movehl_ps(hi, hi));
+    float l[4], h[4];
+    _mm_storeu_ps(l, lo);
+    _mm_storeu_ps(h, hi);
+    minX = l[0], minY = l[1], maxX = h[0], maxY = h[1];
+  }
+#endif
+  for (; i < count; i++) {
+    minX = std::min(minX, points[i].x);
+    minY = std::min(minY, points[i].y);
+    maxX = std::max(maxX, points[i].x);
+    maxY = std::max(maxY, points[i].y);
+  }
+  return Rect(minX, minY, maxX - minX, maxY - minY);
+}
+
+void distancesSquared(const Vec2 &from, const Vec2 *points, float *out,
+                      size_t count) {
+  size_t i = 0;
+#ifdef TENSAI_SSE2
+  const __m128 origin = _mm_setr_ps(from.x, from.y, from.x, from.y);
+  for (; i + 4 <= count; i += 4) {
+    __m128 d0 = _mm_sub_ps(_mm_loadu_ps(&points[i].x), origin);
+    __m128 d1 = _mm_sub_ps(_mm_loadu_ps(&points[i + 2].x), origin);
+    d0 = _mm_mul_ps(d0, d0);
+    d1 = _mm_mul_ps(d1, d1);
+    __m128 xs = _mm_shuffle_ps(d0, d1, _MM_SHUFFLE(2, 0, 2, 0));
+    __m128 ys = _mm_shuffle_ps(d0, d1, _MM_SHUFFLE(3, 1, 3, 1));
+    _mm_storeu_ps(out + i, _mm_add_ps(xs, ys));
+  }
+#endif
+  for (; i < count; i++)
+    out[i] = (points[i] - from).lengthSquared();
+}
+
+void distances(const Vec2 &from, const Vec2 *points, float *out, size_t count) {
+  distancesSquared(from, points, out, count);
+  size_t i = 0;
+#ifdef TENSAI_SSE2
+  for (; i + 4 <= count; i += 4)
+    _mm_storeu_ps(out + i, _mm_sqrt_ps(_mm_loadu_ps(out + i)));
+#endif
+  for (; i < count; i++)
+    out[i] = std::sqrt(out[i]);
+}
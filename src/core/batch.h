@@ -0,0 +1,24 @@
+#ifndef TENSAI_BATCH_H
+#define TENSAI_BATCH_H
+
+#include "mat.h"
+#include "rect.h"
+#include "vec2.h"
+#include <cstddef>
+
+// Kernels over contiguous Vec2 arrays. Vec2 is two packed floats, so these
+// work on SSE registers two points at a time, with a scalar tail and a scalar
+// fallback on targets without SSE2. `in` and `out` may alias.
+
+// out[i] = m.apply(in[i])
+void transformPoints(const Mat &m, const Vec2 *in, Vec2 *out, size_t count);
+
+// Smallest Rect containing every point; an empty Rect for count == 0.
+Rect computeBounds(const Vec2 *points, size_t count);
+
+// out[i] = |points[i] - from|^2 and |points[i] - from|.
+void distancesSquared(const Vec2 &from, const Vec2 *points, float *out,
+                      size_t count);
+void distances(const Vec2 &from, const Vec2 *points, float *out, size_t count);
+
+#endif // TENSAI_BATCH_H
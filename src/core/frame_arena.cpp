@@ -0,0 +1,38 @@
+#include "frame_arena.h"
+#include <algorithm>
+
+FrameArena::FrameArena(size_t initialSize) { addBlock(std::max<size_t>(initialSize, 64)); }
+
+void FrameArena::addBlock(size_t size) {
+  blocks.push_back({std::unique_ptr<uint8_t[]>(new uint8_t[size]), size});
+  capacity += size;
+  offset = 0;
+}
+
+void *FrameArena::allocate(size_t bytes, size_t alignment) {
+  Block *block = &blocks.back();
+  uintptr_t base = (uintptr_t)block->data.get();
+  size_t start = ((base + offset + alignment - 1) & ~(uintptr_t)(alignment - 1)) - base;
+  if (start + bytes > block->size) {
+    // Overflow blocks at least double, so a burst needs few of them.
+    addBlock(std::max(bytes + alignment, block->size * 2));
+    block = &blocks.back();
+    base = (uintptr_t)block->data.get();
+    start = ((base + alignment - 1) & ~(uintptr_t)(alignment - 1)) - base;
+  }
+  offset = start + bytes;
+  used += bytes;
+  highWater = std::max(highWater, used);
+  return block->data.get() + start;
+}
+
+void FrameArena::reset() {
+  if (blocks.size() > 1) {
+    size_t total = capacity;
+    blocks.clear();
+    capacity = 0;
+    addBlock(total);
+  }
+  offset = 0;
+  used = 0;
+}
@@ -0,0 +1,50 @@
+#ifndef TENSAI_FRAME_ARENA_H
+#define TENSAI_FRAME_ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+// Bump allocator for scratch memory that lives until the end of the frame.
+// Allocations are never freed individually; reset() reclaims everything at
+// once. When a frame overflows the current block, reset() replaces the
+// blocks with one big enough for that frame, so a steady workload settles
+// on a single block and stops touching the heap.
+class FrameArena {
+public:
+  explicit FrameArena(size_t initialSize = 64 * 1024);
+
+  // Uninitialized storage for `count` objects; trivially destructible types
+  // only, since nothing is destroyed.
+  template <typename T> T *alloc(size_t count) {
+    static_assert(std::is_trivially_destructible<T>::value,
+                  "FrameArena never runs destructors");
+    return static_cast<T *>(allocate(count * sizeof(T), alignof(T)));
+  }
+
+  void reset();
+
+  size_t getUsed() const { return used; }
+  size_t getCapacity() const { return capacity; }
+  // Most bytes handed out in any single frame.
+  size_t getHighWater() const { return highWater; }
+
+private:
+  struct Block {
+    std::unique_ptr<uint8_t[]> data;
+    size_t size;
+  };
+
+  std::vector<Block> blocks;
+  size_t offset = 0; // into blocks.back()
+  size_t used = 0;
+  size_t capacity = 0;
+  size_t highWater = 0;
+
+  void *allocate(size_t bytes, size_t alignment);
+  void addBlock(size_t size);
+};
+
+#endif // TENSAI_FRAME_ARENA_H
@@ -0,0 +1,65 @@
+#ifndef TENSAI_MAT_H
+#define TENSAI_MAT_H
+
+#include "vec2.h"
+#include <cmath>
+
+// 2x3 affine matrix, column-vector convention:
+//
+//   | a c tx |   | x |
+//   | b d ty | * | y |
+//                | 1 |
+//
+// `m * n` applies n first, then m.
+class Mat {
+public:
+  float a = 1, b = 0, c = 0, d = 1, tx = 0, ty = 0;
+
+  constexpr Mat() = default;
+  constexpr Mat(float a, float b, float c, float d, float tx, float ty)
+      : a(a), b(b), c(c), d(d), tx(tx), ty(ty) {}
+
+  static constexpr Mat identity() { return Mat(); }
+  static constexpr Mat translation(const Vec2 &offset) {
+    return Mat(1, 0, 0, 1, offset.x, offset.y);
+  }
+  static constexpr Mat scaling(const Vec2 &scale) {
+    return Mat(scale.x, 0, 0, scale.y, 0, 0);
+  }
+  static Mat rotation(float radians) {
+    float cs = std::cos(radians), sn = std::sin(radians);
+    return Mat(cs, sn, -sn, cs, 0, 0);
+  }
+  // Rotation by `radians` about `pivot`.
+  static Mat rotation(float radians, const Vec2 &pivot) {
+    return translation(pivot) * rotation(radians) * translation(-pivot);
+  }
+
+  constexpr Mat operator*(const Mat &n) const {
+    return Mat(a * n.a + c * n.b, b * n.a + d * n.b, a * n.c + c * n.d,
+               b * n.c + d * n.d, a * n.tx + c * n.ty + tx,
+               b * n.tx + d * n.ty + ty);
+  }
+
+  constexpr Vec2 apply(const Vec2 &p) const {
+    return Vec2(a * p.x + c * p.y + tx, b * p.x + d * p.y + ty);
+  }
+  // Applies the linear part only, for directions and extents.
+  constexpr Vec2 applyVector(const Vec2 &v) const {
+    return Vec2(a * v.x + c * v.y, b * v.x + d * v.y);
+  }
+
+  constexpr float determinant() const { return a * d - b * c; }
+
+  // Inverse transform; singular matrices invert to the identity.
+  constexpr Mat inverse() const {
+    float det = determinant();
+    if (det == 0.0f)
+      return Mat();
+    float inv = 1.0f / det;
+    return Mat(d * inv, -b * inv, -c * inv, a * inv, (c * ty - d * tx) * inv,
+               (b * tx - a * ty) * inv);
+  }
+};
+
+#endif // TENSAI_MAT_H
@@ -0,0 +1,43 @@
+#ifndef TENSAI_RECT_H
+#define TENSAI_RECT_H
+
+#include "vec2.h"
+#include <algorithm>
+
+// Axis-aligned rectangle stored as position and size.
+class Rect {
+public:
+  float x = 0, y = 0, w = 0, h = 0;
+
+  constexpr Rect() = default;
+  constexpr Rect(float x, float y, float w, float h) : x(x), y(y), w(w), h(h) {}
+
+  static constexpr Rect fromMinMax(const Vec2 &min, const Vec2 &max) {
+    return Rect(min.x, min.y, max.x - min.x, max.y - min.y);
+  }
+
+  constexpr Vec2 min() const { return Vec2(x, y); }
+  constexpr Vec2 max() const { return Vec2(x + w, y + h); }
+  constexpr Vec2 center() const { return Vec2(x + w * 0.5f, y + h * 0.5f); }
+  constexpr bool empty() const { return w <= 0 || h <= 0; }
+
+  constexpr bool contains(const Vec2 &p) const {
+    return p.x >= x && p.x <= x + w && p.y >= y && p.y <= y + h;
+  }
+  constexpr bool intersects(const Rect &o) const {
+    return x <= o.x + o.w && o.x <= x + w && y <= o.y + o.h && o.y <= y + h;
+  }
+
+  Rect merge(const Rect &o) const {
+    float x0 = std::min(x, o.x), y0 = std::min(y, o.y);
+    float x1 = std::max(x + w, o.x + o.w), y1 = std::max(y + h, o.y + o.h);
+    return Rect(x0, y0, x1 - x0, y1 - y0);
+  }
+  Rect intersection(const Rect &o) const {
+    float x0 = std::max(x, o.x), y0 = std::max(y, o.y);
+    float x1 = std::min(x + w, o.x + o.w), y1 = std::min(y + h, o.y + o.h);
+    return x1 > x0 && y1 > y0 ? Rect(x0, y0, x1 - x0, y1 - y0) : Rect();
+  }
+};
+
+#endif // TENSAI_RECT_H
@@ -0,0 +1,65 @@
+#include "thread_pool.h"
+#include <algorithm>
+
+ThreadPool::ThreadPool(int threads) {
+  if (threads <= 0)
+    threads = (int)std::max(1u, std::thread::hardware_concurrency());
+  for (int i = 1; i < threads; i++)
+    workers.emplace_back([this] { run(); });
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  wake.notify_all();
+  for (auto &worker : workers)
+    worker.join();
+}
+
+void ThreadPool::drain() {
+  for (int i = next.fetch_add(1); i < count; i = next.fetch_add(1))
+    (*current)(i);
+}
+
+void ThreadPool::parallelFor(int n, const std::function<void(int)> &task) {
+  if (n <= 0)
+    return;
+  if (workers.empty() || n == 1) {
+    for (int i = 0; i < n; i++)
+      task(i);
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    current = &task;
+    count = n;
+    next = 0;
+    running = (int)workers.size();
+    generation++;
+  }
+  wake.notify_all();
+  drain();
+
+  std::unique_lock<std::mutex> lock(mutex);
+  done.wait(lock, [&] { return running == 0; });
+  current = nullptr;
+}
+
+void ThreadPool::run() {
+  uint64_t seen = 0;
+  std::unique_lock<std::mutex> lock(mutex);
+  for (;;) {
+    wake.wait(lock, [&] { return stopping || generation != seen; });
+    if (stopping)
+      return;
+    seen = generation;
+    lock.unlock();
+    drain();
+    lock.lock();
+    if (--running == 0)
+      done.notify_one();
+  }
+}
@@ -0,0 +1,43 @@
+#ifndef TENSAI_THREAD_POOL_H
+#define TENSAI_THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads for data-parallel loops. The calling thread
+// takes part in each loop, so a pool of size 1 has no workers and runs
+// everything inline.
+class ThreadPool {
+public:
+  // 0 picks the core count.
+  explicit ThreadPool(int threads = 0);
+  ~ThreadPool();
+
+  int size() const { return (int)workers.size() + 1; }
+
+  // Calls task(i) for every i in [0, count) across the pool and returns when
+  // all calls have finished. Not reentrant.
+  void parallelFor(int count, const std::function<void(int)> &task);
+
+private:
+  std::vector<std::thread> workers;
+  std::mutex mutex;
+  std::condition_variable wake;
+  std::condition_variable done;
+  const std::function<void(int)> *current = nullptr;
+  int count = 0;
+  std::atomic<int> next{0};
+  int running = 0;
+  uint64_t generation = 0;
+  bool stopping = false;
+
+  void run();
+  void drain();
+};
+
+#endif // TENSAI_THREAD_POOL_H
@@ -3,16 +3,61 @@
 
 #include <cmath>
 
+// Header-only so every operator inlines at the call site.
 class Vec2 {
 public:
   float x, y;
-  Vec2(float x = 0, float y = 0);
-  Vec2 operator+(const Vec2 &other) const;
-  Vec2 operator-(const Vec2 &other) const;
-  Vec2 operator*(float scalar) const;
-  Vec2 operator*(const Vec2 &other) const;
-  float length() const;
-  Vec2 normalize() const;
+  constexpr Vec2(float x = 0, float y = 0) : x(x), y(y) {}
+
+  constexpr Vec2 operator+(const Vec2 &other) const {
+    return Vec2(x + other.x, y + other.y);
+  }
+  constexpr Vec2 operator-(const Vec2 &other) const {
+    return Vec2(x - other.x, y - other.y);
+  }
+  constexpr Vec2 operator-() const { return Vec2(-x, -y); }
+  constexpr Vec2 operator*(float scalar) const {
+    return Vec2(x * scalar, y * scalar);
+  }
+  constexpr Vec2 operator*(const Vec2 &other) const {
+    return Vec2(x * other.x, y * other.y);
+  }
+  constexpr Vec2 operator/(float scalar) const {
+    return Vec2(x / scalar, y / scalar);
+  }
+  constexpr bool operator==(const Vec2 &other) const {
+    return x == other.x && y == other.y;
+  }
+  constexpr bool operator!=(const Vec2 &other) const { return !(*this == other); }
+
+  Vec2 &operator+=(const Vec2 &other) {
+    x += other.x;
+    y += other.y;
+    return *this;
+  }
+  Vec2 &operator-=(const Vec2 &other) {
+    x -= other.x;
+    y -= other.y;
+    return *this;
+  }
+  Vec2 &operator*=(float scalar) {
+    x *= scalar;
+    y *= scalar;
+    return *this;
+  }
+
+  constexpr float dot(const Vec2 &other) const { return x * other.x + y * other.y; }
+  constexpr float cross(const Vec2 &other) const { return x * other.y - y * other.x; }
+  constexpr Vec2 perpendicular() const { return Vec2(-y, x); }
+  constexpr float lengthSquared() const { return x * x + y * y; }
+  float length() const { return std::sqrt(lengthSquared()); }
+
+  // Unit vector in the same direction, or the zero vector for a zero-length
+  // input rather than dividing by zero.
+  Vec2 normalize() const {
+    float len = length();
+    return len > 0.0f ? Vec2(x / len, y / len) : Vec2(0, 0);
+  }
 };
 
-#endif // TENSAI_VEC2_H
\ No newline at end of file
+#endif // TENSAI_VEC2_H
@@ -0,0 +1,45 @@
+#include "assets.h"
+#include <algorithm>
+
+std::string Assets::normalize(const std::string &path) {
+  std::string name = path;
+  std::replace(name.begin(), name.end(), '\\', '/');
+  while (name.compare(0, 2, "./") == 0)
+    name.erase(0, 2);
+  return name;
+}
+
+bool Assets::mount(const std::string &packPath) {
+  auto pack = std::make_unique<AssetPack>(packPath);
+  if (!pack->isOpen())
+    return false;
+  std::lock_guard<std::mutex> lock(mutex);
+  packs.push_back(std::move(pack));
+  return true;
+}
+
+SDL_RWops *Assets::open(const std::string &path) const {
+  std::string name = normalize(path);
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto it = packs.rbegin(); it != packs.rend(); ++it) {
+      if ((*it)->contains(name))
+        return (*it)->open(name);
+    }
+  }
+  return SDL_RWFromFile(path.c_str(), "rb");
+}
+
+bool Assets::read(const std::string &path, std::vector<uint8_t> &out) const {
+  SDL_RWops *rw = open(path);
+  if (!rw)
+    return false;
+  Sint64 size = SDL_RWsize(rw);
+  bool ok = size >= 0;
+  if (ok) {
+    out.resize((size_t)size);
+    ok = SDL_RWread(rw, out.data(), 1, out.size()) == out.size();
+  }
+  SDL_RWclose(rw);
+  return ok;
+}
@@ -0,0 +1,29 @@
+#ifndef TENSAI_ASSETS_H
+#define TENSAI_ASSETS_H
+
+#include "../resources/asset_pack.h"
+#include <SDL2/SDL.h>
+#include <memory>
+#include <mutex>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Resolves asset paths for every loader: mounted packs first (most recently
+// mounted wins), then the filesystem. Packs stay mapped until the engine is
+// destroyed, since fonts and music keep reading from their RWops.
+class Assets {
+private:
+  std::vector<std::unique_ptr<AssetPack>> packs;
+  mutable std::mutex mutex;
+
+  static std::string normalize(const std::string &path);
+
+public:
+  bool mount(const std::string &packPath);
+  // Caller owns the returned RWops; nullptr if the asset can't be opened.
+  SDL_RWops *open(const std::string &path) const;
+  bool read(const std::string &path, std::vector<uint8_t> &out) const;
+};
+
+#endif // TENSAI_ASSETS_H
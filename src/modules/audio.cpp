@@ -1,19 +1,83 @@
 #include "audio.h"
+#include <algorithm>
+#include <cmath>
 #include <cstdio>
 #include <cstdlib>
+#include <iterator>
 
-Audio::Audio() {
-  if (Mix_OpenAudio(44100, MIX_DEFAULT_FORMAT, 2, 2048) == -1) {
+// Mix_GetMusicPosition, which loop points need, arrived in SDL_mixer 2.6.
+#ifdef SDL_MIXER_VERSION_ATLEAST
+#if SDL_MIXER_VERSION_ATLEAST(2, 6, 0)
+#define TENSAI_MUSIC_POSITION 1
+#endif
+#endif
+
+Audio::Audio(const Assets &assets, int frequency, int bufferFrames)
+    : assets(assets), bufferFrames(bufferFrames), musicLoader(assets) {
+  if (Mix_OpenAudio(frequency, MIX_DEFAULT_FORMAT, 2, bufferFrames) == -1) {
     fprintf(stderr, "Warning: Error initializing SDL_mixer: %s\n", Mix_GetError());
   }
+  Uint16 format;
+  int channels;
+  if (!Mix_QuerySpec(&this->frequency, &format, &channels))
+    this->frequency = frequency;
+  Mix_SetPostMix(&Audio::postMix, this);
+  setVoiceCount(32);
+}
+
+Audio::~Audio() {
+  musicLoader.stop();
+  Mix_SetPostMix(nullptr, nullptr);
+  Mix_CloseAudio();
 }
 
-Audio::~Audio() { Mix_CloseAudio(); }
+void Audio::postMix(void *udata, Uint8 *stream, int len) {
+  Audio *audio = static_cast<Audio *>(udata);
+  uint64_t now = SDL_GetPerformanceCounter();
+  uint64_t last = audio->lastMixTicks.exchange(now);
+  audio->mixCallbacks++;
+  if (!last)
+    return;
+
+  uint64_t gap = now - last;
+  audio->mixGapTotal += gap;
+  if (gap > audio->mixGapMax.load())
+    audio->mixGapMax = gap;
+  uint64_t period = SDL_GetPerformanceFrequency() * audio->bufferFrames /
+                    (uint64_t)std::max(audio->frequency, 1);
+  if (gap * 2 > period * 3)
+    audio->mixUnderruns++;
+}
+
+Audio::MixerStats Audio::getMixerStats() const {
+  MixerStats stats;
+  stats.frequency = frequency;
+  stats.bufferFrames = bufferFrames;
+  stats.bufferMs = frequency ? 1000.0 * bufferFrames / frequency : 0.0;
+  stats.callbacks = mixCallbacks.load();
+  stats.underruns = mixUnderruns.load();
+  double ticksPerMs = SDL_GetPerformanceFrequency() / 1000.0;
+  if (stats.callbacks > 1)
+    stats.avgGapMs = mixGapTotal.load() / ticksPerMs / (stats.callbacks - 1);
+  stats.maxGapMs = mixGapMax.load() / ticksPerMs;
+  return stats;
+}
 
-std::shared_ptr<Sound> Audio::loadSound(const std::string &path) {
-  auto sound = std::make_shared<Sound>(path);
+std::shared_ptr<Sound> Audio::loadSound(const std::string &path,
+                                        const std::string &bank) {
+  auto it = sounds.find(path);
+  if (it != sounds.end()) {
+    return it->second;
+  }
+
+  auto sound = std::make_shared<Sound>(assets.open(path));
   if (sound && sound->chunk) {
+    if (admit && !admit("sound", path, sound->bytes()))
+      return nullptr;
+    sound->bank = bank;
     sounds[path] = sound;
+    memory.sounds++;
+    memory.soundBytes += sound->bytes();
     return sound;
   }
   fprintf(stderr, "Warning: Error loading sound: %s\n", path.c_str());
@@ -21,23 +85,298 @@ std::shared_ptr<Sound> Audio::loadSound(const std::string &path) {
 }
 
 std::shared_ptr<Music> Audio::loadMusic(const std::string &path) {
-  auto music = std::make_shared<Music>(path);
+  auto it = musics.find(path);
+  if (it != musics.end()) {
+    return it->second;
+  }
+
+  auto music = std::make_shared<Music>(assets.open(path));
   if (music && music->music) {
-    musics[path] = music;
+    if (admit && !admit("music", path, music->bytes()))
+      return nullptr;
+    storeMusic(path, music);
     return music;
   }
   fprintf(stderr, "Warning: Error loading music: %s\n", path.c_str());
   return nullptr;
 }
 
-void Audio::playSound(std::shared_ptr<Sound> sound, int volume, int channel) {
-  if (sound && sound->chunk) {
-    Mix_VolumeChunk(sound->chunk, volume);
-    if (Mix_PlayChannel(channel, sound->chunk, 0) == -1) {
-      fprintf(stderr, "Error playing sound: %s\n", Mix_GetError());
-      exit(1);
+std::shared_ptr<Sound> Audio::getSound(const std::string &path) const {
+  auto it = sounds.find(path);
+  return it != sounds.end() ? it->second : nullptr;
+}
+
+std::shared_ptr<Music> Audio::getMusic(const std::string &path) const {
+  auto it = musics.find(path);
+  return it != musics.end() ? it->second : nullptr;
+}
+
+void Audio::eraseSound(std::unordered_map<std::string, std::shared_ptr<Sound>>::iterator it) {
+  memory.sounds--;
+  memory.soundBytes -= it->second->bytes();
+  sounds.erase(it);
+}
+
+void Audio::storeMusic(const std::string &path, std::shared_ptr<Music> music) {
+  std::shared_ptr<Music> &slot = musics[path];
+  if (slot) {
+    memory.musicBytes -= slot->bytes();
+  } else {
+    memory.music++;
+  }
+  memory.musicBytes += music->bytes();
+  slot = std::move(music);
+}
+
+void Audio::unloadSound(const std::string &path) {
+  auto it = sounds.find(path);
+  if (it != sounds.end())
+    eraseSound(it);
+}
+
+void Audio::unloadBank(const std::string &bank) {
+  for (auto it = sounds.begin(); it != sounds.end();) {
+    if (it->second->bank == bank) {
+      auto next = std::next(it);
+      eraseSound(it);
+      it = next;
+    } else {
+      ++it;
+    }
+  }
+}
+
+void Audio::unloadMusic(const std::string &path) {
+  auto it = musics.find(path);
+  if (it == musics.end())
+    return;
+  memory.music--;
+  memory.musicBytes -= it->second->bytes();
+  musics.erase(it);
+}
+
+std::unordered_map<std::string, Audio::BankStats> Audio::getBankStats() const {
+  std::unordered_map<std::string, BankStats> stats;
+  for (const auto &entry : sounds) {
+    BankStats &bank = stats[entry.second->bank];
+    bank.sounds++;
+    bank.bytes += entry.second->bytes();
+  }
+  return stats;
+}
+
+Audio::MemoryStats Audio::getMemoryStats() const { return memory; }
+
+void Audio::setVoiceCount(int count) {
+  if (count < 1)
+    count = 1;
+  // Channels below the new count keep playing with their effects, so their
+  // voices are kept for stealing and effect resets; SDL_mixer halts and
+  // clears the channels above it.
+  voices.resize(Mix_AllocateChannels(count));
+  voiceStats.voices = (int)voices.size();
+  refreshVoices();
+}
+
+void Audio::setStealPolicy(StealPolicy policy) { stealPolicy = policy; }
+
+void Audio::refreshVoices() {
+  int active = 0;
+  for (size_t i = 0; i < voices.size(); i++) {
+    if (voices[i].sound && !Mix_Playing((int)i))
+      voices[i].sound.reset();
+    if (voices[i].sound)
+      active++;
+  }
+  voiceStats.active = active;
+}
+
+int Audio::pickVictim(const std::shared_ptr<Sound> &sameSound,
+                      int maxPriority) const {
+  int victim = -1;
+  for (size_t i = 0; i < voices.size(); i++) {
+    const Voice &voice = voices[i];
+    if (!voice.sound)
+      continue;
+    if (sameSound ? voice.sound != sameSound : voice.sound->priority > maxPriority)
+      continue;
+    if (victim < 0) {
+      victim = (int)i;
+      continue;
+    }
+    const Voice &best = voices[victim];
+    if (voice.sound->priority != best.sound->priority) {
+      if (voice.sound->priority < best.sound->priority)
+        victim = (int)i;
+      continue;
     }
+    int loudness = voice.volume * (255 - voice.distance);
+    int bestLoudness = best.volume * (255 - best.distance);
+    bool better = stealPolicy == StealPolicy::Quietest
+                      ? loudness < bestLoudness ||
+                            (loudness == bestLoudness && voice.started < best.started)
+                      : voice.started < best.started;
+    if (better)
+      victim = (int)i;
   }
+  return victim;
+}
+
+int Audio::playSound(std::shared_ptr<Sound> sound, int volume, int channel) {
+  if (!sound || !sound->chunk)
+    return -1;
+
+  refreshVoices();
+  bool steal = false;
+  if (channel < 0 && sound->maxInstances > 0) {
+    int instances = 0;
+    for (const Voice &voice : voices) {
+      if (voice.sound == sound)
+        instances++;
+    }
+    if (instances >= sound->maxInstances) {
+      channel = pickVictim(sound, 0);
+      steal = true;
+    }
+  }
+  if (channel < 0 && !steal) {
+    for (size_t i = 0; i < voices.size(); i++) {
+      if (!voices[i].sound) {
+        channel = (int)i;
+        break;
+      }
+    }
+    if (channel < 0) {
+      channel = pickVictim(nullptr, sound->priority);
+      steal = true;
+    }
+  }
+  if (channel < 0 || channel >= (int)voices.size()) {
+    voiceStats.dropped++;
+    return -1;
+  }
+
+  if (voices[channel].sound) {
+    Mix_HaltChannel(channel);
+    voices[channel].sound.reset();
+    voiceStats.active--;
+    if (steal)
+      voiceStats.stolen++;
+  }
+  // Pan and distance effects outlive the voice that set them when it ends
+  // on its own; clear them so a plain sound on this channel plays unmixed.
+  // Spatial voices reapply theirs right after.
+  Voice &previous = voices[channel];
+  if (previous.left != 255 || previous.right != 255)
+    Mix_SetPanning(channel, 255, 255);
+  if (previous.distance != 0)
+    Mix_SetDistance(channel, 0);
+  Mix_Volume(channel, volume);
+  if (Mix_PlayChannel(channel, sound->chunk, 0) == -1) {
+    fprintf(stderr, "Warning: Error playing sound: %s\n", Mix_GetError());
+    voices[channel] = Voice();
+    voiceStats.dropped++;
+    return -1;
+  }
+
+  voices[channel] = {sound, volume, ++voiceClock};
+  voiceStats.played++;
+  voiceStats.active++;
+  voiceStats.peak = std::max(voiceStats.peak, voiceStats.active);
+  return channel;
+}
+
+int Audio::createEmitter(const Vec2 &position, float range) {
+  int id;
+  if (!freeEmitters.empty()) {
+    id = freeEmitters.back();
+    freeEmitters.pop_back();
+  } else {
+    id = (int)emitters.size();
+    emitters.emplace_back();
+  }
+  emitters[id] = {position, range > 0.0f ? range : 1.0f, true};
+  return id;
+}
+
+void Audio::destroyEmitter(int emitter) {
+  if (emitter < 0 || emitter >= (int)emitters.size() || !emitters[emitter].active)
+    return;
+  emitters[emitter].active = false;
+  freeEmitters.push_back(emitter);
+  for (Voice &voice : voices) {
+    if (voice.emitter == emitter)
+      voice.emitter = -1;
+  }
+}
+
+void Audio::setEmitterPosition(int emitter, const Vec2 &position) {
+  if (emitter >= 0 && emitter < (int)emitters.size())
+    emitters[emitter].position = position;
+}
+
+void Audio::setEmitterPositions(const int32_t *ids, const float *positions,
+                                size_t count) {
+  for (size_t i = 0; i < count; i++) {
+    int id = ids[i];
+    if (id >= 0 && id < (int)emitters.size())
+      emitters[id].position = Vec2(positions[i * 2], positions[i * 2 + 1]);
+  }
+}
+
+int Audio::playSoundAt(std::shared_ptr<Sound> sound, int emitter, int volume) {
+  if (emitter < 0 || emitter >= (int)emitters.size() || !emitters[emitter].active)
+    return playSound(sound, volume);
+  int channel = playSound(sound, volume);
+  if (channel >= 0) {
+    voices[channel].emitter = emitter;
+    applySpatial(channel);
+  }
+  return channel;
+}
+
+void Audio::applySpatial(int channel) {
+  Voice &voice = voices[channel];
+  const Emitter &emitter = emitters[voice.emitter];
+
+  // Listener space: rotate the offset by the camera so "right" follows the
+  // screen, then attenuate linearly out to the emitter's range.
+  Vec2 offset = emitter.position - listener.position;
+  float c = cos(-listener.rotation), s = sin(-listener.rotation);
+  float x = offset.x * c - offset.y * s;
+  float dist = offset.length();
+  float pan = std::max(-1.0f, std::min(1.0f, x / emitter.range));
+  float angle = (pan + 1.0f) * (float)M_PI / 4.0f;
+
+  Uint8 left = (Uint8)(255.0f * cos(angle) + 0.5f);
+  Uint8 right = (Uint8)(255.0f * sin(angle) + 0.5f);
+  Uint8 distance = (Uint8)(std::min(1.0f, dist / emitter.range) * 255.0f);
+
+  if (left != voice.left || right != voice.right) {
+    Mix_SetPanning(channel, left, right);
+    voice.left = left;
+    voice.right = right;
+  }
+  if (distance != voice.distance) {
+    Mix_SetDistance(channel, distance);
+    voice.distance = distance;
+  }
+}
+
+void Audio::updateSpatial(const Camera &camera) {
+  listener = camera;
+  // Drop voices that finished since the last play, so idle channels never
+  // get effects applied.
+  refreshVoices();
+  for (size_t i = 0; i < voices.size(); i++) {
+    if (voices[i].sound && voices[i].emitter >= 0)
+      applySpatial((int)i);
+  }
+}
+
+Audio::VoiceStats Audio::getVoiceStats() {
+  refreshVoices();
+  return voiceStats;
 }
 
 void Audio::playMusic(std::shared_ptr<Music> music, int loops) {
@@ -46,7 +385,78 @@ void Audio::playMusic(std::shared_ptr<Music> music, int loops) {
       fprintf(stderr, "Error playing music: %s\n", Mix_GetError());
       exit(1);
     }
+    currentMusic = music;
+    pendingMusic.active = false;
+    loopStart = loopEnd = 0.0;
+  }
+}
+
+void Audio::preloadMusic(const std::string &path) {
+  if (!musics.count(path))
+    musicLoader.request(path);
+}
+
+void Audio::crossfadeMusic(const std::string &path, int fadeMs, int loops) {
+  if (pendingMusic.active && pendingMusic.path == path) {
+    pendingMusic.loops = loops;
+    pendingMusic.fadeMs = fadeMs;
+    return;
+  }
+  if (!musics.count(path))
+    musicLoader.request(path);
+  pendingMusic = {path, loops, fadeMs, true};
+  if (Mix_PlayingMusic() && Mix_FadingMusic() != MIX_FADING_OUT) {
+    if (fadeMs > 0) {
+      Mix_FadeOutMusic(fadeMs / 2);
+    } else {
+      Mix_HaltMusic();
+    }
+  }
+}
+
+void Audio::setMusicLoopPoints(double start, double end) {
+#ifdef TENSAI_MUSIC_POSITION
+  loopStart = start;
+  loopEnd = end;
+#else
+  (void)start;
+  (void)end;
+  fprintf(stderr, "Warning: Music loop points need SDL_mixer 2.6 or newer\n");
+#endif
+}
+
+void Audio::update() {
+  for (auto &entry : musicLoader.takeLoaded()) {
+    if (entry.second &&
+        (!admit || admit("music", entry.first, entry.second->bytes()))) {
+      storeMusic(entry.first, entry.second);
+    } else if (pendingMusic.active && pendingMusic.path == entry.first) {
+      if (!entry.second)
+        fprintf(stderr, "Warning: Error loading music: %s\n", entry.first.c_str());
+      pendingMusic.active = false;
+    }
+  }
+
+  if (pendingMusic.active && !Mix_PlayingMusic()) {
+    auto it = musics.find(pendingMusic.path);
+    if (it != musics.end()) {
+      int fadeIn = pendingMusic.fadeMs / 2;
+      if (Mix_FadeInMusic(it->second->music, pendingMusic.loops, fadeIn) == -1) {
+        fprintf(stderr, "Warning: Error playing music: %s\n", Mix_GetError());
+      } else {
+        currentMusic = it->second;
+      }
+      pendingMusic.active = false;
+      loopStart = loopEnd = 0.0;
+    }
+  }
+
+#ifdef TENSAI_MUSIC_POSITION
+  if (currentMusic && loopEnd > loopStart && Mix_PlayingMusic() &&
+      Mix_GetMusicPosition(currentMusic->music) >= loopEnd) {
+    Mix_SetMusicPosition(loopStart);
   }
+#endif
 }
 
 void Audio::pauseMusic() {
@@ -58,6 +468,7 @@ void Audio::resumeMusic() {
 }
 
 void Audio::stopMusic() {
+  pendingMusic.active = false;
   Mix_HaltMusic();
 }
 
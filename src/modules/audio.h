@@ -3,26 +3,176 @@
 
 #include "../resources/music.h"
 #include "../resources/sound.h"
+#include "assets.h"
+#include "camera.h"
+#include "music_loader.h"
 #include <SDL2/SDL_mixer.h>
+#include <atomic>
+#include <functional>
 #include <memory>
 #include <unordered_map>
+#include <vector>
 
 class Audio {
+public:
+  struct BankStats {
+    int sounds = 0;
+    size_t bytes = 0;
+  };
+
+  struct MemoryStats {
+    int sounds = 0;
+    size_t soundBytes = 0;
+    int music = 0;
+    size_t musicBytes = 0;
+  };
+
+  enum class StealPolicy { Oldest, Quietest };
+
+  struct MixerStats {
+    int frequency = 0;
+    int bufferFrames = 0;
+    double bufferMs = 0.0;
+    uint64_t callbacks = 0;
+    uint64_t underruns = 0;
+    double avgGapMs = 0.0;
+    double maxGapMs = 0.0;
+  };
+
+  struct VoiceStats {
+    int voices = 0;
+    int active = 0;
+    int peak = 0;
+    uint64_t played = 0;
+    uint64_t stolen = 0;
+    uint64_t dropped = 0;
+  };
+
 private:
+  const Assets &assets;
+  int frequency = 0;
+  int bufferFrames = 0;
+  // Written from the mixer thread by postMix.
+  std::atomic<uint64_t> lastMixTicks{0};
+  std::atomic<uint64_t> mixCallbacks{0};
+  std::atomic<uint64_t> mixUnderruns{0};
+  std::atomic<uint64_t> mixGapTotal{0};
+  std::atomic<uint64_t> mixGapMax{0};
+
+  static void postMix(void *udata, Uint8 *stream, int len);
+
+  struct Voice {
+    std::shared_ptr<Sound> sound;
+    int volume = 0;
+    uint64_t started = 0;
+    int emitter = -1;
+    Uint8 left = 255, right = 255, distance = 0;
+  };
+
+  struct Emitter {
+    Vec2 position{0, 0};
+    float range = 0.0f;
+    bool active = false;
+  };
+
+  std::vector<Emitter> emitters;
+  std::vector<int> freeEmitters;
+  Camera listener;
+
+  std::vector<Voice> voices;
+  uint64_t voiceClock = 0;
+  StealPolicy stealPolicy = StealPolicy::Oldest;
+  VoiceStats voiceStats;
+
+  struct MusicTransition {
+    std::string path;
+    int loops = -1;
+    int fadeMs = 0;
+    bool active = false;
+  };
+
+  MusicLoader musicLoader;
+  std::function<bool(const char *, const std::string &, size_t)> admit;
+  MusicTransition pendingMusic;
+  std::shared_ptr<Music> currentMusic;
+  double loopStart = 0.0;
+  double loopEnd = 0.0;
+
+  void refreshVoices();
+  void applySpatial(int channel);
+  int pickVictim(const std::shared_ptr<Sound> &sameSound, int maxPriority) const;
+
   std::unordered_map<std::string, std::shared_ptr<Sound>> sounds;
   std::unordered_map<std::string, std::shared_ptr<Music>> musics;
+  // Running totals of the two maps, updated on every insert and erase.
+  MemoryStats memory;
+
+  void eraseSound(std::unordered_map<std::string, std::shared_ptr<Sound>>::iterator it);
+  void storeMusic(const std::string &path, std::shared_ptr<Music> music);
 
 public:
-  Audio();
+  static constexpr int LowLatencyFrequency = 48000;
+  static constexpr int LowLatencyBufferFrames = 256;
+
+  Audio(const Assets &assets, int frequency = 44100, int bufferFrames = 2048);
   ~Audio();
 
-  std::shared_ptr<Sound> loadSound(const std::string &path);
+  // Sounds are decoded once into the mixer's output format and cached by
+  // path; repeated loads and plays reuse the decoded chunk.
+  std::shared_ptr<Sound> loadSound(const std::string &path,
+                                   const std::string &bank = "default");
   std::shared_ptr<Music> loadMusic(const std::string &path);
+  std::shared_ptr<Sound> getSound(const std::string &path) const;
+  std::shared_ptr<Music> getMusic(const std::string &path) const;
+
+  void unloadSound(const std::string &path);
+  void unloadBank(const std::string &bank);
+  void unloadMusic(const std::string &path);
+  std::unordered_map<std::string, BankStats> getBankStats() const;
+  // Totals over every cached sound and music stream.
+  MemoryStats getMemoryStats() const;
+  // Consulted with the kind, path and byte size of every newly loaded sound
+  // or music stream before it is cached, whether loaded directly, on play or
+  // by the background loader. Returning false drops it and fails the load.
+  // Sizes are only known once loaded, so a sound is fully decoded first.
+  void setAdmission(std::function<bool(const char *, const std::string &, size_t)> fn) {
+    admit = std::move(fn);
+  }
 
-  void playSound(std::shared_ptr<Sound> sound, int volume = 128,
-                 int channel = -1);
+  // Returns the mixer channel the sound plays on, or -1 if it was dropped.
+  // When every voice is busy the victim is chosen among voices of equal or
+  // lower priority, lowest priority first, then by the steal policy.
+  int playSound(std::shared_ptr<Sound> sound, int volume = 128,
+                int channel = -1);
   void playMusic(std::shared_ptr<Music> music, int loops = -1);
 
+  // Emitters are world-space sound sources. Voices started with
+  // playSoundAt follow their emitter; attenuation and pan are recomputed
+  // against the listener camera for every spatial voice in updateSpatial.
+  int createEmitter(const Vec2 &position, float range);
+  void destroyEmitter(int emitter);
+  void setEmitterPosition(int emitter, const Vec2 &position);
+  void setEmitterPositions(const int32_t *ids, const float *positions,
+                           size_t count);
+  int playSoundAt(std::shared_ptr<Sound> sound, int emitter, int volume = 128);
+  void updateSpatial(const Camera &camera);
+
+  void setVoiceCount(int count);
+  void setStealPolicy(StealPolicy policy);
+  VoiceStats getVoiceStats();
+  // A callback gap longer than 1.5 buffer periods counts as an underrun.
+  MixerStats getMixerStats() const;
+
+  // Opens the track in the background; playMusic/crossfadeMusic on the same
+  // path then start without touching the disk.
+  void preloadMusic(const std::string &path);
+  // Fades the current track out and the new one in, each over half of fadeMs.
+  // The switch happens in update() once the new track has finished loading.
+  void crossfadeMusic(const std::string &path, int fadeMs, int loops = -1);
+  // Loop region in seconds for the current track; end <= start disables it.
+  void setMusicLoopPoints(double start, double end);
+  void update();
+
   void pauseMusic();
   void resumeMusic();
   void stopMusic();
@@ -1,7 +1,9 @@
 #ifndef TENSAI_CAMERA_H
 #define TENSAI_CAMERA_H
 
+#include "../core/mat.h"
 #include "../core/vec2.h"
+#include <cstddef>
 #include <cmath>
 
 class Camera {
@@ -15,8 +17,14 @@ public:
   void zoom(float factor);
   void lookAt(const Vec2 &target);
 
+  // World-to-screen transform: translate by -position, rotate by -rotation,
+  // scale, then center on the screen.
+  Mat viewMatrix(int screenWidth, int screenHeight) const;
+
   Vec2 worldToScreen(const Vec2 &worldPos, int screenWidth,
                      int screenHeight) const;
+  void worldToScreen(const Vec2 *worldPos, Vec2 *screenPos, size_t count,
+                     int screenWidth, int screenHeight) const;
   Vec2 screenToWorld(const Vec2 &screenPos, int screenWidth,
                      int screenHeight) const;
 };
@@ -0,0 +1,228 @@
+#include "capture.h"
+#include <SDL2/SDL_image.h>
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+
+#ifdef _WIN32
+#define popen _popen
+#define pclose _pclose
+#endif
+
+namespace {
+
+// Accepts a path with exactly one integer conversion such as %d or %05d,
+// so user input never reaches snprintf as an arbitrary format string.
+bool isFramePattern(const std::string &path) {
+  size_t percent = path.find('%');
+  if (percent == std::string::npos)
+    return false;
+  size_t i = percent + 1;
+  while (i < path.size() && isdigit((unsigned char)path[i]))
+    i++;
+  return i < path.size() && path[i] == 'd' && path.find('%', i) == std::string::npos;
+}
+
+} // namespace
+
+Capture::Capture(const Options &options, int width, int height)
+    : options(options), width(width), height(height) {
+  if (width <= 0 || height <= 0)
+    return;
+  const std::string &path = options.path;
+  int threads = 1;
+  if (options.format == Format::PNG) {
+    if (isFramePattern(path)) {
+      pattern = path;
+    } else {
+      std::error_code error;
+      std::filesystem::create_directories(path, error);
+      if (error) {
+        fprintf(stderr, "Warning: Error creating capture directory: %s\n", path.c_str());
+        return;
+      }
+      pattern = (std::filesystem::path(path) / "frame_%06d.png").string();
+    }
+    threads = options.threads > 0
+                  ? options.threads
+                  : (int)std::min(4u, std::max(1u, std::thread::hardware_concurrency()));
+  } else {
+    pipe = !path.empty() && path[0] == '|';
+    stream = pipe ? popen(path.c_str() + 1, "w") : fopen(path.c_str(), "wb");
+    if (!stream) {
+      fprintf(stderr, "Warning: Error opening capture output: %s\n", path.c_str());
+      return;
+    }
+    if (options.format == Format::Y4M)
+      fprintf(stream, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C420jpeg\n", width, height,
+              std::max(1, options.fps));
+  }
+
+  slots.resize(std::max(1, options.buffers));
+  for (Slot &slot : slots)
+    slot.pixels.resize((size_t)width * height * 4);
+  for (int i = 0; i < threads; i++)
+    workers.emplace_back([this] { run(); });
+  open = true;
+}
+
+Capture::~Capture() { finish(); }
+
+uint8_t *Capture::acquire() {
+  std::lock_guard<std::mutex> lock(mutex);
+  if (!open || stopping) {
+    return nullptr;
+  }
+  for (Slot &slot : slots) {
+    if (!slot.busy) {
+      slot.busy = true;
+      return slot.pixels.data();
+    }
+  }
+  stats.dropped++;
+  return nullptr;
+}
+
+Capture::Slot *Capture::slotOf(uint8_t *pixels) {
+  for (Slot &slot : slots) {
+    if (slot.pixels.data() == pixels)
+      return &slot;
+  }
+  return nullptr;
+}
+
+void Capture::submit(uint8_t *pixels) {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    Slot *slot = slotOf(pixels);
+    if (!slot)
+      return;
+    slot->frame = nextFrame++;
+    queue.push_back(slot);
+    stats.captured++;
+  }
+  wake.notify_one();
+}
+
+void Capture::release(uint8_t *pixels) {
+  std::lock_guard<std::mutex> lock(mutex);
+  if (Slot *slot = slotOf(pixels))
+    slot->busy = false;
+}
+
+void Capture::drop() {
+  std::lock_guard<std::mutex> lock(mutex);
+  stats.dropped++;
+}
+
+void Capture::finish() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (stopping)
+      return;
+    stopping = true;
+  }
+  wake.notify_all();
+  for (auto &worker : workers)
+    worker.join();
+  workers.clear();
+  if (stream) {
+    if (pipe)
+      pclose(stream);
+    else
+      fclose(stream);
+    stream = nullptr;
+  }
+  open = false;
+}
+
+Capture::Stats Capture::getStats() {
+  std::lock_guard<std::mutex> lock(mutex);
+  Stats current = stats;
+  current.pending = queue.size();
+  return current;
+}
+
+void Capture::run() {
+  std::unique_lock<std::mutex> lock(mutex);
+  for (;;) {
+    wake.wait(lock, [this] { return stopping || !queue.empty(); });
+    // Queued frames are still written after finish() is called.
+    if (queue.empty())
+      return;
+    Slot *slot = queue.front();
+    queue.pop_front();
+    lock.unlock();
+    bool ok = write(*slot);
+    lock.lock();
+    if (ok)
+      stats.written++;
+    else
+      stats.failed++;
+    slot->busy = false;
+  }
+}
+
+bool Capture::write(const Slot &slot) {
+  switch (options.format) {
+  case Format::PNG:
+    return writePNG(slot);
+  case Format::Y4M:
+    return writeY4M(slot);
+  case Format::RGBA:
+    return fwrite(slot.pixels.data(), 1, slot.pixels.size(), stream) == slot.pixels.size();
+  }
+  return false;
+}
+
+bool Capture::writePNG(const Slot &slot) {
+  char name[1024];
+  snprintf(name, sizeof(name), pattern.c_str(), (int)slot.frame);
+  SDL_Surface *surface = SDL_CreateRGBSurfaceWithFormatFrom(
+      (void *)slot.pixels.data(), width, height, 32, width * 4, SDL_PIXELFORMAT_RGBA32);
+  if (!surface)
+    return false;
+  bool ok = IMG_SavePNG(surface, name) == 0;
+  SDL_FreeSurface(surface);
+  return ok;
+}
+
+bool Capture::writeY4M(const Slot &slot) {
+  // Full-range BT.601 to match the C420jpeg tag; chroma is the average of
+  // each 2x2 block, edge pixels repeated for odd sizes.
+  int chromaWidth = (width + 1) / 2, chromaHeight = (height + 1) / 2;
+  size_t lumaSize = (size_t)width * height;
+  size_t chromaSize = (size_t)chromaWidth * chromaHeight;
+  planes.resize(lumaSize + chromaSize * 2);
+  uint8_t *luma = planes.data();
+  uint8_t *cb = luma + lumaSize;
+  uint8_t *cr = cb + chromaSize;
+  const uint8_t *rgba = slot.pixels.data();
+
+  for (size_t i = 0; i < lumaSize; i++) {
+    const uint8_t *p = rgba + i * 4;
+    luma[i] = (uint8_t)((77 * p[0] + 150 * p[1] + 29 * p[2] + 128) >> 8);
+  }
+  for (int y = 0; y < chromaHeight; y++) {
+    int y0 = y * 2, y1 = std::min(y0 + 1, height - 1);
+    for (int x = 0; x < chromaWidth; x++) {
+      int x0 = x * 2, x1 = std::min(x0 + 1, width - 1);
+      int r = 0, g = 0, b = 0;
+      for (int sy : {y0, y1}) {
+        for (int sx : {x0, x1}) {
+          const uint8_t *p = rgba + ((size_t)sy * width + sx) * 4;
+          r += p[0];
+          g += p[1];
+          b += p[2];
+        }
+      }
+      // Sums of four samples: scale by 1/4 inside the >> 10.
+      cb[(size_t)y * chromaWidth + x] =
+          (uint8_t)std::min(255, (-43 * r - 85 * g + 128 * b + (128 << 10) + 512) >> 10);
+      cr[(size_t)y * chromaWidth + x] =
+          (uint8_t)std::min(255, (128 * r - 107 * g - 21 * b + (128 << 10) + 512) >> 10);
+    }
+  }
+  return fputs("FRAME\n", stream) >= 0 &&
+         fwrite(planes.data(), 1, planes.size(), stream) == planes.size();
+}
@@ -0,0 +1,95 @@
+#ifndef TENSAI_CAPTURE_H
+#define TENSAI_CAPTURE_H
+
+#include <SDL2/SDL.h>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Records presented frames. The renderer copies each frame into one of a
+// fixed ring of buffers; worker threads encode and write them. When every
+// buffer is still queued the frame is dropped and counted rather than
+// waited for, so recording never stalls the frame.
+class Capture {
+public:
+  enum class Format {
+    PNG,  // one file per frame
+    Y4M,  // YUV 4:2:0 stream with a YUV4MPEG2 header
+    RGBA, // headerless RGBA stream, e.g. for ffmpeg -f rawvideo
+  };
+
+  struct Options {
+    Format format = Format::PNG;
+    // PNG: printf pattern for the frame number ("shots/%05d.png") or a
+    // directory. Streams: a file, or "|command" to pipe into a process.
+    std::string path;
+    int buffers = 4;
+    int threads = 0; // PNG encoders; 0 picks the core count, capped at 4
+    int fps = 60;    // Y4M header only
+  };
+
+  struct Stats {
+    uint64_t captured = 0; // frames handed to the workers
+    uint64_t dropped = 0;  // frames skipped because no buffer was free
+    uint64_t written = 0;
+    uint64_t failed = 0; // frames the workers could not write
+    size_t pending = 0;
+  };
+
+  Capture(const Options &options, int width, int height);
+  ~Capture();
+
+  bool isOpen() const { return open; }
+  int getWidth() const { return width; }
+  int getHeight() const { return height; }
+
+  // Renderer side. acquire returns a free width x height RGBA32 buffer, or
+  // nullptr after counting a drop; every acquired buffer must go back
+  // through submit (filled) or release (abandoned).
+  uint8_t *acquire();
+  void submit(uint8_t *pixels);
+  void release(uint8_t *pixels);
+  void drop();
+
+  // Writes everything queued, stops the workers and closes the output.
+  void finish();
+  Stats getStats();
+
+private:
+  struct Slot {
+    std::vector<uint8_t> pixels;
+    uint64_t frame = 0;
+    bool busy = false;
+  };
+
+  Options options;
+  int width, height;
+  bool open = false;
+  FILE *stream = nullptr;
+  bool pipe = false;
+  std::string pattern;
+
+  std::vector<Slot> slots;
+  std::vector<std::thread> workers;
+  std::mutex mutex;
+  std::condition_variable wake;
+  std::deque<Slot *> queue;
+  Stats stats;
+  uint64_t nextFrame = 0;
+  bool stopping = false;
+  // Y4M conversion scratch; streams have a single worker.
+  std::vector<uint8_t> planes;
+
+  Slot *slotOf(uint8_t *pixels);
+  void run();
+  bool write(const Slot &slot);
+  bool writePNG(const Slot &slot);
+  bool writeY4M(const Slot &slot);
+};
+
+#endif // TENSAI_CAPTURE_H
@@ -0,0 +1,340 @@
+#include "ecs.h"
+#include <cstring>
+
+namespace {
+
+constexpr uint32_t GenerationMask = 0xfff;
+
+const char *const FieldNames[EntityStore::FieldCount] = {
+    "x",    "y",         "rotation",   "scaleX",  "scaleY", "vx", "vy",
+    "life", "halfWidth", "halfHeight", "texture", "tint",   "entity"};
+
+float defaultValue(int field) {
+  return field == EntityStore::ScaleX || field == EntityStore::ScaleY ? 1.0f : 0.0f;
+}
+
+template <typename T> void moveLast(std::vector<T> &column, uint32_t row) {
+  column[row] = column.back();
+  column.pop_back();
+}
+
+} // namespace
+
+uint32_t EntityStore::fieldComponent(Field field) {
+  switch (field) {
+  case X:
+  case Y:
+  case Rotation:
+  case ScaleX:
+  case ScaleY:
+    return Transform;
+  case VX:
+  case VY:
+    return Velocity;
+  case Life:
+    return Lifetime;
+  case HalfWidth:
+  case HalfHeight:
+    return Collider;
+  case Texture:
+  case Tint:
+    return Sprite;
+  default:
+    return 0;
+  }
+}
+
+const char *EntityStore::fieldName(Field field) { return FieldNames[field]; }
+
+EntityStore::Field EntityStore::fieldByName(const char *name, bool &found) {
+  for (int field = 0; field < FieldCount; field++) {
+    if (strcmp(FieldNames[field], name) == 0) {
+      found = true;
+      return (Field)field;
+    }
+  }
+  found = false;
+  return X;
+}
+
+const EntityStore::Record *EntityStore::record(uint32_t entity) const {
+  uint32_t slot = slotOf(entity);
+  if (slot >= records.size())
+    return nullptr;
+  const Record &r = records[slot];
+  if (r.archetype < 0 || r.generation != entity >> IndexBits)
+    return nullptr;
+  return &r;
+}
+
+int EntityStore::archetypeFor(uint32_t mask) {
+  auto it = archetypeByMask.find(mask);
+  if (it != archetypeByMask.end())
+    return it->second;
+  auto archetype = std::make_unique<Archetype>();
+  archetype->mask = mask;
+  archetypes.push_back(std::move(archetype));
+  int index = (int)archetypes.size() - 1;
+  archetypeByMask[mask] = index;
+  return index;
+}
+
+uint32_t EntityStore::pushRow(Archetype &archetype, uint32_t entity) {
+  archetype.entities.push_back(entity);
+  for (int field = 0; field < FloatFieldCount; field++) {
+    if (archetype.mask & fieldComponent((Field)field))
+      archetype.floats[field].push_back(defaultValue(field));
+  }
+  if (archetype.mask & Sprite) {
+    archetype.textures.push_back(-1);
+    archetype.tints.push_back(0xffffffff);
+  }
+  return (uint32_t)archetype.entities.size() - 1;
+}
+
+void EntityStore::removeRow(Archetype &archetype, uint32_t row) {
+  uint32_t last = (uint32_t)archetype.entities.size() - 1;
+  if (row != last)
+    records[slotOf(archetype.entities[last])].row = row;
+  moveLast(archetype.entities, row);
+  for (int field = 0; field < FloatFieldCount; field++) {
+    if (archetype.mask & fieldComponent((Field)field))
+      moveLast(archetype.floats[field], row);
+  }
+  if (archetype.mask & Sprite) {
+    moveLast(archetype.textures, row);
+    moveLast(archetype.tints, row);
+  }
+}
+
+void EntityStore::copyRow(const Archetype &from, uint32_t fromRow, Archetype &to,
+                          uint32_t toRow) {
+  uint32_t shared = from.mask & to.mask;
+  for (int field = 0; field < FloatFieldCount; field++) {
+    if (shared & fieldComponent((Field)field))
+      to.floats[field][toRow] = from.floats[field][fromRow];
+  }
+  if (shared & Sprite) {
+    to.textures[toRow] = from.textures[fromRow];
+    to.tints[toRow] = from.tints[fromRow];
+  }
+}
+
+uint32_t EntityStore::create(uint32_t mask) {
+  uint32_t slot;
+  if (!freeSlots.empty()) {
+    slot = freeSlots.back();
+    freeSlots.pop_back();
+  } else {
+    if (records.size() >= MaxEntities)
+      return 0;
+    slot = (uint32_t)records.size();
+    records.emplace_back();
+    records.back().generation = 1;
+  }
+
+  Record &r = records[slot];
+  uint32_t entity = (r.generation << IndexBits) | slot;
+  r.archetype = archetypeFor(mask & ComponentMask);
+  r.row = pushRow(*archetypes[r.archetype], entity);
+  count++;
+  return entity;
+}
+
+void EntityStore::reserve(uint32_t mask, size_t extra) {
+  Archetype &archetype = *archetypes[archetypeFor(mask & ComponentMask)];
+  size_t capacity = archetype.size() + extra;
+  archetype.entities.reserve(capacity);
+  for (int field = 0; field < FloatFieldCount; field++) {
+    if (archetype.mask & fieldComponent((Field)field))
+      archetype.floats[field].reserve(capacity);
+  }
+  if (archetype.mask & Sprite) {
+    archetype.textures.reserve(capacity);
+    archetype.tints.reserve(capacity);
+  }
+}
+
+void EntityStore::destroy(uint32_t entity) {
+  if (!record(entity))
+    return;
+  Record &r = records[slotOf(entity)];
+  removeRow(*archetypes[r.archetype], r.row);
+  r.archetype = -1;
+  // Generation 0 is skipped so that handle 0 is never valid.
+  r.generation = (r.generation + 1) & GenerationMask;
+  if (r.generation == 0)
+    r.generation = 1;
+  freeSlots.push_back(slotOf(entity));
+  count--;
+}
+
+bool EntityStore::alive(uint32_t entity) const { return record(entity) != nullptr; }
+
+uint32_t EntityStore::getMask(uint32_t entity) const {
+  const Record *r = record(entity);
+  return r ? archetypes[r->archetype]->mask : 0;
+}
+
+void EntityStore::setMask(uint32_t entity, uint32_t mask) {
+  const Record *r = record(entity);
+  mask &= ComponentMask;
+  if (!r || archetypes[r->archetype]->mask == mask)
+    return;
+  int target = archetypeFor(mask);
+  Record &current = records[slotOf(entity)];
+  Archetype &from = *archetypes[current.archetype];
+  Archetype &to = *archetypes[target];
+  uint32_t row = pushRow(to, entity);
+  copyRow(from, current.row, to, row);
+  removeRow(from, current.row);
+  current.archetype = target;
+  current.row = row;
+}
+
+float *EntityStore::floatField(uint32_t entity, Field field) {
+  const Record *r = record(entity);
+  if (!r || field >= FloatFieldCount)
+    return nullptr;
+  Archetype &archetype = *archetypes[r->archetype];
+  if (!(archetype.mask & fieldComponent(field)))
+    return nullptr;
+  return &archetype.floats[field][r->row];
+}
+
+int32_t *EntityStore::textureField(uint32_t entity) {
+  const Record *r = record(entity);
+  if (!r || !(archetypes[r->archetype]->mask & Sprite))
+    return nullptr;
+  return &archetypes[r->archetype]->textures[r->row];
+}
+
+uint32_t *EntityStore::tintField(uint32_t entity) {
+  const Record *r = record(entity);
+  if (!r || !(archetypes[r->archetype]->mask & Sprite))
+    return nullptr;
+  return &archetypes[r->archetype]->tints[r->row];
+}
+
+void EntityStore::matching(uint32_t mask, std::vector<int> &out) const {
+  for (size_t i = 0; i < archetypes.size(); i++) {
+    if ((archetypes[i]->mask & mask) == mask)
+      out.push_back((int)i);
+  }
+}
+
+void EntityStore::integrate(float dt) {
+  for (auto &archetype : archetypes) {
+    if ((archetype->mask & (Transform | Velocity)) != (Transform | Velocity))
+      continue;
+    size_t n = archetype->size();
+    float *x = archetype->floats[X].data(), *y = archetype->floats[Y].data();
+    const float *vx = archetype->floats[VX].data(), *vy = archetype->floats[VY].data();
+    for (size_t i = 0; i < n; i++) {
+      x[i] += vx[i] * dt;
+      y[i] += vy[i] * dt;
+    }
+  }
+}
+
+void EntityStore::expire(float dt, std::vector<uint32_t> &destroyed) {
+  for (auto &archetype : archetypes) {
+    if (!(archetype->mask & Lifetime))
+      continue;
+    std::vector<float> &life = archetype->floats[Life];
+    for (float &remaining : life)
+      remaining -= dt;
+    // Walk backwards so swap-removal only moves rows already visited.
+    for (size_t i = archetype->size(); i-- > 0;) {
+      if (life[i] <= 0.0f) {
+        destroyed.push_back(archetype->entities[i]);
+        destroy(archetype->entities[i]);
+      }
+    }
+  }
+}
+
+void EntityStore::cull(const Rect &bounds, uint32_t mask,
+                       std::vector<uint32_t> &destroyed) {
+  mask |= Transform;
+  for (auto &archetype : archetypes) {
+    if ((archetype->mask & mask) != mask)
+      continue;
+    const std::vector<float> &x = archetype->floats[X], &y = archetype->floats[Y];
+    for (size_t i = archetype->size(); i-- > 0;) {
+      if (!bounds.contains(Vec2(x[i], y[i]))) {
+        destroyed.push_back(archetype->entities[i]);
+        destroy(archetype->entities[i]);
+      }
+    }
+  }
+}
+
+void EntityStore::render(Graphics &graphics,
+                         const std::vector<std::shared_ptr<::Texture>> &textures) {
+  ::Transform transform;
+  for (auto &archetype : archetypes) {
+    if ((archetype->mask & (Transform | Sprite)) != (Transform | Sprite))
+      continue;
+    const Archetype &a = *archetype;
+    for (size_t i = 0; i < a.size(); i++) {
+      int32_t slot = a.textures[i];
+      if (slot < 0 || slot >= (int32_t)textures.size() || !textures[slot])
+        continue;
+      const std::shared_ptr<::Texture> &texture = textures[slot];
+      // Sprites are centered on (x, y).
+      transform.position = Vec2(a.floats[X][i], a.floats[Y][i]);
+      transform.scale = Vec2(a.floats[ScaleX][i], a.floats[ScaleY][i]);
+      transform.setRotation(a.floats[Rotation][i]);
+      transform.origin = Vec2(texture->width * 0.5f, texture->height * 0.5f);
+      uint32_t tint = a.tints[i];
+      graphics.drawTexture(texture, transform,
+                           Color(tint >> 24, (tint >> 16) & 0xff, (tint >> 8) & 0xff,
+                                 tint & 0xff));
+    }
+  }
+}
+
+void EntityStore::gatherColliders(uint32_t mask) {
+  collisionEntities.clear();
+  collisionBoxes.clear();
+  mask |= Transform | Collider;
+  for (auto &archetype : archetypes) {
+    if ((archetype->mask & mask) != mask)
+      continue;
+    const Archetype &a = *archetype;
+    for (size_t i = 0; i < a.size(); i++) {
+      float x = a.floats[X][i], y = a.floats[Y][i];
+      float hw = a.floats[HalfWidth][i], hh = a.floats[HalfHeight][i];
+      collisionEntities.push_back(a.entities[i]);
+      collisionBoxes.insert(collisionBoxes.end(), {x - hw, y - hh, x + hw, y + hh});
+    }
+  }
+}
+
+void EntityStore::collide(uint32_t maskA, uint32_t maskB,
+                          std::vector<uint32_t> &pairs) {
+  gatherColliders(maskB);
+  collisionIndex.build(collisionBoxes.data(), collisionEntities.size());
+
+  maskA |= Transform | Collider;
+  for (auto &archetype : archetypes) {
+    if ((archetype->mask & maskA) != maskA)
+      continue;
+    const Archetype &a = *archetype;
+    for (size_t i = 0; i < a.size(); i++) {
+      float x = a.floats[X][i], y = a.floats[Y][i];
+      float hw = a.floats[HalfWidth][i], hh = a.floats[HalfHeight][i];
+      collisionHits.clear();
+      collisionIndex.queryAABB({Vec2(x - hw, y - hh), Vec2(x + hw, y + hh)},
+                               collisionHits);
+      for (int hit : collisionHits) {
+        uint32_t other = collisionEntities[hit];
+        if (other == a.entities[i])
+          continue;
+        pairs.push_back(a.entities[i]);
+        pairs.push_back(other);
+      }
+    }
+  }
+}
@@ -0,0 +1,129 @@
+#ifndef TENSAI_ECS_H
+#define TENSAI_ECS_H
+
+#include "../core/rect.h"
+#include "../resources/texture.h"
+#include "graphics.h"
+#include "spatial_index.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+// Entity-component store. Entities sharing a component mask live in one
+// archetype whose fields are stored as parallel arrays (structure of arrays),
+// so the built-in systems are tight loops over contiguous columns and
+// creating or destroying entities never allocates per entity.
+//
+// Entity handles pack a slot index (low 20 bits) with a generation, so stale
+// handles to a reused slot are rejected.
+class EntityStore {
+public:
+  enum Component : uint32_t {
+    Transform = 1 << 0, // x, y, rotation, scaleX, scaleY
+    Velocity = 1 << 1,  // vx, vy
+    Lifetime = 1 << 2,  // life (seconds remaining)
+    Sprite = 1 << 3,    // texture slot, tint (0xRRGGBBAA)
+    Collider = 1 << 4,  // halfWidth, halfHeight around (x, y)
+  };
+  // Bits 8-15 are data-less tags games use to tell entity kinds apart.
+  static constexpr uint32_t TagMask = 0xff00;
+  static constexpr uint32_t ComponentMask = 0x1f | TagMask;
+
+  enum Field {
+    X,
+    Y,
+    Rotation,
+    ScaleX,
+    ScaleY,
+    VX,
+    VY,
+    Life,
+    HalfWidth,
+    HalfHeight,
+    FloatFieldCount,
+    Texture = FloatFieldCount,
+    Tint,
+    EntityId,
+    FieldCount
+  };
+
+  struct Archetype {
+    uint32_t mask;
+    std::vector<uint32_t> entities;
+    std::vector<float> floats[FloatFieldCount];
+    std::vector<int32_t> textures;
+    std::vector<uint32_t> tints;
+
+    size_t size() const { return entities.size(); }
+  };
+
+  static constexpr uint32_t IndexBits = 20;
+  static constexpr uint32_t MaxEntities = 1u << IndexBits;
+
+  static uint32_t fieldComponent(Field field);
+  static const char *fieldName(Field field);
+  static Field fieldByName(const char *name, bool &found);
+
+  uint32_t create(uint32_t mask);
+  // Grows the columns of the archetype for `mask` so `extra` more entities
+  // fit without reallocating.
+  void reserve(uint32_t mask, size_t extra);
+  void destroy(uint32_t entity);
+  bool alive(uint32_t entity) const;
+  uint32_t getMask(uint32_t entity) const;
+  // Moves the entity to the archetype for its new mask, keeping shared
+  // fields.
+  void setMask(uint32_t entity, uint32_t mask);
+
+  // Pointers into the entity's row; null when it lacks the component. Valid
+  // until the next create, destroy or mask change.
+  float *floatField(uint32_t entity, Field field);
+  int32_t *textureField(uint32_t entity);
+  uint32_t *tintField(uint32_t entity);
+
+  size_t size() const { return count; }
+  size_t archetypeCount() const { return archetypes.size(); }
+  Archetype &getArchetype(size_t index) { return *archetypes[index]; }
+  // Archetypes whose mask contains every bit of `mask`.
+  void matching(uint32_t mask, std::vector<int> &out) const;
+
+  // Built-in systems. Entities they destroy are appended to `destroyed`.
+  void integrate(float dt);
+  void expire(float dt, std::vector<uint32_t> &destroyed);
+  void cull(const Rect &bounds, uint32_t mask, std::vector<uint32_t> &destroyed);
+  void render(Graphics &graphics,
+              const std::vector<std::shared_ptr<::Texture>> &textures);
+  // Overlapping collider pairs (a, b) with a matching maskA and b matching
+  // maskB.
+  void collide(uint32_t maskA, uint32_t maskB, std::vector<uint32_t> &pairs);
+
+private:
+  struct Record {
+    uint32_t generation = 0;
+    int archetype = -1;
+    uint32_t row = 0;
+  };
+
+  std::vector<Record> records;
+  std::vector<uint32_t> freeSlots;
+  std::vector<std::unique_ptr<Archetype>> archetypes;
+  std::unordered_map<uint32_t, int> archetypeByMask;
+  size_t count = 0;
+  SpatialIndex collisionIndex;
+  std::vector<uint32_t> collisionEntities;
+  std::vector<float> collisionBoxes;
+  std::vector<int> collisionHits;
+
+  static uint32_t slotOf(uint32_t entity) { return entity & (MaxEntities - 1); }
+  const Record *record(uint32_t entity) const;
+  int archetypeFor(uint32_t mask);
+  uint32_t pushRow(Archetype &archetype, uint32_t entity);
+  void removeRow(Archetype &archetype, uint32_t row);
+  void copyRow(const Archetype &from, uint32_t fromRow, Archetype &to,
+               uint32_t toRow);
+  void gatherColliders(uint32_t mask);
+};
+
+#endif // TENSAI_ECS_H
@@ -1,175 +1,1025 @@
 #include "graphics.h"
+#include "texture_residency.h"
+#include <cmath>
 #include <cstdio>
 #include <cstdlib>
 
-Graphics::Graphics(SDL_Renderer *r) : renderer(r) {
+namespace {
+
+constexpr uint64_t HashOffset = 1469598103934665603ull;
+
+uint64_t hashBytes(uint64_t hash, const void *data, size_t size) {
+  const uint8_t *bytes = (const uint8_t *)data;
+  for (size_t i = 0; i < size; i++) {
+    hash ^= bytes[i];
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+SDL_Rect boundsOf(float minX, float minY, float maxX, float maxY) {
+  int x0 = (int)std::floor(minX), y0 = (int)std::floor(minY);
+  return {x0, y0, (int)std::ceil(maxX) - x0 + 1, (int)std::ceil(maxY) - y0 + 1};
+}
+
+SDL_Rect pointBounds(const SDL_Point *points, uint32_t count) {
+  if (count == 0)
+    return {0, 0, 0, 0};
+  int minX = points[0].x, minY = points[0].y, maxX = minX, maxY = minY;
+  for (uint32_t i = 1; i < count; i++) {
+    minX = std::min(minX, points[i].x);
+    minY = std::min(minY, points[i].y);
+    maxX = std::max(maxX, points[i].x);
+    maxY = std::max(maxY, points[i].y);
+  }
+  return {minX, minY, maxX - minX + 1, maxY - minY + 1};
+}
+
+bool sameItem(const SDL_Rect &a, uint64_t hashA, const SDL_Rect &b, uint64_t hashB) {
+  return hashA == hashB && a.x == b.x && a.y == b.y && a.w == b.w && a.h == b.h;
+}
+
+// Adds `rect` to the damage list, merging it with any region it overlaps.
+void addDamage(std::vector<SDL_Rect> &damage, SDL_Rect rect, const SDL_Rect &screen) {
+  if (!SDL_IntersectRect(&rect, &screen, &rect))
+    return;
+  for (size_t i = 0; i < damage.size();) {
+    if (SDL_HasIntersection(&damage[i], &rect)) {
+      SDL_UnionRect(&damage[i], &rect, &rect);
+      damage[i] = damage.back();
+      damage.pop_back();
+      i = 0;
+    } else {
+      i++;
+    }
+  }
+  damage.push_back(rect);
+}
+
+} // namespace
+
+void Graphics::CommandList::clear() {
+  commands.clear();
+  points.clear();
+  vertices.clear();
+  indices.clear();
+  textures.clear();
+  for (SDL_Surface *surface : surfaces)
+    SDL_FreeSurface(surface);
+  surfaces.clear();
+  bounds.clear();
+  damage.clear();
+  retained = false;
+  fullRedraw = false;
+}
+
+Graphics::Graphics(SDL_Renderer *r, Backend backend, int rasterThreads)
+    : renderer(r), backend(backend) {
   if (!renderer) {
     fprintf(stderr, "Error: SDL_Renderer is NULL in Graphics constructor.\n");
     exit(1);
   }
+  if (backend == Backend::Software)
+    rasterPool = std::make_unique<ThreadPool>(rasterThreads);
+  renderTargets = SDL_RenderTargetSupported(renderer) == SDL_TRUE;
 }
 
-void Graphics::setColor(const Color &color) {
-  currentColor = color;
-  if (SDL_SetRenderDrawColor(renderer, color.r, color.g, color.b, color.a) != 0) {
-    fprintf(stderr, "Error setting render draw color: %s\n", SDL_GetError());
-    exit(1);
+Graphics::~Graphics() {
+  setThreaded(false);
+  if (screenTexture)
+    SDL_DestroyTexture(screenTexture);
+}
+
+void Graphics::setThreaded(bool enabled) {
+  if (enabled == isThreaded())
+    return;
+  if (enabled) {
+    releaseRendererContext(renderer);
+    renderThread = std::make_unique<RenderThread>(renderer);
+  } else {
+    renderThread->wait(lastFrame);
+    renderThread.reset();
+    lastFrame = 0;
   }
 }
 
+void Graphics::setRetained(bool enabled) {
+  if (enabled == retained)
+    return;
+  if (enabled && !renderTargets && !isSoftware()) {
+    fprintf(stderr, "Warning: Retained mode needs render target support\n");
+    return;
+  }
+  if (!enabled) {
+    // Queued behind any in-flight frame, so the executor is done with it.
+    runOnRenderer([this] { backBuffer.reset(); });
+    previousItems.clear();
+    dirtyBounds = {0, 0, 0, 0};
+    dirtyRectCount = 0;
+    retained = false;
+    return;
+  }
+
+  runOnRenderer([this] {
+    updateIdleFrame();
+    if (isSoftware()) {
+      int width = 0, height = 0;
+      SDL_GetRendererOutputSize(renderer, &width, &height);
+      outputWidth = width;
+      outputHeight = height;
+      return;
+    }
+    fitBackBuffer();
+  });
+  if (!backBuffer && !isSoftware())
+    return;
+  retained = true;
+  damageAll = true;
+}
+
+void Graphics::setIdleFrameRate(double fps) {
+  runOnRenderer([&] {
+    idleFrameRate = fps > 0.0 ? fps : 0.0;
+    updateIdleFrame();
+  });
+}
+
+void Graphics::updateIdleFrame() {
+  double fps = idleFrameRate;
+  if (fps <= 0.0) {
+    SDL_DisplayMode mode;
+    int refresh = SDL_GetWindowDisplayMode(SDL_RenderGetWindow(renderer), &mode) == 0
+                      ? mode.refresh_rate
+                      : 0;
+    fps = refresh > 0 ? refresh : 60;
+  }
+  idleFrameMs = 1000.0 / fps;
+}
+
+bool Graphics::fitBackBuffer() {
+  int width = 0, height = 0;
+  SDL_GetRendererOutputSize(renderer, &width, &height);
+  if (backBuffer && backBuffer->width == width && backBuffer->height == height)
+    return false;
+
+  SDL_Texture *target = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888,
+                                          SDL_TEXTUREACCESS_TARGET, width, height);
+  if (!target) {
+    // Keep drawing into the old buffer; it is stretched over the output.
+    fprintf(stderr, "Warning: Error creating back buffer: %s\n", SDL_GetError());
+    return false;
+  }
+  SDL_SetTextureBlendMode(target, SDL_BLENDMODE_NONE);
+  backBuffer = std::make_shared<Texture>();
+  backBuffer->texture = target;
+  backBuffer->width = width;
+  backBuffer->height = height;
+  backBuffer->canvas = true;
+  outputWidth = width;
+  outputHeight = height;
+  return true;
+}
+
+void Graphics::setCapture(std::shared_ptr<Capture> next) {
+  runOnRenderer([&] { capture = std::move(next); });
+}
+
+void Graphics::runOnRenderer(const std::function<void()> &job) {
+  if (renderThread)
+    renderThread->invoke(job);
+  else
+    job();
+}
+
+void Graphics::retire(std::shared_ptr<Texture> texture) {
+  if (texture)
+    recording->textures.push_back(std::move(texture));
+}
+
+Graphics::Command &Graphics::record(Command::Type type) {
+  recording->commands.emplace_back();
+  Command &command = recording->commands.back();
+  command.type = type;
+  command.color = currentColor;
+  return command;
+}
+
+int Graphics::recordTexture(std::shared_ptr<Texture> texture) {
+  recording->textures.push_back(std::move(texture));
+  return (int)recording->textures.size() - 1;
+}
+
+void Graphics::recordPoints(Command::Type type, const SDL_Point *points,
+                            size_t count) {
+  Command &command = record(type);
+  command.first = (uint32_t)recording->points.size();
+  command.count = (uint32_t)count;
+  recording->points.insert(recording->points.end(), points, points + count);
+}
+
+void Graphics::setColor(const Color &color) { currentColor = color; }
+
 void Graphics::setFont(std::shared_ptr<Font> font) { currentFont = font; }
 void Graphics::setLineWidth(float width) { lineWidth = width; }
 
-void Graphics::clear(const Color &color) {
-  if (SDL_SetRenderDrawColor(renderer, color.r, color.g, color.b, color.a) != 0) {
-    fprintf(stderr, "Error setting render draw color for clear: %s\n", SDL_GetError());
-    exit(1);
+std::shared_ptr<Texture> Graphics::createCanvas(int width, int height) {
+  std::shared_ptr<Texture> canvas;
+  if (!renderTargets) {
+    fprintf(stderr, "Warning: Error creating canvas: render targets unsupported\n");
+    return canvas;
   }
-  if (SDL_RenderClear(renderer) != 0) {
-    fprintf(stderr, "Error clearing renderer: %s\n", SDL_GetError());
-    exit(1);
+  runOnRenderer([&] {
+    SDL_Texture *target = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888,
+                                            SDL_TEXTUREACCESS_TARGET, width, height);
+    if (!target) {
+      fprintf(stderr, "Warning: Error creating canvas: %s\n", SDL_GetError());
+      return;
+    }
+    SDL_SetTextureBlendMode(target, SDL_BLENDMODE_BLEND);
+
+    canvas = std::make_shared<Texture>();
+    canvas->texture = target;
+    canvas->width = width;
+    canvas->height = height;
+    canvas->canvas = true;
+    if (isSoftware()) {
+      canvas->pixels.assign((size_t)width * height, 0);
+      return;
+    }
+
+    // Fresh target textures hold undefined pixels; start fully transparent.
+    SDL_Texture *previous = SDL_GetRenderTarget(renderer);
+    SDL_SetRenderTarget(renderer, target);
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+    SDL_RenderClear(renderer);
+    SDL_SetRenderTarget(renderer, previous);
+  });
+  return canvas;
+}
+
+void Graphics::setCanvas(std::shared_ptr<Texture> canvas) {
+  if (canvas && (!canvas->texture || !canvas->canvas))
+    return;
+  flush();
+  record(Command::Target).resource = canvas ? recordTexture(canvas) : -1;
+  currentCanvas = canvas;
+}
+
+std::shared_ptr<Texture> Graphics::getCanvas() const { return currentCanvas; }
+
+void Graphics::setDeferred(bool enabled) {
+  if (!enabled)
+    flush();
+  deferred = enabled;
+}
+
+void Graphics::setLayer(int l) { layer = l; }
+
+void Graphics::flush() {
+  if (!sprites.empty())
+    flushSprites();
+}
+
+void Graphics::applyTextureMod(Texture &texture, const Color &tint) {
+  if (texture.mod.r != tint.r || texture.mod.g != tint.g ||
+      texture.mod.b != tint.b) {
+    if (SDL_SetTextureColorMod(texture.texture, tint.r, tint.g, tint.b) != 0) {
+      fprintf(stderr, "Error setting texture color mod: %s\n", SDL_GetError());
+      exit(1);
+    }
+  }
+  if (texture.mod.a != tint.a) {
+    if (SDL_SetTextureAlphaMod(texture.texture, tint.a) != 0) {
+      fprintf(stderr, "Error setting texture alpha mod: %s\n", SDL_GetError());
+      exit(1);
+    }
   }
+  texture.mod = tint;
 }
 
-void Graphics::present() { SDL_RenderPresent(renderer); }
+void Graphics::flushSprites() {
+  std::stable_sort(sprites.begin(), sprites.end(),
+                   [](const SpriteDraw &a, const SpriteDraw &b) {
+                     if (a.layer != b.layer)
+                       return a.layer < b.layer;
+                     // By creation order, not address, so overlapping
+                     // sprites stack the same way on every run.
+                     if (a.texture != b.texture)
+                       return a.texture->id < b.texture->id;
+                     return a.tint < b.tint;
+                   });
 
-void Graphics::drawPoint(const Vec2 &pos) {
-  if (SDL_RenderDrawPoint(renderer, (int)pos.x, (int)pos.y) != 0) {
-    fprintf(stderr, "Error drawing point: %s\n", SDL_GetError());
-    exit(1);
+  // Tint travels in the vertex colors, so a run of draws sharing a texture
+  // becomes a single geometry call regardless of tint.
+  static const SDL_FPoint uvs[4] = {{0, 0}, {1, 0}, {1, 1}, {0, 1}};
+  std::vector<SDL_Vertex> &vertices = recording->vertices;
+  std::vector<int> &indices = recording->indices;
+  size_t start = 0;
+  while (start < sprites.size()) {
+    Command &command = record(Command::Geometry);
+    command.resource = recordTexture(sprites[start].texture);
+    command.first = (uint32_t)vertices.size();
+    command.indexFirst = (uint32_t)indices.size();
+    size_t end = start;
+    while (end < sprites.size() && sprites[end].texture == sprites[start].texture) {
+      const SpriteDraw &sprite = sprites[end];
+      SDL_Color color = {(Uint8)(sprite.tint >> 24), (Uint8)(sprite.tint >> 16),
+                         (Uint8)(sprite.tint >> 8), (Uint8)sprite.tint};
+      int base = (int)(vertices.size() - command.first);
+      for (int i = 0; i < 4; i++) {
+        vertices.push_back({sprite.corners[i], color, uvs[i]});
+      }
+      int quad[6] = {base, base + 1, base + 2, base, base + 2, base + 3};
+      indices.insert(indices.end(), quad, quad + 6);
+      end++;
+    }
+    command.count = (uint32_t)(vertices.size() - command.first);
+    command.indexCount = (uint32_t)(indices.size() - command.indexFirst);
+    start = end;
   }
+  sprites.clear();
 }
 
-void Graphics::drawLine(const Vec2 &start, const Vec2 &end) {
-  if (lineWidth <= 1.0f) {
-    if (SDL_RenderDrawLine(renderer, (int)start.x, (int)start.y, (int)end.x,
-                           (int)end.y) != 0) {
-      fprintf(stderr, "Error drawing line: %s\n", SDL_GetError());
-      exit(1);
+void Graphics::computeDamage(CommandList &list) {
+  SDL_Rect screen = {0, 0, outputWidth, outputHeight};
+  list.retained = true;
+  list.fullRedraw = damageAll;
+  items.clear();
+  for (const Command &command : list.commands) {
+    const SDL_Point *points = list.points.data() + command.first;
+    uint64_t hash = hashBytes(HashOffset, &command.type, sizeof(command.type));
+    hash = hashBytes(hash, &command.color, sizeof(command.color));
+    hash = hashBytes(hash, &command.rect, sizeof(command.rect));
+    hash = hashBytes(hash, &command.angle, sizeof(command.angle));
+    hash = hashBytes(hash, &command.center, sizeof(command.center));
+
+    SDL_Rect bounds = screen;
+    switch (command.type) {
+    case Command::Clear:
+      break;
+    case Command::Target:
+      // Canvas contents are invisible to the diff; redraw the whole frame.
+      list.fullRedraw = true;
+      break;
+    case Command::Points:
+    case Command::Lines:
+    case Command::Segments:
+      bounds = pointBounds(points, command.count);
+      hash = hashBytes(hash, points, command.count * sizeof(SDL_Point));
+      break;
+    case Command::Rect:
+    case Command::FillRect:
+      bounds = command.rect;
+      break;
+    case Command::Copy: {
+      const Texture *texture = list.textures[command.resource].get();
+      hash = hashBytes(hash, &texture, sizeof(texture));
+      bounds = command.rect;
+      if (command.angle != 0.0) {
+        Vec2 corners[4] = {
+            Vec2(command.rect.x, command.rect.y),
+            Vec2(command.rect.x + command.rect.w, command.rect.y),
+            Vec2(command.rect.x + command.rect.w, command.rect.y + command.rect.h),
+            Vec2(command.rect.x, command.rect.y + command.rect.h)};
+        Vec2 pivot(command.rect.x + command.center.x, command.rect.y + command.center.y);
+        transformPoints(Mat::rotation((float)(command.angle * M_PI / 180.0), pivot),
+                        corners, corners, 4);
+        Rect box = computeBounds(corners, 4);
+        bounds = boundsOf(box.x, box.y, box.x + box.w, box.y + box.h);
+      }
+      break;
+    }
+    case Command::Geometry: {
+      const Texture *texture = list.textures[command.resource].get();
+      const SDL_Vertex *vertices = list.vertices.data() + command.first;
+      hash = hashBytes(hash, &texture, sizeof(texture));
+      hash = hashBytes(hash, vertices, command.count * sizeof(SDL_Vertex));
+      hash = hashBytes(hash, list.indices.data() + command.indexFirst,
+                       command.indexCount * sizeof(int));
+      float minX = vertices[0].position.x, minY = vertices[0].position.y;
+      float maxX = minX, maxY = minY;
+      for (uint32_t i = 1; i < command.count; i++) {
+        minX = std::min(minX, vertices[i].position.x);
+        minY = std::min(minY, vertices[i].position.y);
+        maxX = std::max(maxX, vertices[i].position.x);
+        maxY = std::max(maxY, vertices[i].position.y);
+      }
+      bounds = boundsOf(minX, minY, maxX, maxY);
+      break;
+    }
+    case Command::Text: {
+      SDL_Surface *surface = list.surfaces[command.resource];
+      hash = hashBytes(hash, surface->pixels, (size_t)surface->pitch * surface->h);
+      bounds = command.rect;
+      break;
     }
+    }
+    list.bounds.push_back(bounds);
+    items.push_back({hash, bounds});
+  }
+
+  if (list.fullRedraw) {
+    list.damage.push_back(screen);
   } else {
-    Vec2 dir = (end - start).normalize();
-    Vec2 perp(-dir.y, dir.x);
-    Vec2 offset = perp * (lineWidth / 2.0f);
-    SDL_Point points[4] = {
-        {(int)(start.x + offset.x), (int)(start.y + offset.y)},
-        {(int)(start.x - offset.x), (int)(start.y - offset.y)},
-        {(int)(end.x - offset.x), (int)(end.y - offset.y)},
-        {(int)(end.x + offset.x), (int)(end.y + offset.y)}};
+    // Commands outside the longest matching prefix and suffix changed; both
+    // where they were last frame and where they are now need redrawing.
+    size_t common = std::min(items.size(), previousItems.size());
+    size_t prefix = 0;
+    while (prefix < common && sameItem(items[prefix].bounds, items[prefix].hash,
+                                       previousItems[prefix].bounds,
+                                       previousItems[prefix].hash))
+      prefix++;
+    size_t suffix = 0;
+    while (suffix < common - prefix) {
+      const DrawItem &a = items[items.size() - 1 - suffix];
+      const DrawItem &b = previousItems[previousItems.size() - 1 - suffix];
+      if (!sameItem(a.bounds, a.hash, b.bounds, b.hash))
+        break;
+      suffix++;
+    }
+    for (size_t i = prefix; i < items.size() - suffix; i++)
+      addDamage(list.damage, items[i].bounds, screen);
+    for (size_t i = prefix; i < previousItems.size() - suffix; i++)
+      addDamage(list.damage, previousItems[i].bounds, screen);
+    if (list.damage.size() > MaxDirtyRects) {
+      SDL_Rect merged = list.damage[0];
+      for (const SDL_Rect &rect : list.damage)
+        SDL_UnionRect(&merged, &rect, &merged);
+      list.damage.assign(1, merged);
+    }
+  }
+
+  damageAll = false;
+  std::swap(items, previousItems);
+  dirtyRectCount = list.damage.size();
+  dirtyBounds = {0, 0, 0, 0};
+  for (const SDL_Rect &rect : list.damage) {
+    if (dirtyBounds.w == 0)
+      dirtyBounds = rect;
+    else
+      SDL_UnionRect(&dirtyBounds, &rect, &dirtyBounds);
+  }
+}
+
+void Graphics::waitIdleFrame() {
+  // Nothing changed: keep the previous image on screen, and sleep out the
+  // frame so the loop does not spin whether or not presents are vsynced.
+  if (idleFrameMs > 0.0) {
+    auto next = lastPresent + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                  std::chrono::duration<double, std::milli>(idleFrameMs));
+    auto now = std::chrono::steady_clock::now();
+    if (next > now)
+      SDL_Delay((Uint32)std::chrono::duration_cast<std::chrono::milliseconds>(next - now)
+                    .count());
+  }
+  lastPresent = std::chrono::steady_clock::now();
+}
+
+void Graphics::captureFrame() {
+  if (!capture)
+    return;
+  // The frame as presented: the software framebuffer, the retained back
+  // buffer (also valid on skipped frames) or the screen itself.
+  int width = screenWidth, height = screenHeight;
+  if (!isSoftware()) {
+    if (retained && backBuffer) {
+      width = backBuffer->width;
+      height = backBuffer->height;
+    } else {
+      SDL_GetRendererOutputSize(renderer, &width, &height);
+    }
+  }
+  if (width != capture->getWidth() || height != capture->getHeight()) {
+    capture->drop();
+    return;
+  }
+  uint8_t *pixels = capture->acquire();
+  if (!pixels)
+    return;
+
+  bool ok;
+  if (isSoftware()) {
+    ok = SDL_ConvertPixels(width, height, SDL_PIXELFORMAT_ARGB8888, screenPixels.data(),
+                           width * 4, SDL_PIXELFORMAT_RGBA32, pixels, width * 4) == 0;
+  } else if (retained && backBuffer) {
+    SDL_Texture *previous = SDL_GetRenderTarget(renderer);
+    SDL_SetRenderTarget(renderer, backBuffer->texture);
+    ok = SDL_RenderReadPixels(renderer, nullptr, SDL_PIXELFORMAT_RGBA32, pixels,
+                              width * 4) == 0;
+    SDL_SetRenderTarget(renderer, previous);
+  } else {
+    ok = SDL_RenderReadPixels(renderer, nullptr, SDL_PIXELFORMAT_RGBA32, pixels,
+                              width * 4) == 0;
+  }
+  if (ok) {
+    capture->submit(pixels);
+  } else {
+    fprintf(stderr, "Warning: Error reading frame for capture: %s\n", SDL_GetError());
+    capture->release(pixels);
+    capture->drop();
+  }
+}
+
+void Graphics::executeFrame(CommandList &list) {
+  if (isSoftware()) {
+    executeSoftwareFrame(list);
+    return;
+  }
+  if (!list.retained) {
+    execute(list, nullptr);
+    captureFrame();
+    SDL_RenderPresent(renderer);
+    return;
+  }
 
-    if (SDL_RenderDrawLines(renderer, points, 5) != 0) {
-      fprintf(stderr, "Error drawing thick line: %s\n", SDL_GetError());
+  // A resized output (fullscreen toggled, window resized) gets a new back
+  // buffer, which starts out empty and so is redrawn in full.
+  if (fitBackBuffer())
+    list.fullRedraw = true;
+  if (list.damage.empty() && !list.fullRedraw) {
+    captureFrame();
+    waitIdleFrame();
+    return;
+  }
+
+  SDL_SetRenderTarget(renderer, backBuffer->texture);
+  if (list.fullRedraw) {
+    execute(list, nullptr);
+  } else {
+    for (const SDL_Rect &rect : list.damage) {
+      SDL_RenderSetClipRect(renderer, &rect);
+      execute(list, &rect);
+    }
+    SDL_RenderSetClipRect(renderer, nullptr);
+  }
+  SDL_SetRenderTarget(renderer, nullptr);
+  if (SDL_RenderCopy(renderer, backBuffer->texture, nullptr, nullptr) != 0) {
+    fprintf(stderr, "Error copying back buffer: %s\n", SDL_GetError());
+    exit(1);
+  }
+  captureFrame();
+  SDL_RenderPresent(renderer);
+  lastPresent = std::chrono::steady_clock::now();
+}
+
+void Graphics::execute(CommandList &list, const SDL_Rect *clip) {
+  // Draw color is only pushed to SDL when it changes between commands.
+  bool colorSet = false;
+  Color drawColor;
+  auto useColor = [&](const Color &color) {
+    if (colorSet && color.r == drawColor.r && color.g == drawColor.g &&
+        color.b == drawColor.b && color.a == drawColor.a)
+      return;
+    if (SDL_SetRenderDrawColor(renderer, color.r, color.g, color.b, color.a) != 0) {
+      fprintf(stderr, "Error setting render draw color: %s\n", SDL_GetError());
       exit(1);
     }
+    drawColor = color;
+    colorSet = true;
+  };
+
+  // In retained mode the screen is the back buffer.
+  SDL_Texture *screen = list.retained ? backBuffer->texture : nullptr;
+  for (size_t index = 0; index < list.commands.size(); index++) {
+    const Command &command = list.commands[index];
+    if (clip && !SDL_HasIntersection(&list.bounds[index], clip))
+      continue;
+    const SDL_Point *points = list.points.data() + command.first;
+    Texture *texture =
+        command.resource >= 0 && command.type != Command::Text
+            ? list.textures[command.resource].get()
+            : nullptr;
+    switch (command.type) {
+    case Command::Clear:
+      useColor(command.color);
+      // SDL_RenderClear ignores the clip rectangle, so clear by filling it.
+      if ((clip ? SDL_RenderFillRect(renderer, clip) : SDL_RenderClear(renderer)) != 0) {
+        fprintf(stderr, "Error clearing renderer: %s\n", SDL_GetError());
+        exit(1);
+      }
+      break;
+    case Command::Target:
+      if (SDL_SetRenderTarget(renderer, texture ? texture->texture : screen) != 0)
+        fprintf(stderr, "Warning: Error setting render target: %s\n", SDL_GetError());
+      break;
+    case Command::Points:
+      useColor(command.color);
+      if (SDL_RenderDrawPoints(renderer, points, (int)command.count) != 0) {
+        fprintf(stderr, "Error drawing points: %s\n", SDL_GetError());
+        exit(1);
+      }
+      break;
+    case Command::Lines:
+      useColor(command.color);
+      if (SDL_RenderDrawLines(renderer, points, (int)command.count) != 0) {
+        fprintf(stderr, "Error drawing lines: %s\n", SDL_GetError());
+        exit(1);
+      }
+      break;
+    case Command::Segments:
+      useColor(command.color);
+      for (uint32_t i = 0; i + 1 < command.count; i += 2) {
+        if (SDL_RenderDrawLine(renderer, points[i].x, points[i].y, points[i + 1].x,
+                               points[i + 1].y) != 0) {
+          fprintf(stderr, "Error drawing line: %s\n", SDL_GetError());
+          exit(1);
+        }
+      }
+      break;
+    case Command::Rect:
+      useColor(command.color);
+      if (SDL_RenderDrawRect(renderer, &command.rect) != 0) {
+        fprintf(stderr, "Error drawing rectangle: %s\n", SDL_GetError());
+        exit(1);
+      }
+      break;
+    case Command::FillRect:
+      useColor(command.color);
+      if (SDL_RenderFillRect(renderer, &command.rect) != 0) {
+        fprintf(stderr, "Error filling rectangle: %s\n", SDL_GetError());
+        exit(1);
+      }
+      break;
+    case Command::Copy:
+      applyTextureMod(*texture, command.color);
+      if (command.angle == 0.0) {
+        if (SDL_RenderCopy(renderer, texture->texture, nullptr, &command.rect) != 0) {
+          fprintf(stderr, "Error rendering texture: %s\n", SDL_GetError());
+          exit(1);
+        }
+      } else if (SDL_RenderCopyEx(renderer, texture->texture, nullptr, &command.rect,
+                                  command.angle, &command.center, SDL_FLIP_NONE) != 0) {
+        fprintf(stderr, "Error rendering texture with rotation: %s\n", SDL_GetError());
+        exit(1);
+      }
+      break;
+    case Command::Geometry:
+      applyTextureMod(*texture, Color(255, 255, 255, 255));
+      if (SDL_RenderGeometry(renderer, texture->texture,
+                             list.vertices.data() + command.first, (int)command.count,
+                             list.indices.data() + command.indexFirst,
+                             (int)command.indexCount) != 0) {
+        fprintf(stderr, "Error rendering sprite batch: %s\n", SDL_GetError());
+        exit(1);
+      }
+      break;
+    case Command::Text: {
+      SDL_Texture *text =
+          SDL_CreateTextureFromSurface(renderer, list.surfaces[command.resource]);
+      if (!text) {
+        fprintf(stderr, "Warning: Error creating texture from surface: %s\n",
+                SDL_GetError());
+        break;
+      }
+      if (SDL_RenderCopy(renderer, text, nullptr, &command.rect) != 0) {
+        fprintf(stderr, "Error copying text texture to renderer: %s\n", SDL_GetError());
+        SDL_DestroyTexture(text);
+        exit(1);
+      }
+      SDL_DestroyTexture(text);
+      break;
+    }
+    }
   }
 }
 
-void Graphics::drawRect(const Vec2 &pos, const Vec2 &size, bool filled) {
-  SDL_Rect rect = {(int)pos.x, (int)pos.y, (int)size.x, (int)size.y};
-  if (filled) {
-    if (SDL_RenderFillRect(renderer, &rect) != 0) {
-      fprintf(stderr, "Error filling rectangle: %s\n", SDL_GetError());
+void Graphics::executeSoftwareFrame(CommandList &list) {
+  int width = 0, height = 0;
+  SDL_GetRendererOutputSize(renderer, &width, &height);
+  bool resized = !screenTexture || width != screenWidth || height != screenHeight;
+  if (list.retained && list.damage.empty() && !resized) {
+    captureFrame();
+    waitIdleFrame();
+    return;
+  }
+
+  if (resized) {
+    if (screenTexture)
+      SDL_DestroyTexture(screenTexture);
+    screenTexture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888,
+                                      SDL_TEXTUREACCESS_STREAMING, width, height);
+    if (!screenTexture) {
+      fprintf(stderr, "Error creating software frame texture: %s\n", SDL_GetError());
       exit(1);
     }
+    screenWidth = width;
+    screenHeight = height;
+    outputWidth = width;
+    outputHeight = height;
+    screenPixels.assign((size_t)width * height, 0);
+    list.fullRedraw = true;
+  }
+
+  // Workers must not touch SDL objects: text surfaces become ARGB8888 and
+  // texture blend modes are read here, before any tile runs.
+  for (SDL_Surface *&surface : list.surfaces) {
+    if (surface->format->format == SDL_PIXELFORMAT_ARGB8888)
+      continue;
+    SDL_Surface *converted = SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_ARGB8888, 0);
+    if (!converted) {
+      fprintf(stderr, "Warning: Error converting text surface: %s\n", SDL_GetError());
+      continue;
+    }
+    SDL_FreeSurface(surface);
+    surface = converted;
+  }
+  std::vector<Rasterizer::Blend> blends(list.textures.size(), Rasterizer::Blend::Alpha);
+  for (size_t i = 0; i < list.textures.size(); i++) {
+    SDL_BlendMode mode;
+    if (list.textures[i]->texture &&
+        SDL_GetTextureBlendMode(list.textures[i]->texture, &mode) == 0)
+      blends[i] = Rasterizer::blendOf(mode);
+  }
+
+  // Target commands split the list into runs that draw into one buffer.
+  // Each run is cut into horizontal bands rasterized in parallel; within a
+  // band commands keep their order, so the result matches a serial replay.
+  constexpr int BandHeight = 32;
+  const Rasterizer::Buffer screen = {screenPixels.data(), width, height, width};
+  bool partial = list.retained && !list.fullRedraw;
+  size_t begin = 0;
+  Rasterizer::Buffer target = screen;
+  while (begin < list.commands.size()) {
+    size_t end = begin;
+    while (end < list.commands.size() && list.commands[end].type != Command::Target)
+      end++;
+    if (end > begin && target.width > 0 && target.height > 0) {
+      int bands = (target.height + BandHeight - 1) / BandHeight;
+      rasterPool->parallelFor(bands, [&](int band) {
+        SDL_Rect clip = {0, band * BandHeight, target.width,
+                         std::min(BandHeight, target.height - band * BandHeight)};
+        if (!partial || target.pixels != screen.pixels) {
+          rasterize(list, begin, end, target, blends, clip);
+          return;
+        }
+        for (const SDL_Rect &rect : list.damage) {
+          SDL_Rect area;
+          if (SDL_IntersectRect(&clip, &rect, &area))
+            rasterize(list, begin, end, target, blends, area);
+        }
+      });
+    }
+    if (end < list.commands.size()) {
+      const Command &command = list.commands[end];
+      Texture *canvas =
+          command.resource >= 0 ? list.textures[command.resource].get() : nullptr;
+      target = canvas ? Rasterizer::Buffer{canvas->pixels.data(), canvas->width,
+                                           canvas->height, canvas->width}
+                      : screen;
+      end++;
+    }
+    begin = end;
+  }
+
+  if (partial) {
+    for (const SDL_Rect &rect : list.damage) {
+      SDL_UpdateTexture(screenTexture, &rect,
+                        screenPixels.data() + (size_t)rect.y * width + rect.x, width * 4);
+    }
   } else {
-    if (SDL_RenderDrawRect(renderer, &rect) != 0) {
-      fprintf(stderr, "Error drawing rectangle: %s\n", SDL_GetError());
-      exit(1);
+    SDL_UpdateTexture(screenTexture, nullptr, screenPixels.data(), width * 4);
+  }
+  if (SDL_RenderCopy(renderer, screenTexture, nullptr, nullptr) != 0) {
+    fprintf(stderr, "Error copying software frame: %s\n", SDL_GetError());
+    exit(1);
+  }
+  captureFrame();
+  SDL_RenderPresent(renderer);
+  lastPresent = std::chrono::steady_clock::now();
+}
+
+void Graphics::rasterize(CommandList &list, size_t begin, size_t end,
+                         const Rasterizer::Buffer &target,
+                         const std::vector<Rasterizer::Blend> &blends,
+                         const SDL_Rect &clip) {
+  for (size_t index = begin; index < end; index++) {
+    const Command &command = list.commands[index];
+    if (list.retained && !SDL_HasIntersection(&list.bounds[index], &clip))
+      continue;
+    const SDL_Point *points = list.points.data() + command.first;
+    uint32_t color = Rasterizer::pack(command.color.r, command.color.g, command.color.b,
+                                      command.color.a);
+    switch (command.type) {
+    case Command::Clear:
+      Rasterizer::fillRect(target, clip, color, clip);
+      break;
+    case Command::Target:
+      break;
+    case Command::Points:
+      Rasterizer::drawPoints(target, points, command.count, color, clip);
+      break;
+    case Command::Lines:
+      for (uint32_t i = 0; i + 1 < command.count; i++)
+        Rasterizer::drawLine(target, points[i], points[i + 1], color, clip);
+      break;
+    case Command::Segments:
+      for (uint32_t i = 0; i + 1 < command.count; i += 2)
+        Rasterizer::drawLine(target, points[i], points[i + 1], color, clip);
+      break;
+    case Command::Rect:
+      Rasterizer::drawRect(target, command.rect, color, clip);
+      break;
+    case Command::FillRect:
+      Rasterizer::fillRect(target, command.rect, color, clip);
+      break;
+    case Command::Copy:
+    case Command::Geometry: {
+      const Texture &texture = *list.textures[command.resource];
+      if (texture.pixels.empty() || texture.pixels.data() == target.pixels)
+        break;
+      Rasterizer::Buffer source = {const_cast<uint32_t *>(texture.pixels.data()),
+                                   texture.width, texture.height, texture.width};
+      if (command.type == Command::Copy)
+        Rasterizer::copy(target, source, command.rect, command.angle, command.center, color,
+                         blends[command.resource], clip);
+      else
+        Rasterizer::geometry(target, source, list.vertices.data() + command.first,
+                             list.indices.data() + command.indexFirst, command.indexCount,
+                             blends[command.resource], clip);
+      break;
+    }
+    case Command::Text: {
+      SDL_Surface *surface = list.surfaces[command.resource];
+      if (surface->format->format != SDL_PIXELFORMAT_ARGB8888)
+        break;
+      // TTF output has a color key or alpha, so SDL would blend it.
+      Rasterizer::Buffer source = {(uint32_t *)surface->pixels, surface->w, surface->h,
+                                   surface->pitch / 4};
+      Rasterizer::copy(target, source, command.rect, 0.0, {0, 0}, 0xffffffffu,
+                       Rasterizer::Blend::Alpha, clip);
+      break;
+    }
     }
   }
 }
 
-void Graphics::drawCircle(const Vec2 &center, float radius, bool filled) {
-  int segments = std::max(8, (int)(radius * 0.5f));
-  std::vector<SDL_Point> points;
-  for (int i = 0; i <= segments; i++) {
-    float angle = 2.0f * M_PI * i / segments;
-    int x = (int)(center.x + radius * cos(angle));
-    int y = (int)(center.y + radius * sin(angle));
-    points.push_back({x, y});
+void Graphics::clear(const Color &color) {
+  flush();
+  record(Command::Clear).color = color;
+}
+
+void Graphics::present() {
+  flush();
+  if (currentCanvas)
+    setCanvas(nullptr);
+  lastCommandCount = recording->commands.size();
+  if (retained)
+    computeDamage(*recording);
+
+  if (!renderThread) {
+    executeFrame(*recording);
+    recording->clear();
+    return;
   }
 
+  // Wait for the previous frame, then hand this one over and return so the
+  // next frame is recorded while this one executes and presents.
+  auto start = std::chrono::steady_clock::now();
+  renderThread->wait(lastFrame);
+  presentWaitMs = std::chrono::duration<double, std::milli>(
+                      std::chrono::steady_clock::now() - start)
+                      .count();
+  std::swap(recording, executing);
+  lastFrame = renderThread->post([this] {
+    executeFrame(*executing);
+    executing->clear();
+  });
+}
+
+void Graphics::drawPoint(const Vec2 &pos) {
+  flush();
+  SDL_Point point = {(int)pos.x, (int)pos.y};
+  recordPoints(Command::Points, &point, 1);
+}
+
+void Graphics::drawLine(const Vec2 &start, const Vec2 &end) {
+  flush();
+  if (lineWidth <= 1.0f) {
+    SDL_Point points[2] = {{(int)start.x, (int)start.y}, {(int)end.x, (int)end.y}};
+    recordPoints(Command::Segments, points, 2);
+  } else {
+    Vec2 offset = (end - start).normalize().perpendicular() * (lineWidth / 2.0f);
+    SDL_Point points[5] = {
+        {(int)(start.x + offset.x), (int)(start.y + offset.y)},
+        {(int)(start.x - offset.x), (int)(start.y - offset.y)},
+        {(int)(end.x - offset.x), (int)(end.y - offset.y)},
+        {(int)(end.x + offset.x), (int)(end.y + offset.y)},
+        {(int)(start.x + offset.x), (int)(start.y + offset.y)}};
+    recordPoints(Command::Lines, points, 5);
+  }
+}
+
+void Graphics::drawRect(const Vec2 &pos, const Vec2 &size, bool filled) {
+  flush();
+  record(filled ? Command::FillRect : Command::Rect).rect = {
+      (int)pos.x, (int)pos.y, (int)size.x, (int)size.y};
+}
+
+const SDL_Point *Graphics::ellipsePoints(const Vec2 &center, const Vec2 &radii,
+                                         int segments) {
+  if ((int)unitCircle.size() != segments + 1) {
+    unitCircle.resize(segments + 1);
+    for (int i = 0; i <= segments; i++) {
+      float angle = 2.0f * M_PI * i / segments;
+      unitCircle[i] = Vec2(cos(angle), sin(angle));
+    }
+  }
+  size_t count = unitCircle.size();
+  Vec2 *shape = arena.alloc<Vec2>(count);
+  transformPoints(Mat(radii.x, 0, 0, radii.y, center.x, center.y), unitCircle.data(),
+                  shape, count);
+  SDL_Point *pixels = arena.alloc<SDL_Point>(count);
+  for (size_t i = 0; i < count; i++)
+    pixels[i] = {(int)shape[i].x, (int)shape[i].y};
+  return pixels;
+}
+
+void Graphics::drawCircle(const Vec2 &center, float radius, bool filled) {
+  flush();
   if (filled) {
+    // Every covered pixel goes out in one point batch.
+    Command &command = record(Command::Points);
+    command.first = (uint32_t)recording->points.size();
     for (int y = (int)-radius; y <= (int)radius; y++) {
       for (int x = (int)-radius; x <= (int)radius; x++) {
-        if (x * x + y * y <= radius * radius) {
-          if (SDL_RenderDrawPoint(renderer, (int)center.x + x, (int)center.y + y) != 0) {
-            fprintf(stderr, "Error drawing filled circle point: %s\n", SDL_GetError());
-            exit(1);
-          }
-        }
+        if (x * x + y * y <= radius * radius)
+          recording->points.push_back({(int)center.x + x, (int)center.y + y});
       }
     }
+    command.count = (uint32_t)(recording->points.size() - command.first);
   } else {
-    if (SDL_RenderDrawLines(renderer, points.data(), points.size()) != 0) {
-      fprintf(stderr, "Error drawing circle: %s\n", SDL_GetError());
-      exit(1);
-    }
+    int segments = std::max(8, (int)(radius * 0.5f));
+    const SDL_Point *points = ellipsePoints(center, Vec2(radius, radius), segments);
+    recordPoints(Command::Lines, points, segments + 1);
   }
 }
 
 void Graphics::drawEllipse(const Vec2 &center, const Vec2 &radii, bool filled) {
+  flush();
   int segments = std::max(16, (int)((radii.x + radii.y) * 0.25f));
-  std::vector<SDL_Point> points;
-  for (int i = 0; i <= segments; i++) {
-    float angle = 2.0f * M_PI * i / segments;
-    int x = (int)(center.x + radii.x * cos(angle));
-    int y = (int)(center.y + radii.y * sin(angle));
-    points.push_back({x, y});
-  }
+  const SDL_Point *points = ellipsePoints(center, radii, segments);
 
   if (filled) {
+    SDL_Point middle = {(int)center.x, (int)center.y};
     for (int i = 1; i < segments; i++) {
-      SDL_Point triangle[3] = {
-          {(int)center.x, (int)center.y}, points[i - 1], points[i]};
-      if (SDL_RenderDrawLines(renderer, triangle, 4) != 0) {
-        fprintf(stderr, "Error drawing filled ellipse triangle: %s\n", SDL_GetError());
-        exit(1);
-      }
+      SDL_Point triangle[4] = {middle, points[i - 1], points[i], middle};
+      recordPoints(Command::Lines, triangle, 4);
     }
   } else {
-    if (SDL_RenderDrawLines(renderer, points.data(), points.size()) != 0) {
-      fprintf(stderr, "Error drawing ellipse: %s\n", SDL_GetError());
-      exit(1);
-    }
+    recordPoints(Command::Lines, points, segments + 1);
   }
 }
 
 void Graphics::drawTexture(std::shared_ptr<Texture> texture,
                            const Transform &transform, const Color &tint) {
-  if (!texture || !texture->texture)
+  if (!texture || texture == currentCanvas)
     return;
-  if (SDL_SetTextureColorMod(texture->texture, tint.r, tint.g, tint.b) != 0) {
-    fprintf(stderr, "Error setting texture color mod: %s\n", SDL_GetError());
-    exit(1);
-  }
-  if (SDL_SetTextureAlphaMod(texture->texture, tint.a) != 0) {
-    fprintf(stderr, "Error setting texture alpha mod: %s\n", SDL_GetError());
-    exit(1);
-  }
   SDL_Rect dst = {
       (int)(transform.position.x - transform.origin.x * transform.scale.x),
       (int)(transform.position.y - transform.origin.y * transform.scale.y),
       (int)(texture->width * transform.scale.x),
       (int)(texture->height * transform.scale.y)};
+  // An evicted texture keeps its size, so the placeholder covers the same
+  // rectangle.
+  if (residency)
+    texture = residency->use(texture);
+  if (!texture || !texture->texture)
+    return;
 
-  if (transform.rotation == 0.0f) {
-    if (SDL_RenderCopy(renderer, texture->texture, nullptr, &dst) != 0) {
-      fprintf(stderr, "Error rendering texture: %s\n", SDL_GetError());
-      exit(1);
-    }
-  } else {
-    SDL_Point center = transform.getSDLOrigin();
-    if (SDL_RenderCopyEx(renderer, texture->texture, nullptr, &dst, 
-                         transform.getRotation(), &center, SDL_FLIP_NONE) != 0) {
-      fprintf(stderr, "Error rendering texture with rotation: %s\n", SDL_GetError());
-      exit(1);
+  if (deferred) {
+    SpriteDraw sprite;
+    sprite.layer = layer;
+    sprite.tint = ((uint32_t)tint.r << 24) | ((uint32_t)tint.g << 16) |
+                  ((uint32_t)tint.b << 8) | tint.a;
+    sprite.texture = texture;
+    float x0 = (float)dst.x, y0 = (float)dst.y;
+    float x1 = x0 + dst.w, y1 = y0 + dst.h;
+    Vec2 corners[4] = {{x0, y0}, {x1, y0}, {x1, y1}, {x0, y1}};
+    if (transform.rotation != 0.0f) {
+      SDL_Point center = transform.getSDLOrigin();
+      float radians = (float)(transform.getRotation() * M_PI / 180.0);
+      transformPoints(Mat::rotation(radians, Vec2(x0 + center.x, y0 + center.y)),
+                      corners, corners, 4);
     }
+    for (int i = 0; i < 4; i++)
+      sprite.corners[i] = {corners[i].x, corners[i].y};
+    sprites.push_back(std::move(sprite));
+    return;
+  }
+
+  Command &command = record(Command::Copy);
+  command.color = tint;
+  command.resource = recordTexture(std::move(texture));
+  command.rect = dst;
+  if (transform.rotation != 0.0f) {
+    command.angle = transform.getRotation();
+    command.center = transform.getSDLOrigin();
   }
 }
 
 void Graphics::drawText(const std::string &text, const Vec2 &pos,
                         const Color &color) {
+  flush();
   if (!currentFont || !currentFont->font)
     return;
   SDL_Color sdlColor = {color.r, color.g, color.b, color.a};
@@ -179,67 +1029,53 @@ void Graphics::drawText(const std::string &text, const Vec2 &pos,
     fprintf(stderr, "Warning: Error rendering text to surface: %s\n", SDL_GetError());
     return;
   }
-  SDL_Texture *texture = SDL_CreateTextureFromSurface(renderer, surface);
-  if (!texture) {
-    fprintf(stderr, "Warning: Error creating texture from surface: %s\n", SDL_GetError());
-    SDL_FreeSurface(surface);
-    return;
-  }
-  SDL_Rect dst = {(int)pos.x, (int)pos.y, surface->w, surface->h};
-  if (SDL_RenderCopy(renderer, texture, nullptr, &dst) != 0) {
-    fprintf(stderr, "Error copying text texture to renderer: %s\n", SDL_GetError());
-    SDL_DestroyTexture(texture);
-    SDL_FreeSurface(surface);
-    exit(1);
-  }
-  SDL_DestroyTexture(texture);
-  SDL_FreeSurface(surface);
+  // The surface is uploaded when the frame executes and freed with the list.
+  recording->surfaces.push_back(surface);
+  Command &command = record(Command::Text);
+  command.resource = (int)recording->surfaces.size() - 1;
+  command.rect = {(int)pos.x, (int)pos.y, surface->w, surface->h};
 }
 
-void Graphics::drawPolygon(const std::vector<Vec2> &vertices, bool filled) {
-  if (vertices.size() < 3)
+void Graphics::drawPolygon(const Vec2 *vertices, size_t count, bool filled) {
+  if (count < 3)
     return;
+  flush();
   if (filled) {
-    float minY = vertices[0].y;
-    float maxY = vertices[0].y;
-    for (const auto &v : vertices) {
-      if (v.y < minY)
-        minY = v.y;
-      if (v.y > maxY)
-        maxY = v.y;
-    }
-
-    for (int y = (int)minY; y <= (int)maxY; y++) {
-      std::vector<float> intersections;
-      for (size_t i = 0; i < vertices.size(); i++) {
+    Rect bounds = computeBounds(vertices, count);
+    // Each edge crosses a scanline at most once.
+    float *intersections = arena.alloc<float>(count);
+    Command &command = record(Command::Segments);
+    command.first = (uint32_t)recording->points.size();
+    for (int y = (int)bounds.y; y <= (int)(bounds.y + bounds.h); y++) {
+      size_t crossings = 0;
+      for (size_t i = 0; i < count; i++) {
         const Vec2 &p1 = vertices[i];
-        const Vec2 &p2 = vertices[(i + 1) % vertices.size()];
+        const Vec2 &p2 = vertices[(i + 1) % count];
         if ((p1.y <= y && p2.y > y) || (p2.y <= y && p1.y > y)) {
           if (p1.y == p2.y)
             continue;
           float intersectX = p1.x + (y - p1.y) * (p2.x - p1.x) / (p2.y - p1.y);
-          intersections.push_back(intersectX);
+          intersections[crossings++] = intersectX;
         }
       }
-      std::sort(intersections.begin(), intersections.end());
-      for (size_t i = 0; i + 1 < intersections.size(); i += 2) {
-        if (SDL_RenderDrawLine(renderer, (int)intersections[i], y, 
-                               (int)intersections[i + 1], y) != 0) {
-          fprintf(stderr, "Error drawing filled polygon line: %s\n", SDL_GetError());
-          exit(1);
-        }
+      std::sort(intersections, intersections + crossings);
+      for (size_t i = 0; i + 1 < crossings; i += 2) {
+        recording->points.push_back({(int)intersections[i], y});
+        recording->points.push_back({(int)intersections[i + 1], y});
       }
     }
+    command.count = (uint32_t)(recording->points.size() - command.first);
   } else {
-    std::vector<SDL_Point> points;
-    for (const auto &v : vertices) {
-      points.push_back({(int)v.x, (int)v.y});
-    }
-    points.push_back(points[0]);
-    if (SDL_RenderDrawLines(renderer, points.data(), points.size()) != 0) {
-      fprintf(stderr, "Error drawing polygon: %s\n", SDL_GetError());
-      exit(1);
-    }
+    Command &command = record(Command::Lines);
+    command.first = (uint32_t)recording->points.size();
+    for (size_t i = 0; i < count; i++)
+      recording->points.push_back({(int)vertices[i].x, (int)vertices[i].y});
+    recording->points.push_back({(int)vertices[0].x, (int)vertices[0].y});
+    command.count = (uint32_t)count + 1;
   }
 }
 
+
+Camera &Graphics::getCamera() { return camera; }
+
+void Graphics::setCamera(const Camera &cam) { camera = cam; }
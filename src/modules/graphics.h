@@ -1,32 +1,228 @@
 #ifndef TENSAI_GRAPHICS_H
 #define TENSAI_GRAPHICS_H
 
+#include "../core/batch.h"
 #include "../core/color.h"
+#include "../core/frame_arena.h"
+#include "../core/thread_pool.h"
 #include "../core/transform.h"
 #include "../core/vec2.h"
 #include "../resources/font.h"
 #include "../resources/texture.h"
 #include "camera.h"
+#include "capture.h"
+#include "rasterizer.h"
+#include "render_thread.h"
 #include <SDL2/SDL.h>
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
 #include <memory>
 #include <vector>
 
+class TextureResidency;
+
 class Graphics {
+public:
+  // SDL hands drawing to the SDL renderer's own backend. Software draws
+  // every frame on the CPU with tiles split across a thread pool, and
+  // uploads the result as one streaming texture.
+  enum class Backend { SDL, Software };
+
 private:
+  struct SpriteDraw {
+    int layer;
+    uint32_t tint;
+    std::shared_ptr<Texture> texture;
+    SDL_FPoint corners[4];
+  };
+
+  // One recorded renderer call. Point, vertex and index data live in the
+  // owning CommandList, addressed by [first, first + count).
+  struct Command {
+    enum Type : uint8_t {
+      Clear,
+      Target,
+      Points,
+      Lines,
+      Segments,
+      Rect,
+      FillRect,
+      Copy,
+      Geometry,
+      Text
+    } type;
+    Color color;
+    int resource = -1; // texture index, or surface index for Text
+    SDL_Rect rect{0, 0, 0, 0};
+    double angle = 0.0;
+    SDL_Point center{0, 0};
+    uint32_t first = 0, count = 0;
+    uint32_t indexFirst = 0, indexCount = 0;
+  };
+
+  struct CommandList {
+    std::vector<Command> commands;
+    std::vector<SDL_Point> points;
+    std::vector<SDL_Vertex> vertices;
+    std::vector<int> indices;
+    // Holding references keeps textures alive until the list has executed.
+    std::vector<std::shared_ptr<Texture>> textures;
+    std::vector<SDL_Surface *> surfaces;
+    // Retained mode only: screen bounds per command and the regions of the
+    // back buffer to redraw. fullRedraw replays everything unclipped.
+    std::vector<SDL_Rect> bounds;
+    std::vector<SDL_Rect> damage;
+    bool retained = false;
+    bool fullRedraw = false;
+
+    void clear();
+    ~CommandList() { clear(); }
+  };
+
   SDL_Renderer *renderer;
+  Backend backend;
+  // Canvases and the retained back buffer are render targets, which some
+  // drivers lack; both are refused rather than failing renderer creation.
+  bool renderTargets = false;
+  // Draw calls record into `recording`. present() executes it in place, or
+  // with a render thread swaps it with `executing` and replays it there while
+  // the caller records the next frame.
+  std::unique_ptr<CommandList> recording = std::make_unique<CommandList>();
+  std::unique_ptr<CommandList> executing = std::make_unique<CommandList>();
+  std::unique_ptr<RenderThread> renderThread;
+  uint64_t lastFrame = 0;
+  size_t lastCommandCount = 0;
+  double presentWaitMs = 0.0;
+
+  struct DrawItem {
+    uint64_t hash;
+    SDL_Rect bounds;
+  };
+  static constexpr size_t MaxDirtyRects = 8;
+  bool retained = false;
+  bool damageAll = false;
+  std::shared_ptr<Texture> backBuffer;
+  // Output size the back buffer was made for. The renderer's thread writes it
+  // when the output is resized; computeDamage reads it to clip.
+  std::atomic<int> outputWidth{0}, outputHeight{0};
+  // Frames per second a retained frame with nothing to present is held to;
+  // 0 follows the display. idleFrameMs is derived on the renderer's thread.
+  double idleFrameRate = 0.0;
+  double idleFrameMs = 0.0;
+  std::chrono::steady_clock::time_point lastPresent;
+  std::vector<DrawItem> items;
+  std::vector<DrawItem> previousItems;
+  SDL_Rect dirtyBounds{0, 0, 0, 0};
+  size_t dirtyRectCount = 0;
+  // Software backend: the frame in ARGB8888 and the texture it is shown
+  // through. Pixels persist between frames, so retained mode needs no
+  // separate back buffer.
+  std::unique_ptr<ThreadPool> rasterPool;
+  std::vector<uint32_t> screenPixels;
+  SDL_Texture *screenTexture = nullptr;
+  int screenWidth = 0, screenHeight = 0;
+  // Only touched on the renderer's thread.
+  std::shared_ptr<Capture> capture;
   Camera camera;
   Color currentColor{255, 255, 255, 255};
   std::shared_ptr<Font> currentFont;
+  std::shared_ptr<Texture> currentCanvas;
+  TextureResidency *residency = nullptr;
   float lineWidth = 1.0f;
+  bool deferred = false;
+  int layer = 0;
+  std::vector<SpriteDraw> sprites;
+  std::vector<SDL_Vertex> batchVertices;
+  std::vector<int> batchIndices;
+  // Unit circle for the current segment count, scaled and translated for
+  // each circle or ellipse instead of re-evaluating sin/cos.
+  std::vector<Vec2> unitCircle;
+  // Scratch for shape outlines and scanlines, reclaimed once per frame.
+  FrameArena arena;
+
+  Command &record(Command::Type type);
+  int recordTexture(std::shared_ptr<Texture> texture);
+  void recordPoints(Command::Type type, const SDL_Point *points, size_t count);
+  void computeDamage(CommandList &list);
+  void updateIdleFrame();
+  bool fitBackBuffer();
+  void waitIdleFrame();
+  void captureFrame();
+  void executeFrame(CommandList &list);
+  void execute(CommandList &list, const SDL_Rect *clip);
+  void executeSoftwareFrame(CommandList &list);
+  void rasterize(CommandList &list, size_t begin, size_t end,
+                 const Rasterizer::Buffer &target,
+                 const std::vector<Rasterizer::Blend> &blends, const SDL_Rect &clip);
+  void applyTextureMod(Texture &texture, const Color &tint);
+  // segments + 1 points, the last repeating the first, in the frame arena.
+  const SDL_Point *ellipsePoints(const Vec2 &center, const Vec2 &radii, int segments);
+  void flushSprites();
 
 public:
-  Graphics(SDL_Renderer *r);
+  // rasterThreads sizes the software backend's pool; 0 picks the core count.
+  Graphics(SDL_Renderer *r, Backend backend = Backend::SDL, int rasterThreads = 0);
+  ~Graphics();
+
+  Backend getBackend() const { return backend; }
+  bool isSoftware() const { return backend == Backend::Software; }
+
+  // Moves renderer execution to a dedicated thread (or back). While it runs,
+  // every other renderer call must go through runOnRenderer.
+  void setThreaded(bool enabled);
+  bool isThreaded() const { return renderThread != nullptr; }
+  void runOnRenderer(const std::function<void()> &job);
+  // Defers dropping a texture reference until the frames using it have
+  // executed, so the last release happens on the renderer's thread.
+  void retire(std::shared_ptr<Texture> texture);
+  size_t getCommandCount() const { return lastCommandCount; }
+
+  // Retained mode draws into a persistent back buffer and redraws only the
+  // regions where this frame's commands differ from the previous frame's.
+  // Frames with no differences skip presenting altogether.
+  void setRetained(bool enabled);
+  bool isRetained() const { return retained; }
+  // Makes the next retained frame redraw everything, for changes the
+  // command stream cannot see such as updated texture pixels.
+  void invalidate() { damageAll = true; }
+  // Caps how often retained frames with nothing to present come around,
+  // with or without vsync. 0 uses the display's refresh rate.
+  void setIdleFrameRate(double fps);
+  // Union of the last frame's redrawn regions, and how many there were.
+  SDL_Rect getDirtyBounds() const { return dirtyBounds; }
+  size_t getDirtyRectCount() const { return dirtyRectCount; }
+  double getPresentWaitMs() const { return presentWaitMs; }
+
+  // Per-frame scratch memory for draw paths. The run loop resets it after
+  // each present; nothing allocated from it may outlive the frame.
+  FrameArena &getArena() { return arena; }
+
+  // Copies every following frame, including ones retained mode skips, into
+  // `capture` just before it is presented. nullptr stops.
+  void setCapture(std::shared_ptr<Capture> capture);
 
   void setColor(const Color &color);
   void setFont(std::shared_ptr<Font> font);
   void setLineWidth(float width);
 
+  std::shared_ptr<Texture> createCanvas(int width, int height);
+  void setCanvas(std::shared_ptr<Texture> canvas);
+  std::shared_ptr<Texture> getCanvas() const;
+
+  // Routes every texture draw through `residency`, which stamps its use and
+  // swaps evicted textures for a placeholder. Not owned; nullptr detaches.
+  void setResidency(TextureResidency *manager) { residency = manager; }
+
+  // In deferred mode textured draws are queued and submitted at the next
+  // non-sprite draw, canvas switch or present. Queued draws are ordered by
+  // layer, then grouped by texture and tint, so draws sharing a layer may be
+  // reordered relative to each other.
+  void setDeferred(bool enabled);
+  void setLayer(int layer);
+  void flush();
+
   void clear(const Color &color = Color(0, 0, 0, 255));
   void present();
 
@@ -39,7 +235,7 @@ public:
                    const Color &tint = Color(255, 255, 255, 255));
   void drawText(const std::string &text, const Vec2 &pos,
                 const Color &color = Color(255, 255, 255, 255));
-  void drawPolygon(const std::vector<Vec2> &vertices, bool filled = false);
+  void drawPolygon(const Vec2 *vertices, size_t count, bool filled = false);
 
   Camera &getCamera();
   void setCamera(const Camera &cam);
@@ -0,0 +1,159 @@
+#include "input_log.h"
+#include <cstring>
+
+namespace {
+
+constexpr size_t HeaderSize = 32;
+
+uint64_t zigzag(int32_t value) {
+  return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
+
+int32_t unzigzag(uint64_t value) {
+  return (int32_t)((uint32_t)(value >> 1) ^ (0u - (uint32_t)(value & 1)));
+}
+
+bool readVarint(const std::vector<uint8_t> &data, size_t &pos, uint64_t &value) {
+  value = 0;
+  for (int shift = 0; shift < 64 && pos < data.size(); shift += 7) {
+    uint8_t byte = data[pos++];
+    value |= (uint64_t)(byte & 0x7f) << shift;
+    if (!(byte & 0x80))
+      return true;
+  }
+  return false;
+}
+
+} // namespace
+
+InputLogWriter::InputLogWriter(const std::string &path, uint64_t seed, double timestep)
+    : timestep(timestep) {
+  file = fopen(path.c_str(), "wb");
+  if (!file) {
+    fprintf(stderr, "Warning: Error creating input recording: %s\n", path.c_str());
+    return;
+  }
+  uint8_t header[HeaderSize] = {};
+  memcpy(header, "TREC", 4);
+  uint32_t version = Version;
+  memcpy(header + 4, &version, 4);
+  memcpy(header + 8, &seed, 8);
+  memcpy(header + 16, &timestep, 8);
+  failed = fwrite(header, sizeof(header), 1, file) != 1;
+}
+
+InputLogWriter::~InputLogWriter() { close(); }
+
+void InputLogWriter::writeVarint(uint64_t value) {
+  while (value >= 0x80) {
+    fputc((int)(value & 0x7f) | 0x80, file);
+    value >>= 7;
+  }
+  fputc((int)value, file);
+}
+
+void InputLogWriter::write(const InputEvent &event) {
+  if (!file)
+    return;
+  fputc(event.type, file);
+  writeVarint(event.frame - lastFrame);
+  lastFrame = event.frame;
+  switch (event.type) {
+  case InputEvent::KeyDown:
+  case InputEvent::KeyUp:
+  case InputEvent::MouseDown:
+  case InputEvent::MouseUp:
+    writeVarint(zigzag(event.x));
+    break;
+  case InputEvent::MouseMove:
+  case InputEvent::Wheel:
+    writeVarint(zigzag(event.x));
+    writeVarint(zigzag(event.y));
+    break;
+  case InputEvent::Delta:
+    failed |= fwrite(&event.delta, sizeof(event.delta), 1, file) != 1;
+    break;
+  case InputEvent::Quit:
+    break;
+  }
+}
+
+bool InputLogWriter::close() {
+  if (!file)
+    return !failed;
+  failed |= ferror(file) != 0;
+  failed |= fclose(file) != 0;
+  file = nullptr;
+  return !failed;
+}
+
+InputLogReader::InputLogReader(const std::string &path) {
+  FILE *file = fopen(path.c_str(), "rb");
+  if (!file)
+    return;
+  std::vector<uint8_t> data;
+  uint8_t chunk[4096];
+  size_t read;
+  while ((read = fread(chunk, 1, sizeof(chunk), file)) > 0)
+    data.insert(data.end(), chunk, chunk + read);
+  fclose(file);
+
+  uint32_t version = 0;
+  if (data.size() < HeaderSize || memcmp(data.data(), "TREC", 4) != 0)
+    return;
+  memcpy(&version, data.data() + 4, 4);
+  if (version != InputLogWriter::Version)
+    return;
+  memcpy(&seed, data.data() + 8, 8);
+  memcpy(&timestep, data.data() + 16, 8);
+
+  // A recording cut short by a crash replays up to its last whole event.
+  open = true;
+  size_t pos = HeaderSize;
+  uint32_t frame = 0;
+  while (pos < data.size()) {
+    InputEvent event;
+    event.type = (InputEvent::Type)data[pos++];
+    uint64_t frames, x = 0, y = 0;
+    if (!readVarint(data, pos, frames))
+      break;
+    frame += (uint32_t)frames;
+    event.frame = frame;
+    bool ok = true;
+    switch (event.type) {
+    case InputEvent::KeyDown:
+    case InputEvent::KeyUp:
+    case InputEvent::MouseDown:
+    case InputEvent::MouseUp:
+      ok = readVarint(data, pos, x);
+      break;
+    case InputEvent::MouseMove:
+    case InputEvent::Wheel:
+      ok = readVarint(data, pos, x) && readVarint(data, pos, y);
+      break;
+    case InputEvent::Delta:
+      ok = pos + sizeof(float) <= data.size();
+      if (ok) {
+        memcpy(&event.delta, data.data() + pos, sizeof(float));
+        pos += sizeof(float);
+      }
+      break;
+    case InputEvent::Quit:
+      break;
+    default:
+      ok = false;
+    }
+    if (!ok)
+      break;
+    event.x = unzigzag(x);
+    event.y = unzigzag(y);
+    events.push_back(event);
+  }
+}
+
+bool InputLogReader::next(uint32_t frame, InputEvent &event) {
+  if (cursor >= events.size() || events[cursor].frame > frame)
+    return false;
+  event = events[cursor++];
+  return true;
+}
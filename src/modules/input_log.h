@@ -0,0 +1,72 @@
+#ifndef TENSAI_INPUT_LOG_H
+#define TENSAI_INPUT_LOG_H
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Recorded input for deterministic replays (.trec).
+//
+// Layout (little-endian):
+//   header  "TREC" u32 version, u64 seed, f64 timestep, 8 reserved bytes
+//   events  u8 type, varint frames since the previous event, then
+//           KeyDown/KeyUp/MouseDown/MouseUp: zigzag varint code
+//           MouseMove/Wheel: zigzag varint x, y
+//           Delta: f32 seconds (only when timestep is 0)
+//           Quit: nothing
+//
+// A timestep of 0 means the session ran on the real clock, so every frame
+// carries a Delta event with its measured frame time.
+struct InputEvent {
+  enum Type : uint8_t { KeyDown = 1, KeyUp, MouseDown, MouseUp, MouseMove, Wheel, Delta, Quit };
+
+  uint32_t frame = 0;
+  Type type = Quit;
+  int32_t x = 0, y = 0; // key or button code in x
+  float delta = 0.0f;
+};
+
+class InputLogWriter {
+public:
+  static constexpr uint32_t Version = 1;
+
+  InputLogWriter(const std::string &path, uint64_t seed, double timestep);
+  ~InputLogWriter();
+
+  bool isOpen() const { return file != nullptr; }
+  double getTimestep() const { return timestep; }
+  void write(const InputEvent &event);
+  // Returns false if anything failed to write.
+  bool close();
+
+private:
+  FILE *file = nullptr;
+  double timestep;
+  uint32_t lastFrame = 0;
+  bool failed = false;
+
+  void writeVarint(uint64_t value);
+};
+
+class InputLogReader {
+public:
+  explicit InputLogReader(const std::string &path);
+
+  bool isOpen() const { return open; }
+  uint64_t getSeed() const { return seed; }
+  double getTimestep() const { return timestep; }
+  bool finished() const { return cursor >= events.size(); }
+
+  // Pops the next event recorded for `frame`, in recorded order.
+  bool next(uint32_t frame, InputEvent &event);
+
+private:
+  bool open = false;
+  uint64_t seed = 0;
+  double timestep = 0.0;
+  std::vector<InputEvent> events;
+  size_t cursor = 0;
+};
+
+#endif // TENSAI_INPUT_LOG_H
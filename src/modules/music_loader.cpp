@@ -0,0 +1,55 @@
+#include "music_loader.h"
+
+MusicLoader::MusicLoader(const Assets &assets) : assets(assets) {
+  worker = std::thread(&MusicLoader::run, this);
+}
+
+MusicLoader::~MusicLoader() { stop(); }
+
+void MusicLoader::request(const std::string &path) {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!inFlight.insert(path).second)
+      return;
+    queue.push_back(path);
+  }
+  wake.notify_one();
+}
+
+void MusicLoader::stop() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  wake.notify_one();
+  if (worker.joinable())
+    worker.join();
+}
+
+std::vector<std::pair<std::string, std::shared_ptr<Music>>>
+MusicLoader::takeLoaded() {
+  std::lock_guard<std::mutex> lock(mutex);
+  std::vector<std::pair<std::string, std::shared_ptr<Music>>> result;
+  result.swap(loaded);
+  for (const auto &entry : result)
+    inFlight.erase(entry.first);
+  return result;
+}
+
+void MusicLoader::run() {
+  std::unique_lock<std::mutex> lock(mutex);
+  while (true) {
+    wake.wait(lock, [this] { return stopping || !queue.empty(); });
+    if (stopping)
+      return;
+    std::string path = queue.front();
+    queue.pop_front();
+
+    lock.unlock();
+    auto music = std::make_shared<Music>(assets.open(path));
+    if (!music->music)
+      music = nullptr;
+    lock.lock();
+    loaded.emplace_back(path, music);
+  }
+}
@@ -0,0 +1,45 @@
+#ifndef TENSAI_MUSIC_LOADER_H
+#define TENSAI_MUSIC_LOADER_H
+
+#include "../resources/music.h"
+#include "assets.h"
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+// Opens music streams on a background thread so the file open and decoder
+// setup of Mix_LoadMUS never run on the frame thread. Mix_Music decodes
+// incrementally while playing, so a loaded track is not held in memory.
+class MusicLoader {
+private:
+  const Assets &assets;
+  std::mutex mutex;
+  std::condition_variable wake;
+  std::deque<std::string> queue;
+  // Requested and not yet taken, so repeated requests load once.
+  std::unordered_set<std::string> inFlight;
+  std::vector<std::pair<std::string, std::shared_ptr<Music>>> loaded;
+  bool stopping = false;
+  // Started in the constructor body, once the state run() uses exists.
+  std::thread worker;
+
+  void run();
+
+public:
+  explicit MusicLoader(const Assets &assets);
+  ~MusicLoader();
+
+  // Ignored while the same path is already loading.
+  void request(const std::string &path);
+  void stop();
+  // Tracks finished since the last call; failed loads carry a null pointer.
+  std::vector<std::pair<std::string, std::shared_ptr<Music>>> takeLoaded();
+};
+
+#endif // TENSAI_MUSIC_LOADER_H
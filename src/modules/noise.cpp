@@ -0,0 +1,368 @@
+#include "noise.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr int Batch = 8;
+constexpr int MinSamplesPerThread = 16384;
+
+const float gradX[8] = {1, -1, 1, -1, 1, -1, 0, 0};
+const float gradY[8] = {1, 1, -1, -1, 0, 0, 1, -1};
+
+inline float fade(float t) { return t * t * t * (t * (t * 6.0f - 15.0f) + 10.0f); }
+inline float lerp(float a, float b, float t) { return a + t * (b - a); }
+inline int fastFloor(float x) {
+  int i = (int)x;
+  return x < i ? i - 1 : i;
+}
+
+inline float grad1(int h, float x) {
+  float g = 1.0f + (h & 7);
+  return ((h & 8) ? -g : g) * x;
+}
+
+inline float grad2(int h, float x, float y) {
+  return gradX[h & 7] * x + gradY[h & 7] * y;
+}
+
+inline float grad3(int h, float x, float y, float z) {
+  h &= 15;
+  float u = h < 8 ? x : y;
+  float v = h < 4 ? y : (h == 12 || h == 14 ? x : z);
+  return ((h & 1) ? -u : u) + ((h & 2) ? -v : v);
+}
+
+// Splits rows [0, height) across worker threads, keeping at least
+// MinSamplesPerThread samples per worker so small grids stay single-threaded.
+void runRows(int width, int height, int threads,
+             const std::function<void(int, int)> &work) {
+  if (width <= 0 || height <= 0)
+    return;
+  if (threads <= 0)
+    threads = (int)std::max(1u, std::thread::hardware_concurrency());
+  long long samples = (long long)width * height;
+  threads = (int)std::min<long long>(
+      {(long long)threads, (long long)height,
+       std::max(1LL, samples / MinSamplesPerThread)});
+  if (threads <= 1) {
+    work(0, height);
+    return;
+  }
+
+  std::vector<std::thread> workers;
+  int rowsPerThread = (height + threads - 1) / threads;
+  for (int t = 1; t < threads; t++) {
+    int begin = t * rowsPerThread;
+    int end = std::min(height, begin + rowsPerThread);
+    if (begin < end)
+      workers.emplace_back(work, begin, end);
+  }
+  work(0, std::min(height, rowsPerThread));
+  for (auto &worker : workers)
+    worker.join();
+}
+
+} // namespace
+
+Noise::Noise(Random random) { setSeed(random); }
+
+void Noise::setSeed(Random random) {
+  for (int i = 0; i < 256; i++)
+    perm[i] = (uint8_t)i;
+  for (int i = 255; i > 0; i--)
+    std::swap(perm[i], perm[random.randomInt(0, i)]);
+  for (int i = 0; i < 256; i++) {
+    perm[i + 256] = perm[i];
+    values[i] = random.randomFloat(-1.0f, 1.0f);
+  }
+}
+
+float Noise::value1(float x) const {
+  int xi = fastFloor(x);
+  return lerp(values[hash(xi)], values[hash(xi + 1)], fade(x - xi));
+}
+
+float Noise::value2(float x, float y) const {
+  int xi = fastFloor(x), yi = fastFloor(y);
+  float u = fade(x - xi), v = fade(y - yi);
+  return lerp(lerp(values[hash(xi, yi)], values[hash(xi + 1, yi)], u),
+              lerp(values[hash(xi, yi + 1)], values[hash(xi + 1, yi + 1)], u), v);
+}
+
+float Noise::value3(float x, float y, float z) const {
+  int xi = fastFloor(x), yi = fastFloor(y), zi = fastFloor(z);
+  float u = fade(x - xi), v = fade(y - yi), w = fade(z - zi);
+  float a = lerp(lerp(values[hash(xi, yi, zi)], values[hash(xi + 1, yi, zi)], u),
+                 lerp(values[hash(xi, yi + 1, zi)], values[hash(xi + 1, yi + 1, zi)], u), v);
+  float b = lerp(lerp(values[hash(xi, yi, zi + 1)], values[hash(xi + 1, yi, zi + 1)], u),
+                 lerp(values[hash(xi, yi + 1, zi + 1)],
+                      values[hash(xi + 1, yi + 1, zi + 1)], u), v);
+  return lerp(a, b, w);
+}
+
+float Noise::perlin1(float x) const {
+  int xi = fastFloor(x);
+  float fx = x - xi;
+  // Gradients span [-8, 8]; scale the result back into about [-1, 1].
+  return lerp(grad1(hash(xi), fx), grad1(hash(xi + 1), fx - 1.0f), fade(fx)) * 0.25f;
+}
+
+float Noise::perlin2(float x, float y) const {
+  int xi = fastFloor(x), yi = fastFloor(y);
+  float fx = x - xi, fy = y - yi;
+  float u = fade(fx), v = fade(fy);
+  return lerp(lerp(grad2(hash(xi, yi), fx, fy), grad2(hash(xi + 1, yi), fx - 1, fy), u),
+              lerp(grad2(hash(xi, yi + 1), fx, fy - 1),
+                   grad2(hash(xi + 1, yi + 1), fx - 1, fy - 1), u), v);
+}
+
+float Noise::perlin3(float x, float y, float z) const {
+  int xi = fastFloor(x), yi = fastFloor(y), zi = fastFloor(z);
+  float fx = x - xi, fy = y - yi, fz = z - zi;
+  float u = fade(fx), v = fade(fy), w = fade(fz);
+  float a = lerp(lerp(grad3(hash(xi, yi, zi), fx, fy, fz),
+                      grad3(hash(xi + 1, yi, zi), fx - 1, fy, fz), u),
+                 lerp(grad3(hash(xi, yi + 1, zi), fx, fy - 1, fz),
+                      grad3(hash(xi + 1, yi + 1, zi), fx - 1, fy - 1, fz), u), v);
+  float b = lerp(lerp(grad3(hash(xi, yi, zi + 1), fx, fy, fz - 1),
+                      grad3(hash(xi + 1, yi, zi + 1), fx - 1, fy, fz - 1), u),
+                 lerp(grad3(hash(xi, yi + 1, zi + 1), fx, fy - 1, fz - 1),
+                      grad3(hash(xi + 1, yi + 1, zi + 1), fx - 1, fy - 1, fz - 1), u), v);
+  return lerp(a, b, w);
+}
+
+float Noise::simplex2(float x, float y) const {
+  const float F2 = 0.36602540378f;
+  const float G2 = 0.2113248654f;
+  float s = (x + y) * F2;
+  int i = fastFloor(x + s), j = fastFloor(y + s);
+  float t = (i + j) * G2;
+  float x0 = x - (i - t), y0 = y - (j - t);
+  int i1 = x0 > y0 ? 1 : 0, j1 = 1 - i1;
+  float x1 = x0 - i1 + G2, y1 = y0 - j1 + G2;
+  float x2 = x0 - 1.0f + 2.0f * G2, y2 = y0 - 1.0f + 2.0f * G2;
+
+  float n = 0.0f;
+  float t0 = 0.5f - x0 * x0 - y0 * y0;
+  if (t0 > 0) {
+    t0 *= t0;
+    n += t0 * t0 * grad2(hash(i, j), x0, y0);
+  }
+  float t1 = 0.5f - x1 * x1 - y1 * y1;
+  if (t1 > 0) {
+    t1 *= t1;
+    n += t1 * t1 * grad2(hash(i + i1, j + j1), x1, y1);
+  }
+  float t2 = 0.5f - x2 * x2 - y2 * y2;
+  if (t2 > 0) {
+    t2 *= t2;
+    n += t2 * t2 * grad2(hash(i + 1, j + 1), x2, y2);
+  }
+  return 70.0f * n;
+}
+
+float Noise::simplex3(float x, float y, float z) const {
+  const float F3 = 1.0f / 3.0f;
+  const float G3 = 1.0f / 6.0f;
+  float s = (x + y + z) * F3;
+  int i = fastFloor(x + s), j = fastFloor(y + s), k = fastFloor(z + s);
+  float t = (i + j + k) * G3;
+  float x0 = x - (i - t), y0 = y - (j - t), z0 = z - (k - t);
+
+  int i1, j1, k1, i2, j2, k2;
+  if (x0 >= y0) {
+    if (y0 >= z0) {
+      i1 = 1, j1 = 0, k1 = 0, i2 = 1, j2 = 1, k2 = 0;
+    } else if (x0 >= z0) {
+      i1 = 1, j1 = 0, k1 = 0, i2 = 1, j2 = 0, k2 = 1;
+    } else {
+      i1 = 0, j1 = 0, k1 = 1, i2 = 1, j2 = 0, k2 = 1;
+    }
+  } else {
+    if (y0 < z0) {
+      i1 = 0, j1 = 0, k1 = 1, i2 = 0, j2 = 1, k2 = 1;
+    } else if (x0 < z0) {
+      i1 = 0, j1 = 1, k1 = 0, i2 = 0, j2 = 1, k2 = 1;
+    } else {
+      i1 = 0, j1 = 1, k1 = 0, i2 = 1, j2 = 1, k2 = 0;
+    }
+  }
+
+  float corners[4][3] = {
+      {x0, y0, z0},
+      {x0 - i1 + G3, y0 - j1 + G3, z0 - k1 + G3},
+      {x0 - i2 + 2.0f * G3, y0 - j2 + 2.0f * G3, z0 - k2 + 2.0f * G3},
+      {x0 - 1.0f + 3.0f * G3, y0 - 1.0f + 3.0f * G3, z0 - 1.0f + 3.0f * G3}};
+  int hashes[4] = {hash(i, j, k), hash(i + i1, j + j1, k + k1),
+                   hash(i + i2, j + j2, k + k2), hash(i + 1, j + 1, k + 1)};
+
+  float n = 0.0f;
+  for (int c = 0; c < 4; c++) {
+    const float *p = corners[c];
+    float tc = 0.6f - p[0] * p[0] - p[1] * p[1] - p[2] * p[2];
+    if (tc > 0) {
+      tc *= tc;
+      n += tc * tc * grad3(hashes[c], p[0], p[1], p[2]);
+    }
+  }
+  return 32.0f * n;
+}
+
+float Noise::sample(float x, const Params &params) const {
+  float sum = 0.0f, amplitude = 1.0f, norm = 0.0f, frequency = params.frequency;
+  for (int o = 0; o < std::max(1, params.octaves); o++) {
+    float fx = x * frequency;
+    sum += amplitude * (params.type == Type::Value ? value1(fx) : perlin1(fx));
+    norm += amplitude;
+    amplitude *= params.gain;
+    frequency *= params.lacunarity;
+  }
+  return sum / norm;
+}
+
+float Noise::sample(float x, float y, const Params &params) const {
+  float sum = 0.0f, amplitude = 1.0f, norm = 0.0f, frequency = params.frequency;
+  for (int o = 0; o < std::max(1, params.octaves); o++) {
+    float fx = x * frequency, fy = y * frequency;
+    float n = params.type == Type::Value    ? value2(fx, fy)
+              : params.type == Type::Perlin ? perlin2(fx, fy)
+                                            : simplex2(fx, fy);
+    sum += amplitude * n;
+    norm += amplitude;
+    amplitude *= params.gain;
+    frequency *= params.lacunarity;
+  }
+  return sum / norm;
+}
+
+float Noise::sample(float x, float y, float z, const Params &params) const {
+  float sum = 0.0f, amplitude = 1.0f, norm = 0.0f, frequency = params.frequency;
+  for (int o = 0; o < std::max(1, params.octaves); o++) {
+    float fx = x * frequency, fy = y * frequency, fz = z * frequency;
+    float n = params.type == Type::Value    ? value3(fx, fy, fz)
+              : params.type == Type::Perlin ? perlin3(fx, fy, fz)
+                                            : simplex3(fx, fy, fz);
+    sum += amplitude * n;
+    norm += amplitude;
+    amplitude *= params.gain;
+    frequency *= params.lacunarity;
+  }
+  return sum / norm;
+}
+
+// One octave of 2D value or Perlin noise along a row. Lattice coordinates,
+// fades and the final interpolation are computed for Batch samples at a time
+// in flat arrays the compiler vectorizes; only the hash/gradient lookups stay
+// scalar gathers.
+void Noise::latticeRow(float *out, int count, float x, float y, float step,
+                       bool perlin) const {
+  int yi = fastFloor(y);
+  float fy = y - yi;
+  float v = fade(fy);
+  int row0 = yi & 255, row1 = (yi + 1) & 255;
+
+  for (int base = 0; base < count; base += Batch) {
+    int n = std::min(Batch, count - base);
+    int xi[Batch];
+    float fx[Batch], u[Batch];
+    for (int k = 0; k < Batch; k++) {
+      float px = x + (base + k) * step;
+      float fl = std::floor(px);
+      xi[k] = (int)fl;
+      fx[k] = px - fl;
+      u[k] = fade(fx[k]);
+    }
+
+    float c00[Batch], c10[Batch], c01[Batch], c11[Batch];
+    for (int k = 0; k < n; k++) {
+      int h0 = perm[xi[k] & 255], h1 = perm[(xi[k] + 1) & 255];
+      int h00 = perm[h0 + row0], h10 = perm[h1 + row0];
+      int h01 = perm[h0 + row1], h11 = perm[h1 + row1];
+      if (perlin) {
+        c00[k] = grad2(h00, fx[k], fy);
+        c10[k] = grad2(h10, fx[k] - 1, fy);
+        c01[k] = grad2(h01, fx[k], fy - 1);
+        c11[k] = grad2(h11, fx[k] - 1, fy - 1);
+      } else {
+        c00[k] = values[h00];
+        c10[k] = values[h10];
+        c01[k] = values[h01];
+        c11[k] = values[h11];
+      }
+    }
+
+    for (int k = 0; k < n; k++) {
+      out[base + k] = lerp(lerp(c00[k], c10[k], u[k]), lerp(c01[k], c11[k], u[k]), v);
+    }
+  }
+}
+
+void Noise::fillRows(float *out, int width, int rowBegin, int rowEnd, float x,
+                     float y, const float *z, float step,
+                     const Params &params) const {
+  bool lattice = !z && params.type != Type::Simplex;
+  std::vector<float> octave(lattice ? width : 0);
+  int octaves = std::max(1, params.octaves);
+  float norm = 0.0f, amplitude = 1.0f;
+  for (int o = 0; o < octaves; o++) {
+    norm += amplitude;
+    amplitude *= params.gain;
+  }
+
+  for (int j = rowBegin; j < rowEnd; j++) {
+    float *row = out + (size_t)j * width;
+    float py = y + j * step;
+    if (!lattice) {
+      for (int i = 0; i < width; i++) {
+        float px = x + i * step;
+        row[i] = z ? sample(px, py, *z, params) : sample(px, py, params);
+      }
+      continue;
+    }
+
+    std::fill(row, row + width, 0.0f);
+    float frequency = params.frequency;
+    amplitude = 1.0f;
+    for (int o = 0; o < octaves; o++) {
+      latticeRow(octave.data(), width, x * frequency, py * frequency,
+                 step * frequency, params.type == Type::Perlin);
+      float scale = amplitude / norm;
+      for (int i = 0; i < width; i++)
+        row[i] += octave[i] * scale;
+      amplitude *= params.gain;
+      frequency *= params.lacunarity;
+    }
+  }
+}
+
+void Noise::fillGrid(float *out, int width, int height, float x, float y,
+                     float step, const Params &params, int threads) const {
+  runRows(width, height, threads, [&](int begin, int end) {
+    fillRows(out, width, begin, end, x, y, nullptr, step, params);
+  });
+}
+
+void Noise::fillGrid(float *out, int width, int height, float x, float y,
+                     float z, float step, const Params &params,
+                     int threads) const {
+  runRows(width, height, threads, [&](int begin, int end) {
+    fillRows(out, width, begin, end, x, y, &z, step, params);
+  });
+}
+
+void Noise::fillPoints(float *out, const float *points, size_t count,
+                       int dimensions, const Params &params) const {
+  for (size_t i = 0; i < count; i++) {
+    const float *p = points + i * dimensions;
+    if (dimensions == 1)
+      out[i] = sample(p[0], params);
+    else if (dimensions == 2)
+      out[i] = sample(p[0], p[1], params);
+    else
+      out[i] = sample(p[0], p[1], p[2], params);
+  }
+}
@@ -0,0 +1,66 @@
+#ifndef TENSAI_NOISE_H
+#define TENSAI_NOISE_H
+
+#include "random.h"
+#include <cstddef>
+#include <cstdint>
+
+// Coherent noise seeded from a Random stream. All samples are fractal sums
+// (fBm) of the base noise, normalized to roughly [-1, 1].
+class Noise {
+public:
+  enum class Type { Value, Perlin, Simplex };
+
+  struct Params {
+    Type type = Type::Perlin;
+    int octaves = 1;
+    float frequency = 1.0f;
+    float lacunarity = 2.0f;
+    float gain = 0.5f;
+  };
+
+  explicit Noise(Random random);
+  void setSeed(Random random);
+
+  float sample(float x, const Params &params) const;
+  float sample(float x, float y, const Params &params) const;
+  float sample(float x, float y, float z, const Params &params) const;
+
+  // Fills a width x height grid, row-major. Sample (i, j) is taken at
+  // (x + i * step, y + j * step) and, for 3D, the fixed depth z. Rows are
+  // split across up to `threads` workers (0 picks the core count).
+  void fillGrid(float *out, int width, int height, float x, float y,
+                float step, const Params &params, int threads = 1) const;
+  void fillGrid(float *out, int width, int height, float x, float y, float z,
+                float step, const Params &params, int threads = 1) const;
+
+  // Evaluates `count` points packed as (x, y) or (x, y, z) tuples.
+  void fillPoints(float *out, const float *points, size_t count, int dimensions,
+                  const Params &params) const;
+
+private:
+  uint8_t perm[512];
+  float values[256];
+
+  int hash(int x) const { return perm[x & 255]; }
+  int hash(int x, int y) const { return perm[perm[x & 255] + (y & 255)]; }
+  int hash(int x, int y, int z) const {
+    return perm[perm[perm[x & 255] + (y & 255)] + (z & 255)];
+  }
+
+  float value1(float x) const;
+  float value2(float x, float y) const;
+  float value3(float x, float y, float z) const;
+  float perlin1(float x) const;
+  float perlin2(float x, float y) const;
+  float perlin3(float x, float y, float z) const;
+  float simplex2(float x, float y) const;
+  float simplex3(float x, float y, float z) const;
+
+  void latticeRow(float *out, int count, float x, float y, float step,
+                  bool perlin) const;
+  void fillRows(float *out, int width, int rowBegin, int rowEnd, float x,
+                float y, const float *z, float step, const Params &params) const;
+};
+
+#endif // TENSAI_NOISE_H
@@ -12,17 +12,13 @@ bool Physics::AABB::contains(const Vec2 &point) const {
 
 bool Physics::circleCircleCollision(const Vec2 &pos1, float radius1,
                                     const Vec2 &pos2, float radius2) {
-  float dx = pos2.x - pos1.x;
-  float dy = pos2.y - pos1.y;
-  float distance = sqrt(dx * dx + dy * dy);
-  return distance < (radius1 + radius2);
+  float radii = radius1 + radius2;
+  return (pos2 - pos1).lengthSquared() < radii * radii;
 }
 
 bool Physics::pointInCircle(const Vec2 &point, const Vec2 &center,
                             float radius) {
-  float dx = point.x - center.x;
-  float dy = point.y - center.y;
-  return (dx * dx + dy * dy) <= (radius * radius);
+  return (point - center).lengthSquared() <= radius * radius;
 }
 
 void Physics::updateBody(Body &body, float dt) {
@@ -41,17 +37,100 @@ void Physics::applyForce(Body &body, const Vec2 &force) {
 
 void Physics::resolveCollision(Body &body1, Body &body2, const Vec2 &normal) {
   Vec2 relativeVelocity = body2.velocity - body1.velocity;
-  float velAlongNormal =
-      relativeVelocity.x * normal.x + relativeVelocity.y * normal.y;
+  float velAlongNormal = relativeVelocity.dot(normal);
 
   if (velAlongNormal > 0)
     return;
 
+  float inverse1 = inverseMass(body1), inverse2 = inverseMass(body2);
+  if (inverse1 + inverse2 == 0.0f)
+    return;
+
   float e = std::min(body1.restitution, body2.restitution);
   float j = -(1 + e) * velAlongNormal;
-  j /= (1.0f / body1.mass) + (1.0f / body2.mass);
+  j /= inverse1 + inverse2;
 
   Vec2 impulse = normal * j;
-  body1.velocity = body1.velocity - impulse * (1.0f / body1.mass);
-  body2.velocity = body2.velocity + impulse * (1.0f / body2.mass);
+  body1.velocity = body1.velocity - impulse * inverse1;
+  body2.velocity = body2.velocity + impulse * inverse2;
+}
+
+float Physics::inverseMass(const Body &body) {
+  return body.kinematic || body.mass <= 0.0f ? 0.0f : 1.0f / body.mass;
+}
+
+bool Physics::sweepCircles(const Vec2 &pos1, float radius1, const Vec2 &d1,
+                           const Vec2 &pos2, float radius2, const Vec2 &d2,
+                           float &toi, Vec2 &normal) {
+  // Solve |p + v t| = r for the earliest t in [0, 1], in shape 2's frame.
+  Vec2 p = pos1 - pos2;
+  Vec2 v = d1 - d2;
+  float r = radius1 + radius2;
+  float c = p.lengthSquared() - r * r;
+  float b = p.dot(v);
+  if (c <= 0.0f) {
+    if (b >= 0.0f)
+      return false;
+    toi = 0.0f;
+    normal = (pos2 - pos1).normalize();
+    return true;
+  }
+  float a = v.lengthSquared();
+  if (a == 0.0f || b >= 0.0f)
+    return false;
+  float discriminant = b * b - a * c;
+  if (discriminant < 0.0f)
+    return false;
+  float t = (-b - sqrt(discriminant)) / a;
+  if (t > 1.0f)
+    return false;
+  toi = std::max(0.0f, t);
+  normal = ((pos2 + d2 * toi) - (pos1 + d1 * toi)).normalize();
+  return true;
+}
+
+bool Physics::sweepAABBs(const AABB &box1, const Vec2 &d1, const AABB &box2,
+                         const Vec2 &d2, float &toi, Vec2 &normal) {
+  // Slab test of the relative motion against box 2 grown by box 1.
+  Vec2 v = d1 - d2;
+  float entry = 0.0f, exit = 1.0f;
+  int axis = -1;
+  const float lo1[2] = {box1.min.x, box1.min.y}, hi1[2] = {box1.max.x, box1.max.y};
+  const float lo2[2] = {box2.min.x, box2.min.y}, hi2[2] = {box2.max.x, box2.max.y};
+  const float vel[2] = {v.x, v.y};
+  for (int i = 0; i < 2; i++) {
+    if (vel[i] == 0.0f) {
+      if (hi1[i] <= lo2[i] || lo1[i] >= hi2[i])
+        return false;
+      continue;
+    }
+    float t0 = (lo2[i] - hi1[i]) / vel[i], t1 = (hi2[i] - lo1[i]) / vel[i];
+    if (t0 > t1)
+      std::swap(t0, t1);
+    if (t0 > entry) {
+      entry = t0;
+      axis = i;
+    }
+    exit = std::min(exit, t1);
+    if (entry >= exit)
+      return false;
+  }
+
+  if (axis < 0) {
+    // Overlapping from the start. Like sweepCircles, only a pair still
+    // approaching along the axis of least penetration is a hit; one already
+    // moving apart is left to separate.
+    float overlapX = std::min(hi1[0] - lo2[0], hi2[0] - lo1[0]);
+    float overlapY = std::min(hi1[1] - lo2[1], hi2[1] - lo1[1]);
+    Vec2 centers = (box2.min + box2.max - box1.min - box1.max) * 0.5f;
+    normal = overlapX <= overlapY ? Vec2(centers.x >= 0.0f ? 1.0f : -1.0f, 0)
+                                  : Vec2(0, centers.y >= 0.0f ? 1.0f : -1.0f);
+    if (v.dot(normal) <= 0.0f)
+      return false;
+    toi = 0.0f;
+    return true;
+  }
+  toi = entry;
+  normal = axis == 0 ? Vec2(v.x > 0 ? 1.0f : -1.0f, 0) : Vec2(0, v.y > 0 ? 1.0f : -1.0f);
+  return true;
 }
\ No newline at end of file
@@ -15,6 +15,9 @@ public:
     float friction = 0.0f;
     float restitution = 1.0f;
     bool kinematic = false;
+    // Bullets are moved with continuous collision detection by PhysicsWorld
+    // instead of end-of-step overlap tests.
+    bool bullet = false;
   };
 
   struct AABB {
@@ -31,6 +34,18 @@ public:
   static void updateBody(Body &body, float dt);
   static void applyForce(Body &body, const Vec2 &force);
   static void resolveCollision(Body &body1, Body &body2, const Vec2 &normal);
+  // Kinematic bodies have infinite mass.
+  static float inverseMass(const Body &body);
+
+  // Time of impact of two moving shapes over one step, as a fraction of the
+  // displacements d1/d2 in [0, 1]. Shapes already overlapping and still
+  // approaching hit at 0. `normal` points from shape 1 to shape 2, the
+  // convention resolveCollision expects.
+  static bool sweepCircles(const Vec2 &pos1, float radius1, const Vec2 &d1,
+                           const Vec2 &pos2, float radius2, const Vec2 &d2,
+                           float &toi, Vec2 &normal);
+  static bool sweepAABBs(const AABB &box1, const Vec2 &d1, const AABB &box2,
+                         const Vec2 &d2, float &toi, Vec2 &normal);
 };
 
 #endif // TENSAI_PHYSICS_H
\ No newline at end of file
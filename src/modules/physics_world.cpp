@@ -0,0 +1,210 @@
+#include "physics_world.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Bullets stop this fraction of their step short of the contact so they never
+// start the next sweep already touching the target.
+constexpr float ContactSlop = 1e-4f;
+
+} // namespace
+
+PhysicsWorld::PhysicsWorld(float cellSize) : index(cellSize) {}
+
+int PhysicsWorld::add(const Object &object) {
+  int id;
+  if (!freeIds.empty()) {
+    id = freeIds.back();
+    freeIds.pop_back();
+  } else {
+    id = (int)objects.size();
+    objects.emplace_back();
+  }
+  objects[id] = object;
+  objects[id].active = true;
+  return id;
+}
+
+void PhysicsWorld::remove(int id) {
+  if (id < 0 || id >= (int)objects.size() || !objects[id].active)
+    return;
+  objects[id].active = false;
+  index.remove(id);
+  freeIds.push_back(id);
+}
+
+PhysicsWorld::Object *PhysicsWorld::get(int id) {
+  if (id < 0 || id >= (int)objects.size() || !objects[id].active)
+    return nullptr;
+  return &objects[id];
+}
+
+void PhysicsWorld::setGravity(const Vec2 &gravity) { this->gravity = gravity; }
+
+Physics::AABB PhysicsWorld::bounds(const Object &object) const {
+  return bounds(object, object.body.position);
+}
+
+Physics::AABB PhysicsWorld::bounds(const Object &object, const Vec2 &position) const {
+  Vec2 half = object.shape == Shape::Circle ? Vec2(object.radius, object.radius)
+                                            : object.halfSize;
+  return {position - half, position + half};
+}
+
+bool PhysicsWorld::overlap(const Object &a, const Object &b, Vec2 &normal,
+                           float &depth) const {
+  const Vec2 &pa = a.body.position, &pb = b.body.position;
+  if (a.shape == Shape::Circle && b.shape == Shape::Circle) {
+    if (!Physics::circleCircleCollision(pa, a.radius, pb, b.radius))
+      return false;
+    float distance = (pb - pa).length();
+    normal = distance > 0.0f ? (pb - pa) / distance : Vec2(1, 0);
+    depth = a.radius + b.radius - distance;
+    return true;
+  }
+
+  if (a.shape == Shape::Box && b.shape == Shape::Box) {
+    Physics::AABB boxA = bounds(a), boxB = bounds(b);
+    if (!boxA.intersects(boxB))
+      return false;
+    float overlapX = std::min(boxA.max.x, boxB.max.x) - std::max(boxA.min.x, boxB.min.x);
+    float overlapY = std::min(boxA.max.y, boxB.max.y) - std::max(boxA.min.y, boxB.min.y);
+    if (overlapX < overlapY) {
+      normal = Vec2(pb.x >= pa.x ? 1.0f : -1.0f, 0);
+      depth = overlapX;
+    } else {
+      normal = Vec2(0, pb.y >= pa.y ? 1.0f : -1.0f);
+      depth = overlapY;
+    }
+    return true;
+  }
+
+  // Circle against box: closest point on the box to the circle center.
+  bool circleFirst = a.shape == Shape::Circle;
+  const Object &circle = circleFirst ? a : b;
+  Physics::AABB box = bounds(circleFirst ? b : a);
+  const Vec2 &center = circle.body.position;
+  Vec2 closest(std::max(box.min.x, std::min(center.x, box.max.x)),
+               std::max(box.min.y, std::min(center.y, box.max.y)));
+  Vec2 offset = closest - center;
+  float distanceSquared = offset.lengthSquared();
+  if (distanceSquared >= circle.radius * circle.radius)
+    return false;
+  float distance = std::sqrt(distanceSquared);
+  // Normal from the circle toward the box, flipped when the box is `a`.
+  Vec2 toBox = distance > 0.0f ? offset / distance
+                               : ((box.min + box.max) * 0.5f - center).normalize();
+  normal = circleFirst ? toBox : -toBox;
+  depth = circle.radius - distance;
+  return true;
+}
+
+bool PhysicsWorld::timeOfImpact(const Object &bullet, const Vec2 &motion,
+                                const Object &target, float &toi,
+                                Vec2 &normal) const {
+  if (bullet.shape == Shape::Circle && target.shape == Shape::Circle) {
+    return Physics::sweepCircles(bullet.body.position, bullet.radius, motion,
+                                 target.body.position, target.radius, Vec2(0, 0),
+                                 toi, normal);
+  }
+  // Mixed and box pairs sweep bounding boxes; a circle's corners are
+  // conservative, which errs toward hitting.
+  return Physics::sweepAABBs(bounds(bullet), motion, bounds(target), Vec2(0, 0),
+                             toi, normal);
+}
+
+void PhysicsWorld::stepBullet(int id, float dt, std::vector<int> &contacts) {
+  Object &bullet = objects[id];
+  Physics::Body &body = bullet.body;
+  float remaining = dt;
+
+  for (int iteration = 0; iteration < MaxBulletIterations && remaining > 0.0f;
+       iteration++) {
+    Vec2 motion = body.velocity * remaining;
+    Physics::AABB start = bounds(bullet), end = bounds(bullet, body.position + motion);
+    Physics::AABB swept = {Vec2(std::min(start.min.x, end.min.x),
+                                std::min(start.min.y, end.min.y)),
+                           Vec2(std::max(start.max.x, end.max.x),
+                                std::max(start.max.y, end.max.y))};
+    candidates.clear();
+    index.queryAABB(swept, candidates);
+
+    int hit = -1;
+    float earliest = 1.0f;
+    Vec2 hitNormal;
+    for (int other : candidates) {
+      float toi;
+      Vec2 normal;
+      if (timeOfImpact(bullet, motion, objects[other], toi, normal) &&
+          (hit < 0 || toi < earliest)) {
+        hit = other;
+        earliest = toi;
+        hitNormal = normal;
+      }
+    }
+
+    if (hit < 0) {
+      body.position = body.position + motion;
+      break;
+    }
+
+    float advance = std::max(0.0f, earliest - ContactSlop);
+    body.position = body.position + motion * advance;
+    Physics::resolveCollision(body, objects[hit].body, hitNormal);
+    contacts.push_back(std::min(id, hit));
+    contacts.push_back(std::max(id, hit));
+    remaining *= 1.0f - advance;
+  }
+}
+
+void PhysicsWorld::step(float dt, std::vector<int> &contacts) {
+  // Integrate regular bodies and refresh their index entries; bullets only
+  // take the velocity half of the update here.
+  for (int id = 0; id < (int)objects.size(); id++) {
+    Object &object = objects[id];
+    if (!object.active)
+      continue;
+    Physics::Body &body = object.body;
+    if (!body.kinematic)
+      body.acceleration = body.acceleration + gravity;
+    if (body.bullet) {
+      index.remove(id);
+      if (!body.kinematic) {
+        body.velocity = body.velocity + body.acceleration * dt;
+        body.velocity = body.velocity * (1.0f - body.friction * dt);
+      }
+      body.acceleration = Vec2(0, 0);
+      continue;
+    }
+    Physics::updateBody(body, dt);
+    index.update(id, bounds(object));
+  }
+
+  pairs.clear();
+  index.queryPairs(pairs);
+  for (size_t i = 0; i < pairs.size(); i += 2) {
+    Object &a = objects[pairs[i]], &b = objects[pairs[i + 1]];
+    Vec2 normal;
+    float depth;
+    if (!overlap(a, b, normal, depth))
+      continue;
+    Physics::resolveCollision(a.body, b.body, normal);
+
+    // Push the pair apart in proportion to inverse mass so resting contacts
+    // do not sink.
+    float inverseA = Physics::inverseMass(a.body), inverseB = Physics::inverseMass(b.body);
+    if (inverseA + inverseB > 0.0f) {
+      Vec2 correction = normal * (depth / (inverseA + inverseB));
+      a.body.position = a.body.position - correction * inverseA;
+      b.body.position = b.body.position + correction * inverseB;
+    }
+    contacts.push_back(pairs[i]);
+    contacts.push_back(pairs[i + 1]);
+  }
+
+  for (int id = 0; id < (int)objects.size(); id++) {
+    if (objects[id].active && objects[id].body.bullet)
+      stepBullet(id, dt, contacts);
+  }
+}
@@ -0,0 +1,61 @@
+#ifndef TENSAI_PHYSICS_WORLD_H
+#define TENSAI_PHYSICS_WORLD_H
+
+#include "../core/vec2.h"
+#include "physics.h"
+#include "spatial_index.h"
+#include <vector>
+
+// Owns a set of bodies and steps them together. Regular bodies integrate
+// with Physics::updateBody and collide by end-of-step overlap, found through
+// a SpatialIndex. Bodies flagged `bullet` are swept instead: each step is
+// split at the earliest time of impact against regular bodies, so cost grows
+// with the number of bullets, not the number of bodies. Bullets do not
+// collide with each other.
+class PhysicsWorld {
+public:
+  enum class Shape { Circle, Box };
+
+  struct Object {
+    Physics::Body body;
+    Shape shape = Shape::Circle;
+    float radius = 0.5f;
+    // Box extents from the center; body.position is the center for both
+    // shapes.
+    Vec2 halfSize{0.5f, 0.5f};
+    bool active = false;
+  };
+
+  // Split a bullet's step at most this many times per update.
+  static constexpr int MaxBulletIterations = 4;
+
+  explicit PhysicsWorld(float cellSize = 64.0f);
+
+  int add(const Object &object);
+  void remove(int id);
+  Object *get(int id);
+  size_t capacity() const { return objects.size(); }
+
+  void setGravity(const Vec2 &gravity);
+
+  // Advances dt seconds and appends each touching pair (a, b) to `contacts`.
+  void step(float dt, std::vector<int> &contacts);
+
+private:
+  std::vector<Object> objects;
+  std::vector<int> freeIds;
+  SpatialIndex index;
+  Vec2 gravity{0, 0};
+  std::vector<int> candidates;
+  std::vector<int> pairs;
+
+  Physics::AABB bounds(const Object &object) const;
+  Physics::AABB bounds(const Object &object, const Vec2 &position) const;
+  bool overlap(const Object &a, const Object &b, Vec2 &normal,
+               float &depth) const;
+  bool timeOfImpact(const Object &bullet, const Vec2 &motion,
+                    const Object &target, float &toi, Vec2 &normal) const;
+  void stepBullet(int id, float dt, std::vector<int> &contacts);
+};
+
+#endif // TENSAI_PHYSICS_WORLD_H
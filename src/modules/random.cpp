@@ -1,23 +1,129 @@
 #include "random.h"
+#include <random>
 
-Random::Random() : generator(std::random_device{}()) {}
+namespace {
 
-Random::Random(uint32_t seed) : generator(seed) {}
+uint64_t splitmix64(uint64_t &x) {
+  uint64_t z = (x += 0x9e3779b97f4a7c15ull);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+  return z ^ (z >> 31);
+}
+
+inline float toUnitFloat(uint64_t bits) { return (bits >> 40) * (1.0f / 16777216.0f); }
+
+// Lemire's nearly-divisionless bounded integer in [0, range).
+template <typename Next> uint32_t bounded(uint32_t range, Next next) {
+  uint64_t m = (next() >> 32) * (uint64_t)range;
+  uint32_t low = (uint32_t)m;
+  if (low < range) {
+    uint32_t threshold = (uint32_t)-range % range;
+    while (low < threshold) {
+      m = (next() >> 32) * (uint64_t)range;
+      low = (uint32_t)m;
+    }
+  }
+  return (uint32_t)(m >> 32);
+}
+
+} // namespace
 
-void Random::setSeed(uint32_t seed) { generator.seed(seed); }
+Random::Random() : Random(((uint64_t)std::random_device{}() << 32) ^ std::random_device{}()) {}
+
+Random::Random(uint64_t seed) { setSeed(seed); }
+
+void Random::setSeed(uint64_t s) {
+  seed = s;
+  uint64_t x = s;
+  for (uint64_t &word : state)
+    word = splitmix64(x);
+  for (int i = 0; i < 4; i++) {
+    for (int lane = 0; lane < 4; lane++)
+      lanes[i][lane] = splitmix64(x);
+  }
+}
+
+uint64_t Random::getSeed() const { return seed; }
+
+Random Random::substream(uint64_t stream) const {
+  uint64_t x = seed ^ (stream * 0xd1342543de82ef95ull);
+  return Random(splitmix64(x));
+}
+
+void Random::nextLanes(uint64_t out[4]) {
+  uint64_t *s0 = lanes[0], *s1 = lanes[1], *s2 = lanes[2], *s3 = lanes[3];
+  for (int lane = 0; lane < 4; lane++) {
+    out[lane] = rotl(s0[lane] + s3[lane], 23) + s0[lane];
+    uint64_t t = s1[lane] << 17;
+    s2[lane] ^= s0[lane];
+    s3[lane] ^= s1[lane];
+    s1[lane] ^= s2[lane];
+    s0[lane] ^= s3[lane];
+    s2[lane] ^= t;
+    s3[lane] = rotl(s3[lane], 45);
+  }
+}
 
 int Random::randomInt(int min, int max) {
-  std::uniform_int_distribution<int> dist(min, max);
-  return dist(generator);
+  if (max <= min)
+    return min;
+  uint64_t range = (uint64_t)((int64_t)max - min) + 1;
+  if (range > 0xffffffffull)
+    return (int)(min + (int64_t)(next() >> 32));
+  return (int)(min + (int64_t)bounded((uint32_t)range, [this] { return next(); }));
 }
 
 float Random::randomFloat(float min, float max) {
-  std::uniform_real_distribution<float> dist(min, max);
-  return dist(generator);
+  return min + toUnitFloat(next()) * (max - min);
 }
 
-bool Random::randomBool() { return randomFloat() < 0.5f; }
+bool Random::randomBool() { return (next() >> 63) != 0; }
 
 Vec2 Random::randomVec2(const Vec2 &min, const Vec2 &max) {
   return Vec2(randomFloat(min.x, max.x), randomFloat(min.y, max.y));
-}
\ No newline at end of file
+}
+
+void Random::fillFloat(float *out, size_t count, float min, float max) {
+  float scale = max - min;
+  uint64_t bits[4];
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    nextLanes(bits);
+    for (int lane = 0; lane < 4; lane++)
+      out[i + lane] = min + toUnitFloat(bits[lane]) * scale;
+  }
+  for (; i < count; i++)
+    out[i] = randomFloat(min, max);
+}
+
+void Random::fillInt(int32_t *out, size_t count, int min, int max) {
+  if (max <= min) {
+    for (size_t i = 0; i < count; i++)
+      out[i] = min;
+    return;
+  }
+  uint64_t range = (uint64_t)((int64_t)max - min) + 1;
+  if (range > 0xffffffffull) {
+    for (size_t i = 0; i < count; i++)
+      out[i] = randomInt(min, max);
+    return;
+  }
+
+  // Multiply-shift maps each lane straight into the range; the rare
+  // rejection case falls back to the scalar bounded path for that slot.
+  uint32_t r = (uint32_t)range;
+  uint32_t threshold = (uint32_t)-r % r;
+  uint64_t bits[4];
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    nextLanes(bits);
+    for (int lane = 0; lane < 4; lane++) {
+      uint64_t m = (bits[lane] >> 32) * (uint64_t)r;
+      out[i + lane] = (uint32_t)m < threshold
+                          ? randomInt(min, max)
+                          : (int32_t)(min + (int64_t)(m >> 32));
+    }
+  }
+  for (; i < count; i++)
+    out[i] = randomInt(min, max);
+}
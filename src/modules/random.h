@@ -2,23 +2,50 @@
 #define TENSAI_RANDOM_H
 
 #include "../core/vec2.h"
+#include <cstddef>
 #include <cstdint>
-#include <random>
 
+// xoshiro256++ generator. Bulk fills run four independent lanes side by side
+// in structure-of-arrays form so the compiler can keep them in vector
+// registers; every stream is fully determined by its seed.
 class Random {
 private:
-  std::mt19937 generator;
+  uint64_t state[4];
+  uint64_t lanes[4][4];
+  uint64_t seed;
+
+  static uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+  void nextLanes(uint64_t out[4]);
 
 public:
   Random();
-  Random(uint32_t seed);
+  Random(uint64_t seed);
+
+  void setSeed(uint64_t seed);
+  uint64_t getSeed() const;
+  // Independent generator derived from this one's seed and a stream id, so
+  // subsystems can draw without perturbing each other.
+  Random substream(uint64_t stream) const;
 
-  void setSeed(uint32_t seed);
+  uint64_t next() {
+    uint64_t result = rotl(state[0] + state[3], 23) + state[0];
+    uint64_t t = state[1] << 17;
+    state[2] ^= state[0];
+    state[3] ^= state[1];
+    state[1] ^= state[2];
+    state[0] ^= state[3];
+    state[2] ^= t;
+    state[3] = rotl(state[3], 45);
+    return result;
+  }
 
   int randomInt(int min, int max);
   float randomFloat(float min = 0.0f, float max = 1.0f);
   bool randomBool();
   Vec2 randomVec2(const Vec2 &min = Vec2(0, 0), const Vec2 &max = Vec2(1, 1));
+
+  void fillFloat(float *out, size_t count, float min, float max);
+  void fillInt(int32_t *out, size_t count, int min, int max);
 };
 
-#endif // TENSAI_RANDOM_H
\ No newline at end of file
+#endif // TENSAI_RANDOM_H
@@ -0,0 +1,322 @@
+#include "rasterizer.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define TENSAI_SSE2 1
+#endif
+
+namespace {
+
+// Textured draws gather samples and coverage for this many pixels of a row,
+// then blend them in one span.
+constexpr int Chunk = 64;
+
+inline uint32_t mulDiv255(uint32_t value, uint32_t factor) {
+  uint32_t x = value * factor + 128;
+  return (x + (x >> 8)) >> 8;
+}
+
+inline uint32_t channel(uint32_t pixel, int shift) { return (pixel >> shift) & 0xff; }
+
+uint32_t blendPixel(uint32_t src, uint32_t dst, uint32_t tint, Rasterizer::Blend blend) {
+  uint32_t s[4], d[4], out[4];
+  for (int c = 0; c < 4; c++) {
+    s[c] = mulDiv255(channel(src, c * 8), channel(tint, c * 8));
+    d[c] = channel(dst, c * 8);
+  }
+  uint32_t a = s[3];
+  for (int c = 0; c < 4; c++) {
+    switch (blend) {
+    case Rasterizer::Blend::None:
+      out[c] = s[c];
+      break;
+    case Rasterizer::Blend::Alpha:
+      out[c] = (c == 3 ? a : mulDiv255(s[c], a)) + mulDiv255(d[c], 255 - a);
+      break;
+    case Rasterizer::Blend::Premultiplied:
+      out[c] = s[c] + mulDiv255(d[c], 255 - a);
+      break;
+    }
+    out[c] = std::min(out[c], 255u);
+  }
+  return out[0] | (out[1] << 8) | (out[2] << 16) | (out[3] << 24);
+}
+
+#ifdef TENSAI_SSE2
+inline __m128i mulDiv255(__m128i x, __m128i y) {
+  __m128i t = _mm_add_epi16(_mm_mullo_epi16(x, y), _mm_set1_epi16(128));
+  return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+}
+
+// Two pixels widened to 16-bit lanes (b, g, r, a, b, g, r, a).
+inline __m128i blendLanes(__m128i s, __m128i d, __m128i tint, Rasterizer::Blend blend) {
+  s = mulDiv255(s, tint);
+  if (blend == Rasterizer::Blend::None)
+    return s;
+  __m128i a = _mm_shufflehi_epi16(_mm_shufflelo_epi16(s, 0xff), 0xff);
+  __m128i inverse = _mm_sub_epi16(_mm_set1_epi16(255), a);
+  if (blend == Rasterizer::Blend::Alpha) {
+    const __m128i colorLanes = _mm_set_epi16(0, -1, -1, -1, 0, -1, -1, -1);
+    const __m128i alphaLane = _mm_set_epi16(255, 0, 0, 0, 255, 0, 0, 0);
+    s = mulDiv255(s, _mm_or_si128(_mm_and_si128(a, colorLanes), alphaLane));
+  }
+  return _mm_add_epi16(s, mulDiv255(d, inverse));
+}
+#endif
+
+SDL_Rect intersect(const SDL_Rect &a, const SDL_Rect &b) {
+  int x0 = std::max(a.x, b.x), y0 = std::max(a.y, b.y);
+  int x1 = std::min(a.x + a.w, b.x + b.w), y1 = std::min(a.y + a.h, b.y + b.h);
+  return {x0, y0, std::max(0, x1 - x0), std::max(0, y1 - y0)};
+}
+
+inline bool inside(const SDL_Rect &clip, int x, int y) {
+  return x >= clip.x && y >= clip.y && x < clip.x + clip.w && y < clip.y + clip.h;
+}
+
+inline uint32_t sample(const Rasterizer::Buffer &source, int u, int v) {
+  u = std::min(std::max(u, 0), source.width - 1);
+  v = std::min(std::max(v, 0), source.height - 1);
+  return source.pixels[(size_t)v * source.stride + u];
+}
+
+// Edge function of (a, b) at p; positive inside a triangle wound like
+// Rasterizer::geometry normalizes to.
+inline float edge(const SDL_FPoint &a, const SDL_FPoint &b, float px, float py) {
+  return (b.x - a.x) * (py - a.y) - (b.y - a.y) * (px - a.x);
+}
+
+// Pixels exactly on an edge belong to one of the two triangles sharing it:
+// an edge and its reverse never both pass this test.
+inline bool ownsEdge(const SDL_FPoint &a, const SDL_FPoint &b) {
+  return b.y > a.y || (b.y == a.y && b.x < a.x);
+}
+
+} // namespace
+
+Rasterizer::Blend Rasterizer::blendOf(SDL_BlendMode mode) {
+  if (mode == SDL_BLENDMODE_NONE)
+    return Blend::None;
+  if (mode == SDL_BLENDMODE_BLEND)
+    return Blend::Alpha;
+  // The texture cache's premultiplied mode is the only custom one in use.
+  return Blend::Premultiplied;
+}
+
+void Rasterizer::blendSpan(uint32_t *dst, const uint32_t *src, const uint32_t *mask,
+                           int count, uint32_t tint, Blend blend) {
+  int i = 0;
+#ifdef TENSAI_SSE2
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i tintLanes = _mm_unpacklo_epi8(_mm_set1_epi32((int)tint), zero);
+  for (; i + 4 <= count; i += 4) {
+    __m128i m = _mm_loadu_si128((const __m128i *)(mask + i));
+    __m128i d = _mm_loadu_si128((const __m128i *)(dst + i));
+    __m128i s = _mm_loadu_si128((const __m128i *)(src + i));
+    __m128i lo = blendLanes(_mm_unpacklo_epi8(s, zero), _mm_unpacklo_epi8(d, zero),
+                            tintLanes, blend);
+    __m128i hi = blendLanes(_mm_unpackhi_epi8(s, zero), _mm_unpackhi_epi8(d, zero),
+                            tintLanes, blend);
+    __m128i out = _mm_packus_epi16(lo, hi);
+    out = _mm_or_si128(_mm_and_si128(m, out), _mm_andnot_si128(m, d));
+    _mm_storeu_si128((__m128i *)(dst + i), out);
+  }
+#endif
+  for (; i < count; i++) {
+    if (mask[i])
+      dst[i] = blendPixel(src[i], dst[i], tint, blend);
+  }
+}
+
+void Rasterizer::fillRect(const Buffer &target, const SDL_Rect &rect, uint32_t color,
+                          const SDL_Rect &clip) {
+  SDL_Rect area = intersect(rect, clip);
+  for (int y = area.y; y < area.y + area.h; y++) {
+    uint32_t *row = target.pixels + (size_t)y * target.stride + area.x;
+    std::fill(row, row + area.w, color);
+  }
+}
+
+void Rasterizer::drawRect(const Buffer &target, const SDL_Rect &rect, uint32_t color,
+                          const SDL_Rect &clip) {
+  if (rect.w <= 0 || rect.h <= 0)
+    return;
+  fillRect(target, {rect.x, rect.y, rect.w, 1}, color, clip);
+  fillRect(target, {rect.x, rect.y + rect.h - 1, rect.w, 1}, color, clip);
+  fillRect(target, {rect.x, rect.y, 1, rect.h}, color, clip);
+  fillRect(target, {rect.x + rect.w - 1, rect.y, 1, rect.h}, color, clip);
+}
+
+void Rasterizer::drawPoints(const Buffer &target, const SDL_Point *points, size_t count,
+                            uint32_t color, const SDL_Rect &clip) {
+  for (size_t i = 0; i < count; i++) {
+    if (inside(clip, points[i].x, points[i].y))
+      target.pixels[(size_t)points[i].y * target.stride + points[i].x] = color;
+  }
+}
+
+void Rasterizer::drawLine(const Buffer &target, SDL_Point a, SDL_Point b, uint32_t color,
+                          const SDL_Rect &clip) {
+  // Skip lines whose bounding box misses the clip entirely.
+  SDL_Rect box = {std::min(a.x, b.x), std::min(a.y, b.y), std::abs(b.x - a.x) + 1,
+                  std::abs(b.y - a.y) + 1};
+  if (intersect(box, clip).w == 0 || intersect(box, clip).h == 0)
+    return;
+  int dx = std::abs(b.x - a.x), dy = -std::abs(b.y - a.y);
+  int sx = a.x < b.x ? 1 : -1, sy = a.y < b.y ? 1 : -1;
+  int error = dx + dy;
+  for (;;) {
+    if (inside(clip, a.x, a.y))
+      target.pixels[(size_t)a.y * target.stride + a.x] = color;
+    if (a.x == b.x && a.y == b.y)
+      break;
+    int twice = 2 * error;
+    if (twice >= dy) {
+      error += dy;
+      a.x += sx;
+    }
+    if (twice <= dx) {
+      error += dx;
+      a.y += sy;
+    }
+  }
+}
+
+void Rasterizer::copy(const Buffer &target, const Buffer &source, const SDL_Rect &dst,
+                      double angle, SDL_Point center, uint32_t tint, Blend blend,
+                      const SDL_Rect &clip) {
+  if (dst.w <= 0 || dst.h <= 0 || source.width <= 0 || source.height <= 0)
+    return;
+  uint32_t samples[Chunk], mask[Chunk];
+
+  if (angle == 0.0) {
+    SDL_Rect area = intersect(dst, clip);
+    if (area.w == 0 || area.h == 0)
+      return;
+    std::fill(mask, mask + Chunk, 0xffffffffu);
+    // 16.16 fixed-point source column, stepped from the first pixel center.
+    int64_t step = ((int64_t)source.width << 16) / dst.w;
+    int64_t first = (((int64_t)(area.x - dst.x) * 2 + 1) * source.width << 16) / (2 * dst.w);
+    for (int y = area.y; y < area.y + area.h; y++) {
+      int v = (int)(((int64_t)(y - dst.y) * 2 + 1) * source.height / (2 * dst.h));
+      const uint32_t *row = source.pixels + (size_t)std::min(v, source.height - 1) * source.stride;
+      uint32_t *out = target.pixels + (size_t)y * target.stride + area.x;
+      int64_t u = first;
+      for (int x = 0; x < area.w; x += Chunk) {
+        int n = std::min(Chunk, area.w - x);
+        for (int i = 0; i < n; i++, u += step)
+          samples[i] = row[std::min((int)(u >> 16), source.width - 1)];
+        blendSpan(out + x, samples, mask, n, tint, blend);
+      }
+    }
+    return;
+  }
+
+  // Rotated: walk the rotated rectangle's bounding box and map each pixel
+  // center back into the unrotated destination rectangle.
+  float radians = (float)(angle * M_PI / 180.0);
+  float c = std::cos(radians), s = std::sin(radians);
+  float pivotX = dst.x + center.x, pivotY = dst.y + center.y;
+  float minX = 1e30f, minY = 1e30f, maxX = -1e30f, maxY = -1e30f;
+  const float cornersX[4] = {0, (float)dst.w, (float)dst.w, 0};
+  const float cornersY[4] = {0, 0, (float)dst.h, (float)dst.h};
+  for (int i = 0; i < 4; i++) {
+    float lx = cornersX[i] - center.x, ly = cornersY[i] - center.y;
+    float x = pivotX + c * lx - s * ly, y = pivotY + s * lx + c * ly;
+    minX = std::min(minX, x);
+    maxX = std::max(maxX, x);
+    minY = std::min(minY, y);
+    maxY = std::max(maxY, y);
+  }
+  SDL_Rect box = {(int)std::floor(minX), (int)std::floor(minY),
+                  (int)std::ceil(maxX) - (int)std::floor(minX) + 1,
+                  (int)std::ceil(maxY) - (int)std::floor(minY) + 1};
+  SDL_Rect area = intersect(box, clip);
+  float scaleU = (float)source.width / dst.w, scaleV = (float)source.height / dst.h;
+  for (int y = area.y; y < area.y + area.h; y++) {
+    uint32_t *out = target.pixels + (size_t)y * target.stride + area.x;
+    float dy = y + 0.5f - pivotY;
+    for (int x = 0; x < area.w; x += Chunk) {
+      int n = std::min(Chunk, area.w - x);
+      float dx = area.x + x + 0.5f - pivotX;
+      float lx = c * dx + s * dy + center.x, ly = -s * dx + c * dy + center.y;
+      for (int i = 0; i < n; i++, lx += c, ly -= s) {
+        bool covered = lx >= 0.0f && ly >= 0.0f && lx < dst.w && ly < dst.h;
+        mask[i] = covered ? 0xffffffffu : 0;
+        samples[i] = covered ? sample(source, (int)(lx * scaleU), (int)(ly * scaleV)) : 0;
+      }
+      blendSpan(out + x, samples, mask, n, tint, blend);
+    }
+  }
+}
+
+void Rasterizer::geometry(const Buffer &target, const Buffer &source,
+                          const SDL_Vertex *vertices, const int *indices,
+                          size_t indexCount, Blend blend, const SDL_Rect &clip) {
+  uint32_t samples[Chunk], mask[Chunk];
+  for (size_t t = 0; t + 2 < indexCount; t += 3) {
+    const SDL_Vertex *v[3] = {&vertices[indices[t]], &vertices[indices[t + 1]],
+                              &vertices[indices[t + 2]]};
+    float area = edge(v[0]->position, v[1]->position, v[2]->position.x, v[2]->position.y);
+    if (area == 0.0f)
+      continue;
+    if (area < 0.0f) {
+      std::swap(v[1], v[2]);
+      area = -area;
+    }
+    const SDL_FPoint &p0 = v[0]->position, &p1 = v[1]->position, &p2 = v[2]->position;
+    SDL_Rect box = {(int)std::floor(std::min({p0.x, p1.x, p2.x})),
+                    (int)std::floor(std::min({p0.y, p1.y, p2.y})), 0, 0};
+    box.w = (int)std::ceil(std::max({p0.x, p1.x, p2.x})) - box.x + 1;
+    box.h = (int)std::ceil(std::max({p0.y, p1.y, p2.y})) - box.y + 1;
+    SDL_Rect pixels = intersect(box, clip);
+    if (pixels.w == 0 || pixels.h == 0)
+      continue;
+
+    // A uniform vertex color (every sprite quad) becomes the span tint;
+    // otherwise colors are interpolated per pixel.
+    const SDL_Color &c0 = v[0]->color, &c1 = v[1]->color, &c2 = v[2]->color;
+    bool uniform = c0.r == c1.r && c0.g == c1.g && c0.b == c1.b && c0.a == c1.a &&
+                   c0.r == c2.r && c0.g == c2.g && c0.b == c2.b && c0.a == c2.a;
+    uint32_t tint = pack(c0.r, c0.g, c0.b, c0.a);
+    bool own0 = ownsEdge(p1, p2), own1 = ownsEdge(p2, p0), own2 = ownsEdge(p0, p1);
+    float su = source.width / area, sv = source.height / area;
+
+    for (int y = pixels.y; y < pixels.y + pixels.h; y++) {
+      uint32_t *out = target.pixels + (size_t)y * target.stride + pixels.x;
+      float py = y + 0.5f;
+      for (int x = 0; x < pixels.w; x += Chunk) {
+        int n = std::min(Chunk, pixels.w - x);
+        float px = pixels.x + x + 0.5f;
+        float w0 = edge(p1, p2, px, py), w1 = edge(p2, p0, px, py), w2 = edge(p0, p1, px, py);
+        float step0 = -(p2.y - p1.y), step1 = -(p0.y - p2.y), step2 = -(p1.y - p0.y);
+        for (int i = 0; i < n; i++, w0 += step0, w1 += step1, w2 += step2) {
+          bool covered = (w0 > 0.0f || (w0 == 0.0f && own0)) &&
+                         (w1 > 0.0f || (w1 == 0.0f && own1)) &&
+                         (w2 > 0.0f || (w2 == 0.0f && own2));
+          mask[i] = covered ? 0xffffffffu : 0;
+          if (!covered) {
+            samples[i] = 0;
+            continue;
+          }
+          float u = (w0 * v[0]->tex_coord.x + w1 * v[1]->tex_coord.x +
+                     w2 * v[2]->tex_coord.x) * su;
+          float vv = (w0 * v[0]->tex_coord.y + w1 * v[1]->tex_coord.y +
+                      w2 * v[2]->tex_coord.y) * sv;
+          samples[i] = sample(source, (int)u, (int)vv);
+          if (!uniform) {
+            float l0 = w0 / area, l1 = w1 / area, l2 = w2 / area;
+            uint32_t color = pack((uint8_t)(l0 * c0.r + l1 * c1.r + l2 * c2.r + 0.5f),
+                                  (uint8_t)(l0 * c0.g + l1 * c1.g + l2 * c2.g + 0.5f),
+                                  (uint8_t)(l0 * c0.b + l1 * c1.b + l2 * c2.b + 0.5f),
+                                  (uint8_t)(l0 * c0.a + l1 * c1.a + l2 * c2.a + 0.5f));
+            samples[i] = blendPixel(samples[i], 0, color, Blend::None);
+          }
+        }
+        blendSpan(out + x, samples, mask, n, uniform ? tint : 0xffffffffu, blend);
+      }
+    }
+  }
+}
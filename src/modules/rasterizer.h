@@ -0,0 +1,56 @@
+#ifndef TENSAI_RASTERIZER_H
+#define TENSAI_RASTERIZER_H
+
+#include <SDL2/SDL.h>
+#include <cstddef>
+#include <cstdint>
+
+// CPU drawing into ARGB8888 pixel buffers (0xAARRGGBB words, the layout of
+// SDL_PIXELFORMAT_ARGB8888). The operations follow the SDL renderer's rules:
+// shapes overwrite with the draw color (SDL's default blend mode NONE),
+// textures are sampled nearest-neighbor, modulated by a tint and blended
+// with the texture's blend mode. Every call draws only inside `clip`, which
+// must lie within the target, so a frame can be split into bands that are
+// rasterized in parallel with identical results.
+class Rasterizer {
+public:
+  struct Buffer {
+    uint32_t *pixels;
+    int width, height;
+    int stride; // in pixels
+  };
+
+  enum class Blend { None, Alpha, Premultiplied };
+
+  static uint32_t pack(uint8_t r, uint8_t g, uint8_t b, uint8_t a) {
+    return ((uint32_t)a << 24) | ((uint32_t)r << 16) | ((uint32_t)g << 8) | b;
+  }
+  static Blend blendOf(SDL_BlendMode mode);
+
+  static void fillRect(const Buffer &target, const SDL_Rect &rect, uint32_t color,
+                       const SDL_Rect &clip);
+  static void drawRect(const Buffer &target, const SDL_Rect &rect, uint32_t color,
+                       const SDL_Rect &clip);
+  static void drawPoints(const Buffer &target, const SDL_Point *points, size_t count,
+                         uint32_t color, const SDL_Rect &clip);
+  // Both endpoints inclusive, like SDL_RenderDrawLine.
+  static void drawLine(const Buffer &target, SDL_Point a, SDL_Point b, uint32_t color,
+                       const SDL_Rect &clip);
+
+  // `source` stretched over `dst`, rotated `angle` degrees clockwise around
+  // (dst.x + center.x, dst.y + center.y), as SDL_RenderCopyEx.
+  static void copy(const Buffer &target, const Buffer &source, const SDL_Rect &dst,
+                   double angle, SDL_Point center, uint32_t tint, Blend blend,
+                   const SDL_Rect &clip);
+  // Indexed textured triangles, as SDL_RenderGeometry.
+  static void geometry(const Buffer &target, const Buffer &source,
+                       const SDL_Vertex *vertices, const int *indices,
+                       size_t indexCount, Blend blend, const SDL_Rect &clip);
+
+  // dst[i] = blend(tint * src[i], dst[i]) where mask[i] is all ones. SSE2
+  // four pixels at a time with a scalar tail.
+  static void blendSpan(uint32_t *dst, const uint32_t *src, const uint32_t *mask,
+                        int count, uint32_t tint, Blend blend);
+};
+
+#endif // TENSAI_RASTERIZER_H
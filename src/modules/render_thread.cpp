@@ -0,0 +1,54 @@
+#include "render_thread.h"
+
+void releaseRendererContext(SDL_Renderer *renderer) {
+  if (SDL_GL_GetCurrentContext())
+    SDL_GL_MakeCurrent(SDL_RenderGetWindow(renderer), nullptr);
+}
+
+RenderThread::RenderThread(SDL_Renderer *r) : renderer(r) {
+  thread = std::thread([this] { run(); });
+}
+
+RenderThread::~RenderThread() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  wake.notify_one();
+  thread.join();
+}
+
+uint64_t RenderThread::post(std::function<void()> job) {
+  uint64_t ticket;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    jobs.push_back(std::move(job));
+    ticket = ++posted;
+  }
+  wake.notify_one();
+  return ticket;
+}
+
+void RenderThread::wait(uint64_t ticket) {
+  std::unique_lock<std::mutex> lock(mutex);
+  done.wait(lock, [&] { return completed >= ticket; });
+}
+
+void RenderThread::run() {
+  std::unique_lock<std::mutex> lock(mutex);
+  for (;;) {
+    wake.wait(lock, [&] { return stopping || !jobs.empty(); });
+    // Drain queued jobs before honoring a stop so no waiter is stranded.
+    if (jobs.empty())
+      break;
+    std::function<void()> job = std::move(jobs.front());
+    jobs.pop_front();
+    lock.unlock();
+    job();
+    lock.lock();
+    completed++;
+    done.notify_all();
+  }
+  lock.unlock();
+  releaseRendererContext(renderer);
+}
@@ -0,0 +1,42 @@
+#ifndef TENSAI_RENDER_THREAD_H
+#define TENSAI_RENDER_THREAD_H
+
+#include <SDL2/SDL.h>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+// Worker that owns an SDL_Renderer. Jobs run in the order they were posted;
+// post returns a ticket that wait blocks on until that job has finished.
+class RenderThread {
+public:
+  explicit RenderThread(SDL_Renderer *renderer);
+  ~RenderThread();
+
+  uint64_t post(std::function<void()> job);
+  void wait(uint64_t ticket);
+  // Runs `job` on the render thread and blocks until it returns.
+  void invoke(std::function<void()> job) { wait(post(std::move(job))); }
+
+private:
+  SDL_Renderer *renderer;
+  std::mutex mutex;
+  std::condition_variable wake;
+  std::condition_variable done;
+  std::deque<std::function<void()>> jobs;
+  uint64_t posted = 0;
+  uint64_t completed = 0;
+  bool stopping = false;
+  std::thread thread;
+
+  void run();
+};
+
+// Drops the calling thread's claim on an OpenGL renderer's context so
+// another thread can make it current. No-op for other backends.
+void releaseRendererContext(SDL_Renderer *renderer);
+
+#endif // TENSAI_RENDER_THREAD_H
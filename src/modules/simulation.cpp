@@ -0,0 +1,58 @@
+#include "simulation.h"
+#include <algorithm>
+#include <limits>
+
+Simulation::Simulation(uint64_t seed, float cellSize, double timestep)
+    : world(cellSize), random(seed), timestep(timestep) {}
+
+void Simulation::queue(const InputEvent &event) {
+  auto at = std::upper_bound(events.begin(), events.end(), event,
+                             [](const InputEvent &a, const InputEvent &b) {
+                               return a.tick < b.tick;
+                             });
+  events.insert(at, event);
+}
+
+void Simulation::queueKey(uint64_t at, int key, bool pressed) {
+  queue({at, key, false, pressed});
+}
+
+void Simulation::queueMouse(uint64_t at, int button, bool pressed) {
+  queue({at, button, true, pressed});
+}
+
+void Simulation::step(int ticks) {
+  snapshot.contacts.clear();
+  for (int i = 0; i < ticks; i++) {
+    input.update();
+    size_t applied = 0;
+    while (applied < events.size() && events[applied].tick <= tick) {
+      const InputEvent &event = events[applied++];
+      if (event.mouse)
+        input.setMouse(event.code, event.pressed);
+      else
+        input.setKey(event.code, event.pressed);
+    }
+    events.erase(events.begin(), events.begin() + applied);
+
+    contacts.clear();
+    world.step((float)timestep, contacts);
+    snapshot.contacts.insert(snapshot.contacts.end(), contacts.begin(), contacts.end());
+    timer.advance(timestep);
+    tick++;
+  }
+
+  snapshot.tick = tick;
+  snapshot.time = timer.getTime();
+  snapshot.bodies.assign(world.capacity() * 4, std::numeric_limits<float>::quiet_NaN());
+  for (size_t id = 0; id < world.capacity(); id++) {
+    const PhysicsWorld::Object *object = world.get((int)id);
+    if (!object)
+      continue;
+    float *out = &snapshot.bodies[id * 4];
+    out[0] = object->body.position.x;
+    out[1] = object->body.position.y;
+    out[2] = object->body.velocity.x;
+    out[3] = object->body.velocity.y;
+  }
+}
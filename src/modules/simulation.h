@@ -0,0 +1,66 @@
+#ifndef TENSAI_SIMULATION_H
+#define TENSAI_SIMULATION_H
+
+#include "input.h"
+#include "physics_world.h"
+#include "random.h"
+#include "timer.h"
+#include <cstdint>
+#include <vector>
+
+// Game state with no window, renderer or audio: a physics world, a seeded
+// Random, an input feed and a clock that advances by a fixed timestep per
+// tick. Nothing here touches SDL, so simulations can be created without
+// SDL_Init and stepped on any thread, one thread per simulation at a time.
+class Simulation {
+public:
+  // State after the last step: four floats per body id (x, y, vx, vy), NaN
+  // for removed ids, and every contact pair reported during the step.
+  struct Snapshot {
+    uint64_t tick = 0;
+    double time = 0.0;
+    std::vector<float> bodies;
+    std::vector<int> contacts;
+  };
+
+  explicit Simulation(uint64_t seed, float cellSize = 64.0f,
+                      double timestep = 1.0 / 60.0);
+
+  PhysicsWorld &getWorld() { return world; }
+  Random &getRandom() { return random; }
+  const Input &getInput() const { return input; }
+  const Timer &getTimer() const { return timer; }
+  uint64_t getTick() const { return tick; }
+  double getTimestep() const { return timestep; }
+
+  // Input changes take effect at the start of `at` (or the next tick when it
+  // has passed), so isPressed sees them for exactly one tick.
+  void queueKey(uint64_t at, int key, bool pressed);
+  void queueMouse(uint64_t at, int button, bool pressed);
+
+  void step(int ticks);
+  const Snapshot &getSnapshot() const { return snapshot; }
+
+private:
+  struct InputEvent {
+    uint64_t tick;
+    int code;
+    bool mouse;
+    bool pressed;
+  };
+
+  PhysicsWorld world;
+  Random random;
+  Input input;
+  Timer timer;
+  double timestep;
+  uint64_t tick = 0;
+  // Ordered by tick; events for the same tick keep their queue order.
+  std::vector<InputEvent> events;
+  std::vector<int> contacts;
+  Snapshot snapshot;
+
+  void queue(const InputEvent &event);
+};
+
+#endif // TENSAI_SIMULATION_H
@@ -0,0 +1,330 @@
+#include "spatial_index.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+constexpr float Infinity = std::numeric_limits<float>::infinity();
+
+// Clips a ray against a box; on a hit returns the entry and exit distances.
+bool raySlab(const Vec2 &origin, const Vec2 &direction, float maxDistance,
+             const Physics::AABB &box, float &tEnter, float &tExit) {
+  tEnter = 0.0f;
+  tExit = maxDistance;
+  const float o[2] = {origin.x, origin.y};
+  const float d[2] = {direction.x, direction.y};
+  const float lo[2] = {box.min.x, box.min.y};
+  const float hi[2] = {box.max.x, box.max.y};
+  for (int axis = 0; axis < 2; axis++) {
+    if (d[axis] == 0.0f) {
+      if (o[axis] < lo[axis] || o[axis] > hi[axis])
+        return false;
+      continue;
+    }
+    float inv = 1.0f / d[axis];
+    float t0 = (lo[axis] - o[axis]) * inv, t1 = (hi[axis] - o[axis]) * inv;
+    if (t0 > t1)
+      std::swap(t0, t1);
+    tEnter = std::max(tEnter, t0);
+    tExit = std::min(tExit, t1);
+    if (tEnter > tExit)
+      return false;
+  }
+  return true;
+}
+
+} // namespace
+
+SpatialIndex::SpatialIndex(float cellSize)
+    : cellSize(cellSize > 0.0f ? cellSize : 64.0f),
+      inverseCellSize(1.0f / this->cellSize) {}
+
+int SpatialIndex::cellCoord(float v) const {
+  float c = std::floor(v * inverseCellSize);
+  return (int)std::max(-1073741824.0f, std::min(1073741824.0f, c));
+}
+
+void SpatialIndex::clear() {
+  cells.clear();
+  large.clear();
+  entries.clear();
+  count = 0;
+  hasExtent = false;
+}
+
+void SpatialIndex::build(const float *boxes, size_t boxCount) {
+  // Keep cell vectors (and their capacity) across per-frame rebuilds, but
+  // drop them once most are stale so the table tracks the live area.
+  size_t occupied = 0;
+  for (auto &cell : cells) {
+    occupied += !cell.second.empty();
+    cell.second.clear();
+  }
+  if (cells.size() > 2 * occupied + 64)
+    cells.clear();
+  large.clear();
+  hasExtent = false;
+
+  entries.assign(boxCount, Entry());
+  count = boxCount;
+  for (size_t i = 0; i < boxCount; i++) {
+    const float *b = boxes + i * 4;
+    Entry &entry = entries[i];
+    entry.box = {Vec2(b[0], b[1]), Vec2(b[2], b[3])};
+    entry.active = true;
+    link((int)i);
+  }
+}
+
+void SpatialIndex::update(int id, const Physics::AABB &box) {
+  if (id < 0)
+    return;
+  if ((size_t)id >= entries.size())
+    entries.resize(id + 1);
+  Entry &entry = entries[id];
+  if (entry.active) {
+    int x0 = cellCoord(box.min.x), y0 = cellCoord(box.min.y);
+    int x1 = cellCoord(box.max.x), y1 = cellCoord(box.max.y);
+    if (x0 == entry.x0 && y0 == entry.y0 && x1 == entry.x1 && y1 == entry.y1) {
+      // Same cells, but the box may still have moved past the extent that
+      // raycasts clip to.
+      entry.box = box;
+      growExtent(box);
+      return;
+    }
+    unlink(id);
+  } else {
+    entry.active = true;
+    count++;
+  }
+  entry.box = box;
+  link(id);
+}
+
+void SpatialIndex::remove(int id) {
+  if (id < 0 || (size_t)id >= entries.size() || !entries[id].active)
+    return;
+  unlink(id);
+  entries[id].active = false;
+  count--;
+}
+
+void SpatialIndex::link(int id) {
+  Entry &entry = entries[id];
+  entry.x0 = cellCoord(entry.box.min.x);
+  entry.y0 = cellCoord(entry.box.min.y);
+  entry.x1 = cellCoord(entry.box.max.x);
+  entry.y1 = cellCoord(entry.box.max.y);
+  growExtent(entry.box);
+
+  long long span = (long long)(entry.x1 - entry.x0 + 1) * (entry.y1 - entry.y0 + 1);
+  entry.large = span > MaxCellsPerEntry;
+  if (entry.large) {
+    large.push_back(id);
+    return;
+  }
+  for (int y = entry.y0; y <= entry.y1; y++) {
+    for (int x = entry.x0; x <= entry.x1; x++)
+      cells[cellKey(x, y)].push_back(id);
+  }
+}
+
+void SpatialIndex::growExtent(const Physics::AABB &box) {
+  if (hasExtent) {
+    extent.min.x = std::min(extent.min.x, box.min.x);
+    extent.min.y = std::min(extent.min.y, box.min.y);
+    extent.max.x = std::max(extent.max.x, box.max.x);
+    extent.max.y = std::max(extent.max.y, box.max.y);
+  } else {
+    extent = box;
+    hasExtent = true;
+  }
+}
+
+void SpatialIndex::unlink(int id) {
+  Entry &entry = entries[id];
+  if (entry.large) {
+    auto it = std::find(large.begin(), large.end(), id);
+    if (it != large.end()) {
+      *it = large.back();
+      large.pop_back();
+    }
+    return;
+  }
+  for (int y = entry.y0; y <= entry.y1; y++) {
+    for (int x = entry.x0; x <= entry.x1; x++) {
+      auto cell = cells.find(cellKey(x, y));
+      if (cell == cells.end())
+        continue;
+      std::vector<int> &ids = cell->second;
+      auto it = std::find(ids.begin(), ids.end(), id);
+      if (it != ids.end()) {
+        *it = ids.back();
+        ids.pop_back();
+      }
+      if (ids.empty())
+        cells.erase(cell);
+    }
+  }
+}
+
+void SpatialIndex::nextStamp() {
+  if (marks.size() < entries.size())
+    marks.resize(entries.size(), 0);
+  if (++stamp == 0) {
+    std::fill(marks.begin(), marks.end(), 0);
+    stamp = 1;
+  }
+}
+
+bool SpatialIndex::visit(int id) {
+  if (marks[id] == stamp)
+    return false;
+  marks[id] = stamp;
+  return true;
+}
+
+template <typename Fn>
+void SpatialIndex::forEachCandidate(int x0, int y0, int x1, int y1, Fn fn) {
+  nextStamp();
+  long long span = (long long)(x1 - x0 + 1) * (y1 - y0 + 1);
+  if (span > (long long)cells.size()) {
+    // Query covers more cells than exist; walk the table instead.
+    for (auto &cell : cells) {
+      int x = (int)(uint32_t)(cell.first >> 32), y = (int)(uint32_t)cell.first;
+      if (x < x0 || x > x1 || y < y0 || y > y1)
+        continue;
+      for (int id : cell.second) {
+        if (visit(id))
+          fn(id);
+      }
+    }
+  } else {
+    for (int y = y0; y <= y1; y++) {
+      for (int x = x0; x <= x1; x++) {
+        auto cell = cells.find(cellKey(x, y));
+        if (cell == cells.end())
+          continue;
+        for (int id : cell->second) {
+          if (visit(id))
+            fn(id);
+        }
+      }
+    }
+  }
+  for (int id : large)
+    fn(id);
+}
+
+void SpatialIndex::queryAABB(const Physics::AABB &box, std::vector<int> &out) {
+  forEachCandidate(cellCoord(box.min.x), cellCoord(box.min.y), cellCoord(box.max.x),
+                   cellCoord(box.max.y), [&](int id) {
+                     if (entries[id].box.intersects(box))
+                       out.push_back(id);
+                   });
+}
+
+void SpatialIndex::queryCircle(const Vec2 &center, float radius,
+                               std::vector<int> &out) {
+  float radiusSquared = radius * radius;
+  forEachCandidate(cellCoord(center.x - radius), cellCoord(center.y - radius),
+                   cellCoord(center.x + radius), cellCoord(center.y + radius),
+                   [&](int id) {
+                     const Physics::AABB &box = entries[id].box;
+                     Vec2 closest(std::max(box.min.x, std::min(center.x, box.max.x)),
+                                  std::max(box.min.y, std::min(center.y, box.max.y)));
+                     if ((closest - center).lengthSquared() < radiusSquared)
+                       out.push_back(id);
+                   });
+}
+
+void SpatialIndex::raycast(const Vec2 &origin, const Vec2 &direction,
+                           float maxDistance, std::vector<int> &out) {
+  Vec2 dir = direction.normalize();
+  if (dir == Vec2(0, 0) || !(maxDistance >= 0.0f))
+    return;
+  hits.clear();
+  nextStamp();
+
+  auto test = [&](int id) {
+    float tEnter, tExit;
+    if (raySlab(origin, dir, maxDistance, entries[id].box, tEnter, tExit))
+      hits.emplace_back(tEnter, id);
+  };
+
+  // Walk grid cells (Amanatides-Woo) only over the stretch of the ray that
+  // crosses the populated area, which also bounds rays of infinite length.
+  float tStart, tEnd;
+  if (hasExtent && raySlab(origin, dir, maxDistance, extent, tStart, tEnd)) {
+    Vec2 start = origin + dir * tStart;
+    int cx = cellCoord(start.x), cy = cellCoord(start.y);
+    int stepX = dir.x > 0 ? 1 : (dir.x < 0 ? -1 : 0);
+    int stepY = dir.y > 0 ? 1 : (dir.y < 0 ? -1 : 0);
+    float tMaxX = stepX ? tStart + ((cx + (stepX > 0)) * cellSize - start.x) / dir.x
+                        : Infinity;
+    float tMaxY = stepY ? tStart + ((cy + (stepY > 0)) * cellSize - start.y) / dir.y
+                        : Infinity;
+    float tDeltaX = stepX ? cellSize / std::fabs(dir.x) : Infinity;
+    float tDeltaY = stepY ? cellSize / std::fabs(dir.y) : Infinity;
+
+    float t = tStart;
+    while (t <= tEnd) {
+      auto cell = cells.find(cellKey(cx, cy));
+      if (cell != cells.end()) {
+        for (int id : cell->second) {
+          if (visit(id))
+            test(id);
+        }
+      }
+      if (tMaxX < tMaxY) {
+        t = tMaxX;
+        tMaxX += tDeltaX;
+        cx += stepX;
+      } else {
+        t = tMaxY;
+        tMaxY += tDeltaY;
+        cy += stepY;
+      }
+    }
+  }
+  for (int id : large)
+    test(id);
+
+  std::sort(hits.begin(), hits.end());
+  for (const auto &hit : hits)
+    out.push_back(hit.second);
+}
+
+void SpatialIndex::queryPairs(std::vector<int> &out) {
+  for (const auto &cell : cells) {
+    int cx = (int)(uint32_t)(cell.first >> 32), cy = (int)(uint32_t)cell.first;
+    const std::vector<int> &ids = cell.second;
+    for (size_t i = 0; i < ids.size(); i++) {
+      const Entry &a = entries[ids[i]];
+      for (size_t j = i + 1; j < ids.size(); j++) {
+        const Entry &b = entries[ids[j]];
+        // Report each pair only from the first cell the two boxes share.
+        if (std::max(a.x0, b.x0) != cx || std::max(a.y0, b.y0) != cy)
+          continue;
+        if (a.box.intersects(b.box)) {
+          out.push_back(std::min(ids[i], ids[j]));
+          out.push_back(std::max(ids[i], ids[j]));
+        }
+      }
+    }
+  }
+
+  for (int id : large) {
+    const Physics::AABB &box = entries[id].box;
+    for (size_t other = 0; other < entries.size(); other++) {
+      const Entry &entry = entries[other];
+      if (!entry.active || (int)other == id || (entry.large && (int)other < id))
+        continue;
+      if (entry.box.intersects(box)) {
+        out.push_back(std::min(id, (int)other));
+        out.push_back(std::max(id, (int)other));
+      }
+    }
+  }
+}
@@ -0,0 +1,81 @@
+#ifndef TENSAI_SPATIAL_INDEX_H
+#define TENSAI_SPATIAL_INDEX_H
+
+#include "../core/vec2.h"
+#include "physics.h"
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// Hashed uniform grid over AABBs keyed by small non-negative integer ids
+// (typically indices into a JS array). Boxes are registered in every cell they
+// overlap, so queries only test entries near the query shape; overlap tests
+// use Physics::AABB::intersects semantics (touching edges overlap).
+class SpatialIndex {
+public:
+  explicit SpatialIndex(float cellSize = 64.0f);
+
+  float getCellSize() const { return cellSize; }
+  size_t size() const { return count; }
+
+  void clear();
+  // Replaces the contents with `boxCount` boxes packed as
+  // (minX, minY, maxX, maxY); box i gets id i.
+  void build(const float *boxes, size_t boxCount);
+  // Inserts or moves one entry. Cells are only touched when the box crosses
+  // into a different cell range.
+  void update(int id, const Physics::AABB &box);
+  void remove(int id);
+
+  // Results are appended to `out` in unspecified order unless noted.
+  void queryAABB(const Physics::AABB &box, std::vector<int> &out);
+  // Boxes whose closest point lies strictly inside the circle, matching
+  // Physics::circleCircleCollision.
+  void queryCircle(const Vec2 &center, float radius, std::vector<int> &out);
+  // Boxes hit by the ray within maxDistance, nearest first. `direction`
+  // need not be normalized; distances are along its unit vector.
+  void raycast(const Vec2 &origin, const Vec2 &direction, float maxDistance,
+               std::vector<int> &out);
+  // Every overlapping pair once, flattened as (a, b) with a < b.
+  void queryPairs(std::vector<int> &out);
+
+private:
+  struct Entry {
+    Physics::AABB box;
+    int x0 = 0, y0 = 0, x1 = -1, y1 = -1;
+    bool active = false;
+    bool large = false;
+  };
+
+  // Boxes spanning more cells than this are kept in a separate list tested
+  // by every query, instead of being copied into hundreds of cells.
+  static constexpr int MaxCellsPerEntry = 64;
+
+  float cellSize;
+  float inverseCellSize;
+  size_t count = 0;
+  std::vector<Entry> entries;
+  std::unordered_map<uint64_t, std::vector<int>> cells;
+  std::vector<int> large;
+  // Union of every box placed since the last build/clear; bounds raycasts.
+  Physics::AABB extent;
+  bool hasExtent = false;
+  // Per-id visit stamps so an entry spanning several cells is reported once.
+  std::vector<uint32_t> marks;
+  uint32_t stamp = 0;
+  std::vector<std::pair<float, int>> hits;
+
+  static uint64_t cellKey(int x, int y) {
+    return ((uint64_t)(uint32_t)x << 32) | (uint32_t)y;
+  }
+  int cellCoord(float v) const;
+  void link(int id);
+  void unlink(int id);
+  void growExtent(const Physics::AABB &box);
+  void nextStamp();
+  bool visit(int id);
+  template <typename Fn> void forEachCandidate(int x0, int y0, int x1, int y1, Fn fn);
+};
+
+#endif // TENSAI_SPATIAL_INDEX_H
@@ -0,0 +1,230 @@
+#include "texture_residency.h"
+#include "graphics.h"
+#include <SDL2/SDL_image.h>
+#include <algorithm>
+#include <cstdio>
+
+namespace {
+
+inline uint8_t mulDiv255(uint32_t value, uint32_t alpha) {
+  uint32_t x = value * alpha + 128;
+  return (uint8_t)((x + (x >> 8)) >> 8);
+}
+
+} // namespace
+
+TextureResidency::TextureResidency(const Assets &assets, Graphics &graphics,
+                                   SDL_Renderer *renderer, const Color &placeholder)
+    : assets(assets), graphics(graphics), renderer(renderer) {
+  setPlaceholder(placeholder);
+  worker = std::thread(&TextureResidency::run, this);
+}
+
+TextureResidency::~TextureResidency() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  wake.notify_one();
+  if (worker.joinable())
+    worker.join();
+  for (auto &entry : loaded) {
+    if (entry.second)
+      SDL_FreeSurface(entry.second);
+  }
+}
+
+void TextureResidency::track(const std::shared_ptr<Texture> &texture) {
+  if (texture && !texture->source.empty())
+    tracked.push_back(texture);
+}
+
+void TextureResidency::setPlaceholder(const Color &color) {
+  uint8_t rgba[4] = {color.r, color.g, color.b, color.a};
+  auto next = std::make_shared<Texture>();
+  next->width = 1;
+  next->height = 1;
+  graphics.runOnRenderer([&] {
+    next->texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA32,
+                                      SDL_TEXTUREACCESS_STATIC, 1, 1);
+    if (next->texture) {
+      SDL_UpdateTexture(next->texture, nullptr, rgba, 4);
+      SDL_SetTextureBlendMode(next->texture, SDL_BLENDMODE_BLEND);
+    }
+  });
+  if (!next->texture) {
+    fprintf(stderr, "Warning: Error creating texture placeholder: %s\n", SDL_GetError());
+    return;
+  }
+  if (graphics.isSoftware())
+    next->mirror(rgba, 4, SDL_PIXELFORMAT_RGBA32);
+  graphics.retire(std::move(placeholder));
+  placeholder = std::move(next);
+}
+
+std::shared_ptr<Texture> TextureResidency::use(const std::shared_ptr<Texture> &texture) {
+  texture->lastUsed = frame;
+  if (texture->texture || texture->source.empty())
+    return texture;
+  if (pending.insert(texture.get()).second) {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      queue.push_back(texture);
+    }
+    wake.notify_one();
+  }
+  return placeholder;
+}
+
+void TextureResidency::endFrame() {
+  upload();
+  evict();
+  frame++;
+}
+
+TextureResidency::Stats TextureResidency::getStats() const {
+  Stats stats = last;
+  stats.pending = (int)pending.size();
+  stats.evictions = evictions;
+  stats.reloads = reloads;
+  stats.failures = failures;
+  return stats;
+}
+
+void TextureResidency::upload() {
+  std::vector<std::pair<std::shared_ptr<Texture>, SDL_Surface *>> done;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    done.swap(loaded);
+  }
+  if (done.empty())
+    return;
+
+  graphics.runOnRenderer([&] {
+    for (auto &entry : done) {
+      Texture &texture = *entry.first;
+      // Skip textures unloaded while their reload was in flight.
+      if (!entry.second || texture.texture || entry.first.use_count() == 1)
+        continue;
+      size_t before = texture.bytes();
+      texture.texture = SDL_CreateTextureFromSurface(renderer, entry.second);
+      if (!texture.texture)
+        continue;
+      if (texture.premultiplied)
+        SDL_SetTextureBlendMode(texture.texture, Texture::premultipliedBlendMode());
+      if (graphics.isSoftware())
+        texture.mirror(entry.second);
+      if (sizeChange)
+        sizeChange(texture, before, texture.bytes());
+    }
+  });
+
+  for (auto &entry : done) {
+    Texture &texture = *entry.first;
+    pending.erase(&texture);
+    if (texture.texture) {
+      // A fresh SDL texture starts with no color or alpha mod.
+      texture.mod = Color(255, 255, 255, 255);
+      texture.lastUsed = frame;
+      reloads++;
+    } else if (entry.first.use_count() > 1) {
+      // Stop retrying a source that no longer loads; the texture draws
+      // nothing from here on.
+      fprintf(stderr, "Warning: Error reloading texture: %s\n", texture.source.c_str());
+      texture.source.clear();
+      failures++;
+    }
+    if (entry.second)
+      SDL_FreeSurface(entry.second);
+  }
+}
+
+void TextureResidency::evict() {
+  tracked.erase(std::remove_if(tracked.begin(), tracked.end(),
+                               [](const std::weak_ptr<Texture> &texture) {
+                                 return texture.expired();
+                               }),
+                tracked.end());
+
+  // Sizes come from SDL_QueryTexture, so the whole pass runs where renderer
+  // calls are allowed.
+  graphics.runOnRenderer([&] {
+    std::vector<std::pair<std::shared_ptr<Texture>, size_t>> resident;
+    size_t total = 0;
+    for (const auto &weak : tracked) {
+      auto texture = weak.lock();
+      if (texture && texture->texture) {
+        size_t bytes = texture->bytes();
+        total += bytes;
+        resident.emplace_back(std::move(texture), bytes);
+      }
+    }
+
+    if (budget > 0 && total > budget) {
+      std::sort(resident.begin(), resident.end(), [](const auto &a, const auto &b) {
+        return a.first->lastUsed < b.first->lastUsed;
+      });
+      size_t evicted = 0;
+      for (auto &entry : resident) {
+        if (total <= budget || entry.first->lastUsed >= frame)
+          break;
+        Texture &texture = *entry.first;
+        SDL_DestroyTexture(texture.texture);
+        texture.texture = nullptr;
+        std::vector<uint32_t>().swap(texture.pixels);
+        if (sizeChange)
+          sizeChange(texture, entry.second, texture.bytes());
+        total -= entry.second;
+        evicted++;
+      }
+      evictions += evicted;
+      resident.erase(resident.begin(), resident.begin() + evicted);
+    }
+
+    last.tracked = (int)tracked.size();
+    last.resident = (int)resident.size();
+    last.residentBytes = total;
+  });
+}
+
+SDL_Surface *TextureResidency::decode(const Texture &texture) const {
+  SDL_RWops *rw = assets.open(texture.source);
+  SDL_Surface *surface = rw ? IMG_Load_RW(rw, 1) : nullptr;
+  if (!surface || !texture.premultiplied)
+    return surface;
+
+  if (surface->format->format != SDL_PIXELFORMAT_RGBA32) {
+    SDL_Surface *converted = SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_RGBA32, 0);
+    SDL_FreeSurface(surface);
+    if (!converted)
+      return nullptr;
+    surface = converted;
+  }
+  SDL_LockSurface(surface);
+  for (int y = 0; y < surface->h; y++) {
+    uint8_t *p = (uint8_t *)surface->pixels + (size_t)y * surface->pitch;
+    for (int x = 0; x < surface->w; x++, p += 4) {
+      p[0] = mulDiv255(p[0], p[3]);
+      p[1] = mulDiv255(p[1], p[3]);
+      p[2] = mulDiv255(p[2], p[3]);
+    }
+  }
+  SDL_UnlockSurface(surface);
+  return surface;
+}
+
+void TextureResidency::run() {
+  std::unique_lock<std::mutex> lock(mutex);
+  while (true) {
+    wake.wait(lock, [this] { return stopping || !queue.empty(); });
+    if (stopping)
+      return;
+    std::shared_ptr<Texture> texture = std::move(queue.front());
+    queue.pop_front();
+
+    lock.unlock();
+    SDL_Surface *surface = decode(*texture);
+    lock.lock();
+    loaded.emplace_back(std::move(texture), surface);
+  }
+}
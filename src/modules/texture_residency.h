@@ -0,0 +1,96 @@
+#ifndef TENSAI_TEXTURE_RESIDENCY_H
+#define TENSAI_TEXTURE_RESIDENCY_H
+
+#include "../core/color.h"
+#include "../resources/texture.h"
+#include "assets.h"
+#include <SDL2/SDL.h>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+class Graphics;
+
+// Keeps the textures that were loaded from an asset within a byte budget.
+// Once per frame the least recently drawn ones are evicted: their GPU
+// texture and CPU copy are released but the Texture object, and so every
+// handle to it, survives with only its source path. Drawing an evicted
+// texture draws a placeholder instead and queues a reload; the file is read
+// and decoded on a background thread and uploaded at the next frame end.
+class TextureResidency {
+public:
+  struct Stats {
+    int tracked = 0;
+    int resident = 0;
+    size_t residentBytes = 0;
+    int pending = 0;
+    uint64_t evictions = 0;
+    uint64_t reloads = 0;
+    uint64_t failures = 0;
+  };
+
+  TextureResidency(const Assets &assets, Graphics &graphics, SDL_Renderer *renderer,
+                   const Color &placeholder = Color(128, 128, 128, 255));
+  ~TextureResidency();
+
+  // Only textures with a source are tracked; canvases and generated
+  // textures stay resident.
+  void track(const std::shared_ptr<Texture> &texture);
+  // 0 disables eviction.
+  void setBudget(size_t bytes) { budget = bytes; }
+  size_t getBudget() const { return budget; }
+  // Color the placeholder is drawn with while a texture reloads.
+  void setPlaceholder(const Color &color);
+  // Called with the bytes a texture gave up and took on whenever an eviction
+  // or reload changes its size, on the renderer's thread while the caller of
+  // endFrame waits.
+  using SizeChange = std::function<void(const Texture &texture, size_t removed, size_t added)>;
+  void setSizeChange(SizeChange callback) { sizeChange = std::move(callback); }
+
+  // Marks the texture drawn this frame and returns what to draw: the
+  // texture itself, or the placeholder while it is evicted.
+  std::shared_ptr<Texture> use(const std::shared_ptr<Texture> &texture);
+  // Called after each present: uploads finished reloads, then evicts down
+  // to the budget, never touching a texture drawn in the frame just ended.
+  void endFrame();
+
+  Stats getStats() const;
+
+private:
+  const Assets &assets;
+  Graphics &graphics;
+  SDL_Renderer *renderer;
+  size_t budget = 0;
+  uint64_t frame = 1;
+  std::shared_ptr<Texture> placeholder;
+  std::vector<std::weak_ptr<Texture>> tracked;
+  std::unordered_set<const Texture *> pending;
+  SizeChange sizeChange;
+  uint64_t evictions = 0;
+  uint64_t reloads = 0;
+  uint64_t failures = 0;
+  // Counts from the last eviction pass.
+  Stats last;
+
+  // Reload worker; surfaces are null when the source failed to decode.
+  std::thread worker;
+  std::mutex mutex;
+  std::condition_variable wake;
+  std::deque<std::shared_ptr<Texture>> queue;
+  std::vector<std::pair<std::shared_ptr<Texture>, SDL_Surface *>> loaded;
+  bool stopping = false;
+
+  void run();
+  SDL_Surface *decode(const Texture &texture) const;
+  void upload();
+  void evict();
+};
+
+#endif // TENSAI_TEXTURE_RESIDENCY_H
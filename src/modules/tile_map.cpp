@@ -0,0 +1,218 @@
+#include "tile_map.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+const float InverseSqrt2 = 0.70710678f;
+// Fraction of a tile a box may sit below a slope surface and still land on
+// it, absorbing rounding left over from settleOnSlope.
+const float SlopeTolerance = 1e-3f;
+
+// Closest blocking surface found so far during a sweep; ties keep every
+// contact at that distance so a box landing across two tiles reports both.
+struct Sweep {
+  float allowed;
+  std::vector<TileMap::Contact> contacts;
+
+  void offer(float distance, const Vec2 &normal, int tx, int ty) {
+    if (std::fabs(distance) < std::fabs(allowed)) {
+      allowed = distance;
+      contacts.clear();
+    }
+    if (distance == allowed)
+      contacts.push_back({normal, tx, ty});
+  }
+};
+
+// floor/ceil of a tile coordinate, clamped before the int conversion so a
+// huge move never walks millions of off-map tiles or overflows. Tiles off
+// the map are empty, so the clamp never changes a result.
+int floorCell(float v, int lo, int hi) {
+  return (int)std::max((float)lo, std::min((float)hi, std::floor(v)));
+}
+
+int ceilCell(float v, int lo, int hi) {
+  return (int)std::max((float)lo, std::min((float)hi, std::ceil(v)));
+}
+
+} // namespace
+
+TileMap::TileMap(int width, int height, float tileSize, const Vec2 &origin)
+    : width(std::max(0, width)), height(std::max(0, height)),
+      tileSize(tileSize > 0.0f ? tileSize : 1.0f),
+      inverseTileSize(1.0f / this->tileSize), origin(origin),
+      tiles((size_t)this->width * this->height, Empty) {}
+
+uint8_t TileMap::getTile(int x, int y) const {
+  if (x < 0 || y < 0 || x >= width || y >= height)
+    return Empty;
+  return tiles[(size_t)y * width + x];
+}
+
+void TileMap::setTile(int x, int y, uint8_t tile) {
+  if (x < 0 || y < 0 || x >= width || y >= height)
+    return;
+  tiles[(size_t)y * width + x] = tile;
+}
+
+void TileMap::setTiles(const uint8_t *data, size_t count) {
+  std::copy(data, data + std::min(count, tiles.size()), tiles.begin());
+}
+
+float TileMap::slopeFloor(int tx, int ty, uint8_t tile, float x) const {
+  float left = origin.x + tx * tileSize;
+  float t = std::max(0.0f, std::min(1.0f, (x - left) * inverseTileSize));
+  float top = origin.y + ty * tileSize;
+  return top + (tile == SlopeUp ? 1.0f - t : t) * tileSize;
+}
+
+Vec2 TileMap::slopeNormal(uint8_t tile) const {
+  return tile == SlopeUp ? Vec2(-InverseSqrt2, -InverseSqrt2)
+                         : Vec2(InverseSqrt2, -InverseSqrt2);
+}
+
+bool TileMap::blocksSideways(int tx, int ty) const {
+  // A solid directly under a slope is the slope's base; boxes climb the
+  // slope surface rather than stopping at its corner.
+  return getTile(tx, ty) == Solid && !isSlope(getTile(tx, ty - 1));
+}
+
+float TileMap::sweepX(const Physics::AABB &box, float dx, MoveResult &result) const {
+  if (dx == 0.0f)
+    return 0.0f;
+  int rowBegin = floorCell((box.min.y - origin.y) * inverseTileSize, -1, height + 1);
+  int rowEnd = ceilCell((box.max.y - origin.y) * inverseTileSize, -1, height + 1);
+  Sweep sweep{dx, {}};
+
+  if (dx > 0) {
+    float lead = box.max.x - origin.x;
+    int first = ceilCell(lead * inverseTileSize, -1, width + 1);
+    int last = ceilCell((lead + dx) * inverseTileSize, -1, width + 1) - 1;
+    for (int tx = first; tx <= last && sweep.contacts.empty(); tx++) {
+      for (int ty = rowBegin; ty < rowEnd; ty++) {
+        if (blocksSideways(tx, ty))
+          sweep.offer(tx * tileSize - lead, Vec2(-1, 0), tx, ty);
+      }
+    }
+  } else {
+    float lead = box.min.x - origin.x;
+    int first = floorCell(lead * inverseTileSize, -1, width + 1) - 1;
+    int last = floorCell((lead + dx) * inverseTileSize, -1, width + 1);
+    for (int tx = first; tx >= last && sweep.contacts.empty(); tx--) {
+      for (int ty = rowBegin; ty < rowEnd; ty++) {
+        if (blocksSideways(tx, ty))
+          sweep.offer((tx + 1) * tileSize - lead, Vec2(1, 0), tx, ty);
+      }
+    }
+  }
+
+  result.contacts.insert(result.contacts.end(), sweep.contacts.begin(),
+                         sweep.contacts.end());
+  return sweep.allowed;
+}
+
+float TileMap::sweepY(const Physics::AABB &box, float dy, MoveResult &result) const {
+  if (dy == 0.0f)
+    return 0.0f;
+  int columnBegin = floorCell((box.min.x - origin.x) * inverseTileSize, -1, width + 1);
+  int columnEnd = ceilCell((box.max.x - origin.x) * inverseTileSize, -1, width + 1);
+  Sweep sweep{dy, {}};
+
+  if (dy > 0) {
+    float lead = box.max.y - origin.y;
+    float centerX = (box.min.x + box.max.x) * 0.5f;
+    int centerColumn = floorCell((centerX - origin.x) * inverseTileSize, -1, width + 1);
+    int current = floorCell(lead * inverseTileSize, -1, height + 1);
+    int first = ceilCell(lead * inverseTileSize, -1, height + 1);
+    int last = ceilCell((lead + dy) * inverseTileSize, -1, height + 1) - 1;
+    // The row the bottom edge is already in can still hold a slope below it.
+    for (int ty = std::min(current, first); ty <= last && sweep.contacts.empty(); ty++) {
+      for (int tx = columnBegin; tx < columnEnd; tx++) {
+        uint8_t tile = getTile(tx, ty);
+        if (isSlope(tile)) {
+          if (tx != centerColumn)
+            continue;
+          float floorY = slopeFloor(tx, ty, tile, centerX) - origin.y;
+          if (floorY >= lead - SlopeTolerance * tileSize && floorY <= lead + dy)
+            sweep.offer(floorY - lead, slopeNormal(tile), tx, ty);
+        } else if (ty >= first && (tile == Solid || tile == OneWay)) {
+          sweep.offer(ty * tileSize - lead, Vec2(0, -1), tx, ty);
+        }
+      }
+    }
+  } else {
+    float lead = box.min.y - origin.y;
+    int first = floorCell(lead * inverseTileSize, -1, height + 1) - 1;
+    int last = floorCell((lead + dy) * inverseTileSize, -1, height + 1);
+    for (int ty = first; ty >= last && sweep.contacts.empty(); ty--) {
+      for (int tx = columnBegin; tx < columnEnd; tx++) {
+        if (getTile(tx, ty) == Solid)
+          sweep.offer((ty + 1) * tileSize - lead, Vec2(0, 1), tx, ty);
+      }
+    }
+  }
+
+  result.contacts.insert(result.contacts.end(), sweep.contacts.begin(),
+                         sweep.contacts.end());
+  return sweep.allowed;
+}
+
+void TileMap::settleOnSlope(Physics::AABB &box, MoveResult &result) const {
+  // Walking into a slope leaves the bottom-center below its surface; lift the
+  // box back onto it before the vertical sweep.
+  float centerX = (box.min.x + box.max.x) * 0.5f;
+  int tx = floorCell((centerX - origin.x) * inverseTileSize, -1, width + 1);
+  int ty = ceilCell((box.max.y - origin.y) * inverseTileSize, -1, height + 1) - 1;
+  uint8_t tile = getTile(tx, ty);
+  if (!isSlope(tile) && isSlope(getTile(tx, ty - 1)))
+    tile = getTile(tx, --ty);
+  if (!isSlope(tile))
+    return;
+  float floorY = slopeFloor(tx, ty, tile, centerX);
+  if (box.max.y <= floorY)
+    return;
+  float lift = box.max.y - floorY;
+  box.min.y -= lift;
+  box.max.y -= lift;
+  result.delta.y -= lift;
+  result.contacts.push_back({slopeNormal(tile), tx, ty});
+}
+
+TileMap::MoveResult TileMap::moveAndCollide(Physics::AABB &box,
+                                            const Vec2 &delta) const {
+  MoveResult result;
+  if (!std::isfinite(delta.x) || !std::isfinite(delta.y))
+    return result;
+
+  float dx = sweepX(box, delta.x, result);
+  box.min.x += dx;
+  box.max.x += dx;
+  result.delta.x = dx;
+
+  settleOnSlope(box, result);
+
+  float dy = sweepY(box, delta.y, result);
+  box.min.y += dy;
+  box.max.y += dy;
+  result.delta.y += dy;
+
+  for (const Contact &contact : result.contacts) {
+    if (contact.normal.y < 0.0f)
+      result.grounded = true;
+  }
+  return result;
+}
+
+TileMap::MoveResult TileMap::moveAndCollide(Physics::Body &body, const Vec2 &size,
+                                            float dt) const {
+  Physics::AABB box = {body.position, body.position + size};
+  MoveResult result = moveAndCollide(box, body.velocity * dt);
+  body.position = box.min;
+  for (const Contact &contact : result.contacts) {
+    float into = body.velocity.dot(contact.normal);
+    if (into < 0.0f)
+      body.velocity = body.velocity - contact.normal * into;
+  }
+  return result;
+}
@@ -0,0 +1,74 @@
+#ifndef TENSAI_TILE_MAP_H
+#define TENSAI_TILE_MAP_H
+
+#include "../core/vec2.h"
+#include "physics.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Fixed grid of collision tiles for character controllers. Moves are swept
+// one axis at a time against only the tiles the box passes through, so a
+// fast fall cannot skip a thin floor and cost is O(tiles touched).
+class TileMap {
+public:
+  enum Tile : uint8_t {
+    Empty = 0,
+    Solid = 1,
+    // Blocks only downward motion entering the tile from above.
+    OneWay = 2,
+    // Floor rising to the right ("/") or falling to the right ("\"). Slopes
+    // support the bottom-center of a box and never block sideways.
+    SlopeUp = 3,
+    SlopeDown = 4,
+  };
+
+  struct Contact {
+    Vec2 normal;
+    int tileX, tileY;
+  };
+
+  struct MoveResult {
+    Vec2 delta;
+    bool grounded = false;
+    std::vector<Contact> contacts;
+  };
+
+  TileMap(int width, int height, float tileSize, const Vec2 &origin = Vec2(0, 0));
+
+  int getWidth() const { return width; }
+  int getHeight() const { return height; }
+  float getTileSize() const { return tileSize; }
+
+  // Tiles outside the map read as Empty.
+  uint8_t getTile(int x, int y) const;
+  void setTile(int x, int y, uint8_t tile);
+  // Row-major, width * height entries; shorter input leaves the rest as is.
+  void setTiles(const uint8_t *data, size_t count);
+
+  // Moves `box` by up to `delta` (x first, then onto any slope underfoot,
+  // then y) and reports the surfaces that stopped it.
+  MoveResult moveAndCollide(Physics::AABB &box, const Vec2 &delta) const;
+  // Body variant: position is the box's top-left corner. Velocity loses its
+  // component into every contact normal.
+  MoveResult moveAndCollide(Physics::Body &body, const Vec2 &size, float dt) const;
+
+private:
+  int width, height;
+  float tileSize;
+  float inverseTileSize;
+  Vec2 origin;
+  std::vector<uint8_t> tiles;
+
+  bool isSlope(uint8_t tile) const { return tile == SlopeUp || tile == SlopeDown; }
+  // Floor height of a slope tile at world x, in world coordinates.
+  float slopeFloor(int tx, int ty, uint8_t tile, float x) const;
+  Vec2 slopeNormal(uint8_t tile) const;
+  bool blocksSideways(int tx, int ty) const;
+
+  float sweepX(const Physics::AABB &box, float dx, MoveResult &result) const;
+  float sweepY(const Physics::AABB &box, float dy, MoveResult &result) const;
+  void settleOnSlope(Physics::AABB &box, MoveResult &result) const;
+};
+
+#endif // TENSAI_TILE_MAP_H
@@ -6,11 +6,41 @@ Timer::Timer()
 
 void Timer::update() {
   auto currentTime = std::chrono::high_resolution_clock::now();
-  deltaTime = std::chrono::duration<double>(currentTime - lastFrame).count();
-  totalTime = std::chrono::duration<double>(currentTime - startTime).count();
+  double realDelta = std::chrono::duration<double>(currentTime - lastFrame).count();
+  if (fixedStep > 0.0) {
+    deltaTime = fixedStep;
+    totalTime += fixedStep;
+  } else {
+    deltaTime = realDelta;
+    totalTime = std::chrono::duration<double>(currentTime - startTime).count();
+  }
   lastFrame = currentTime;
   frameCount++;
 
+  // FPS always measures wall time, so fixed-step runs still report speed.
+  fpsUpdateTime += realDelta;
+  if (fpsUpdateTime >= 1.0) {
+    fps = frameCount / fpsUpdateTime;
+    frameCount = 0;
+    fpsUpdateTime = 0.0;
+  }
+}
+
+void Timer::setFixedStep(double seconds) {
+  fixedStep = seconds > 0.0 ? seconds : 0.0;
+  // Resume the real clock from the virtual time reached so far.
+  if (fixedStep == 0.0) {
+    startTime = std::chrono::high_resolution_clock::now() -
+                std::chrono::duration_cast<std::chrono::high_resolution_clock::duration>(
+                    std::chrono::duration<double>(totalTime));
+  }
+}
+
+void Timer::advance(double seconds) {
+  deltaTime = seconds;
+  totalTime += seconds;
+  frameCount++;
+
   fpsUpdateTime += deltaTime;
   if (fpsUpdateTime >= 1.0) {
     fps = frameCount / fpsUpdateTime;
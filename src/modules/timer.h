@@ -13,11 +13,19 @@ private:
   int frameCount = 0;
   double fps = 0.0;
   double fpsUpdateTime = 0.0;
+  double fixedStep = 0.0;
 
 public:
   Timer();
 
   void update();
+  // With a fixed step, update() advances virtual time by exactly that much
+  // per frame regardless of wall time; 0 returns to the real clock.
+  void setFixedStep(double seconds);
+  double getFixedStep() const { return fixedStep; }
+  // Moves the clock forward by a fixed amount instead of reading wall time,
+  // for simulations stepped faster or slower than real time.
+  void advance(double seconds);
 
   double getDelta() const;
   double getTime() const;
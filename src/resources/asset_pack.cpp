@@ -0,0 +1,219 @@
+#include "asset_pack.h"
+#include <cstdio>
+#include <cstring>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+template <typename T> T readLE(const uint8_t *p) {
+  T value = 0;
+  for (size_t i = 0; i < sizeof(T); i++)
+    value |= (T)p[i] << (8 * i);
+  return value;
+}
+
+// LZ4 block format decoder; returns false on malformed input.
+bool lz4Decompress(const uint8_t *src, size_t srcSize, uint8_t *dst,
+                   size_t dstSize) {
+  const uint8_t *ip = src;
+  const uint8_t *iend = src + srcSize;
+  uint8_t *op = dst;
+  uint8_t *oend = dst + dstSize;
+
+  while (ip < iend) {
+    uint8_t token = *ip++;
+    size_t literals = token >> 4;
+    if (literals == 15) {
+      uint8_t b;
+      do {
+        if (ip >= iend)
+          return false;
+        b = *ip++;
+        literals += b;
+      } while (b == 255);
+    }
+    if ((size_t)(iend - ip) < literals || (size_t)(oend - op) < literals)
+      return false;
+    memcpy(op, ip, literals);
+    ip += literals;
+    op += literals;
+    if (ip >= iend)
+      break;
+
+    if (iend - ip < 2)
+      return false;
+    size_t offset = ip[0] | (ip[1] << 8);
+    ip += 2;
+    if (offset == 0 || offset > (size_t)(op - dst))
+      return false;
+    size_t matchLength = token & 15;
+    if (matchLength == 15) {
+      uint8_t b;
+      do {
+        if (ip >= iend)
+          return false;
+        b = *ip++;
+        matchLength += b;
+      } while (b == 255);
+    }
+    matchLength += 4;
+    if ((size_t)(oend - op) < matchLength)
+      return false;
+    const uint8_t *match = op - offset;
+    while (matchLength--)
+      *op++ = *match++;
+  }
+  return op == oend;
+}
+
+} // namespace
+
+AssetPack::AssetPack(const std::string &path) {
+  if (!map(path)) {
+    fprintf(stderr, "Warning: Error mapping asset pack: %s\n", path.c_str());
+    return;
+  }
+  if (!readIndex()) {
+    fprintf(stderr, "Warning: Invalid asset pack: %s\n", path.c_str());
+    entries.clear();
+    unmap();
+  }
+}
+
+AssetPack::~AssetPack() { unmap(); }
+
+bool AssetPack::isOpen() const { return data != nullptr; }
+
+bool AssetPack::contains(const std::string &name) const {
+  return entries.count(name) != 0;
+}
+
+SDL_RWops *AssetPack::open(const std::string &name) {
+  auto it = entries.find(name);
+  if (it == entries.end())
+    return nullptr;
+  const Entry &entry = it->second;
+  if (!(entry.flags & FlagLZ4))
+    return SDL_RWFromConstMem(data + entry.offset, (int)entry.size);
+
+  std::lock_guard<std::mutex> lock(inflateMutex);
+  auto cached = inflated.find(name);
+  if (cached == inflated.end()) {
+    std::vector<uint8_t> buffer(entry.rawSize);
+    if (!lz4Decompress(data + entry.offset, entry.size, buffer.data(),
+                       buffer.size())) {
+      fprintf(stderr, "Warning: Corrupt asset pack entry: %s\n", name.c_str());
+      return nullptr;
+    }
+    cached = inflated.emplace(name, std::move(buffer)).first;
+  }
+  return SDL_RWFromConstMem(cached->second.data(), (int)cached->second.size());
+}
+
+bool AssetPack::readIndex() {
+  if (length < 32 || memcmp(data, "TPAK", 4) != 0 ||
+      readLE<uint32_t>(data + 4) != Version)
+    return false;
+  uint32_t count = readLE<uint32_t>(data + 8);
+  uint64_t indexOffset = readLE<uint64_t>(data + 12);
+  uint64_t indexSize = readLE<uint64_t>(data + 20);
+  if (indexOffset > length || indexSize > length - indexOffset)
+    return false;
+
+  const uint8_t *p = data + indexOffset;
+  const uint8_t *end = p + indexSize;
+  for (uint32_t i = 0; i < count; i++) {
+    if (end - p < 32)
+      return false;
+    Entry entry;
+    entry.offset = readLE<uint64_t>(p);
+    entry.size = readLE<uint64_t>(p + 8);
+    entry.rawSize = readLE<uint64_t>(p + 16);
+    entry.flags = readLE<uint32_t>(p + 24);
+    uint32_t nameLength = readLE<uint32_t>(p + 28);
+    p += 32;
+    if ((uint64_t)(end - p) < nameLength || entry.offset > length ||
+        entry.size > length - entry.offset)
+      return false;
+    entries[std::string((const char *)p, nameLength)] = entry;
+    p += nameLength;
+  }
+  return true;
+}
+
+#ifdef _WIN32
+bool AssetPack::map(const std::string &path) {
+  file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                     OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    file = nullptr;
+    return false;
+  }
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+    unmap();
+    return false;
+  }
+  mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (!mapping) {
+    unmap();
+    return false;
+  }
+  data = (const uint8_t *)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  if (!data) {
+    unmap();
+    return false;
+  }
+  length = (size_t)size.QuadPart;
+  return true;
+}
+
+void AssetPack::unmap() {
+  if (data)
+    UnmapViewOfFile(data);
+  if (mapping)
+    CloseHandle(mapping);
+  if (file)
+    CloseHandle(file);
+  data = nullptr;
+  mapping = file = nullptr;
+  length = 0;
+}
+#else
+bool AssetPack::map(const std::string &path) {
+  fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0)
+    return false;
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size == 0) {
+    unmap();
+    return false;
+  }
+  void *mapped = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (mapped == MAP_FAILED) {
+    unmap();
+    return false;
+  }
+  data = (const uint8_t *)mapped;
+  length = (size_t)st.st_size;
+  return true;
+}
+
+void AssetPack::unmap() {
+  if (data)
+    munmap((void *)data, length);
+  if (fd >= 0)
+    close(fd);
+  data = nullptr;
+  length = 0;
+  fd = -1;
+}
+#endif
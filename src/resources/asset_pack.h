@@ -0,0 +1,62 @@
+#ifndef TENSAI_ASSET_PACK_H
+#define TENSAI_ASSET_PACK_H
+
+#include <SDL2/SDL.h>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Read-only view of a .tpak archive built by tools/pack.js.
+//
+// Layout (little-endian):
+//   header  "TPAK" u32 version, u32 entryCount, u64 indexOffset, u64 indexSize,
+//           padded to 32 bytes
+//   data    entries, each starting on a 16-byte boundary
+//   index   per entry: u64 offset, u64 size, u64 rawSize, u32 flags,
+//           u32 nameLength, name bytes
+//
+// The file is memory-mapped; uncompressed entries are handed to SDL straight
+// from the mapping. Entries flagged LZ4 are decompressed once on first open
+// and kept for the lifetime of the pack.
+class AssetPack {
+public:
+  static constexpr uint32_t Version = 1;
+  static constexpr uint32_t FlagLZ4 = 1;
+
+  explicit AssetPack(const std::string &path);
+  ~AssetPack();
+  AssetPack(const AssetPack &) = delete;
+  AssetPack &operator=(const AssetPack &) = delete;
+
+  bool isOpen() const;
+  bool contains(const std::string &name) const;
+  SDL_RWops *open(const std::string &name);
+
+private:
+  struct Entry {
+    uint64_t offset;
+    uint64_t size;
+    uint64_t rawSize;
+    uint32_t flags;
+  };
+
+  const uint8_t *data = nullptr;
+  size_t length = 0;
+#ifdef _WIN32
+  void *file = nullptr;
+  void *mapping = nullptr;
+#else
+  int fd = -1;
+#endif
+  std::unordered_map<std::string, Entry> entries;
+  std::unordered_map<std::string, std::vector<uint8_t>> inflated;
+  std::mutex inflateMutex;
+
+  bool map(const std::string &path);
+  void unmap();
+  bool readIndex();
+};
+
+#endif // TENSAI_ASSET_PACK_H
@@ -1,12 +1,27 @@
 #include "font.h"
 #include <cstdio>
 #include <cstdlib>
+#include <filesystem>
 
 Font::Font(const std::string &path, int size) : size(size) {
   font = TTF_OpenFont(path.c_str(), size);
   if (!font) {
     fprintf(stderr, "Warning: Error loading font: %s\n", path.c_str());
+    return;
   }
+  std::error_code error;
+  auto length = std::filesystem::file_size(path, error);
+  sourceBytes = error ? 0 : (size_t)length;
+}
+
+Font::Font(SDL_RWops *rw, int size) : size(size) {
+  Sint64 length = rw ? SDL_RWsize(rw) : -1;
+  font = rw ? TTF_OpenFontRW(rw, 1, size) : nullptr;
+  if (!font) {
+    fprintf(stderr, "Warning: Error loading font: %s\n", SDL_GetError());
+    return;
+  }
+  sourceBytes = length > 0 ? (size_t)length : 0;
 }
 
 Font::~Font() {
@@ -9,7 +9,15 @@ public:
   TTF_Font *font = nullptr;
   int size;
   Font(const std::string &path, int size);
+  // Takes ownership of rw; its memory must outlive the font.
+  Font(SDL_RWops *rw, int size);
   ~Font();
+
+  // Size of the source data the font streams from.
+  size_t bytes() const { return sourceBytes; }
+
+private:
+  size_t sourceBytes = 0;
 };
 
 #endif // TENSAI_FONT_H
\ No newline at end of file
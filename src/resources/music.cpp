@@ -1,12 +1,27 @@
 #include "music.h"
 #include <cstdio>
 #include <cstdlib>
+#include <filesystem>
 
 Music::Music(const std::string &path) {
   music = Mix_LoadMUS(path.c_str());
   if (!music) {
     fprintf(stderr, "Warning: Error loading music: %s\n", Mix_GetError());
+    return;
   }
+  std::error_code error;
+  auto length = std::filesystem::file_size(path, error);
+  sourceBytes = error ? 0 : (size_t)length;
+}
+
+Music::Music(SDL_RWops *rw) {
+  Sint64 length = rw ? SDL_RWsize(rw) : -1;
+  music = rw ? Mix_LoadMUS_RW(rw, 1) : nullptr;
+  if (!music) {
+    fprintf(stderr, "Warning: Error loading music: %s\n", Mix_GetError());
+    return;
+  }
+  sourceBytes = length > 0 ? (size_t)length : 0;
 }
 
 Music::~Music() {
@@ -8,7 +8,15 @@ class Music {
 public:
   Mix_Music *music = nullptr;
   Music(const std::string &path);
+  // Takes ownership of rw; its memory must outlive the music.
+  explicit Music(SDL_RWops *rw);
   ~Music();
+
+  // Size of the source data the music streams from.
+  size_t bytes() const { return sourceBytes; }
+
+private:
+  size_t sourceBytes = 0;
 };
 
 #endif // TENSAI_MUSIC_H
\ No newline at end of file
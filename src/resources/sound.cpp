@@ -2,8 +2,11 @@
 #include <cstdio>
 #include <cstdlib>
 
-Sound::Sound(const std::string &path) {
-  chunk = Mix_LoadWAV(path.c_str());
+Sound::Sound(const std::string &path)
+    : Sound(SDL_RWFromFile(path.c_str(), "rb")) {}
+
+Sound::Sound(SDL_RWops *rw) {
+  chunk = rw ? Mix_LoadWAV_RW(rw, 1) : nullptr;
   if (!chunk) {
     fprintf(stderr, "Warning: Error loading sound WAV: %s\n", Mix_GetError());
   }
@@ -13,3 +16,5 @@ Sound::~Sound() {
   if (chunk)
     Mix_FreeChunk(chunk);
 }
+
+size_t Sound::bytes() const { return chunk ? chunk->alen : 0; }
@@ -7,8 +7,15 @@
 class Sound {
 public:
   Mix_Chunk *chunk = nullptr;
+  std::string bank;
+  int priority = 0;
+  int maxInstances = 0;
   Sound(const std::string &path);
+  // Takes ownership of rw.
+  explicit Sound(SDL_RWops *rw);
   ~Sound();
+
+  size_t bytes() const;
 };
 
 #endif // TENSAI_SOUND_H
\ No newline at end of file
@@ -1,6 +1,47 @@
 #include "texture.h"
+#include <atomic>
+#include <cstdio>
 
 Texture::~Texture() {
   if (texture)
     SDL_DestroyTexture(texture);
-}
\ No newline at end of file
+}
+bool Texture::mirror(const void *data, int pitch, Uint32 format) {
+  pixels.resize((size_t)width * height);
+  if (SDL_ConvertPixels(width, height, format, data, pitch, SDL_PIXELFORMAT_ARGB8888,
+                        pixels.data(), width * 4) != 0) {
+    fprintf(stderr, "Warning: Error copying texture pixels: %s\n", SDL_GetError());
+    pixels.clear();
+    return false;
+  }
+  return true;
+}
+
+bool Texture::mirror(SDL_Surface *surface) {
+  SDL_LockSurface(surface);
+  bool ok = mirror(surface->pixels, surface->pitch, surface->format->format);
+  SDL_UnlockSurface(surface);
+  return ok;
+}
+
+size_t Texture::bytes() const {
+  size_t total = pixels.size() * sizeof(uint32_t);
+  Uint32 format = 0;
+  if (texture && SDL_QueryTexture(texture, &format, nullptr, nullptr, nullptr) == 0) {
+    int bpp = SDL_BYTESPERPIXEL(format);
+    total += (size_t)width * height * (bpp > 0 ? bpp : 4);
+  }
+  return total;
+}
+
+SDL_BlendMode Texture::premultipliedBlendMode() {
+  return SDL_ComposeCustomBlendMode(SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA,
+                                    SDL_BLENDOPERATION_ADD, SDL_BLENDFACTOR_ONE,
+                                    SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA,
+                                    SDL_BLENDOPERATION_ADD);
+}
+
+uint64_t Texture::nextId() {
+  static std::atomic<uint64_t> counter{0};
+  return ++counter;
+}
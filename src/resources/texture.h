@@ -1,13 +1,44 @@
 #ifndef TENSAI_TEXTURE_H
 #define TENSAI_TEXTURE_H
 
+#include "../core/color.h"
 #include <SDL2/SDL.h>
+#include <cstdint>
+#include <string>
+#include <vector>
 
 class Texture {
 public:
+  // Creation order, for orderings that must not depend on heap addresses.
+  const uint64_t id = nextId();
   SDL_Texture *texture = nullptr;
   int width = 0, height = 0;
+  bool canvas = false;
+  Color mod{255, 255, 255, 255};
+  // CPU copy of the pixels as ARGB8888, kept only for the software renderer.
+  // Canvases draw into it directly.
+  std::vector<uint32_t> pixels;
+  // The asset the pixels were loaded from, empty for canvases and generated
+  // textures. Lets the residency manager evict and later reload the texture.
+  std::string source;
+  bool premultiplied = false;
+  // Frame number of the last draw, stamped by the residency manager.
+  uint64_t lastUsed = 0;
   ~Texture();
+
+  // Replaces the CPU copy with width x height pixels of `format`.
+  bool mirror(const void *data, int pitch, Uint32 format);
+  bool mirror(SDL_Surface *surface);
+
+  // GPU bytes (dimensions x bytes per pixel of the texture format) plus the
+  // CPU copy, if any.
+  size_t bytes() const;
+
+  // Blend mode for textures whose color is premultiplied by alpha.
+  static SDL_BlendMode premultipliedBlendMode();
+
+private:
+  static uint64_t nextId();
 };
 
 #endif // TENSAI_TEXTURE_H
\ No newline at end of file
@@ -0,0 +1,228 @@
+#include "texture_cache.h"
+#include <SDL2/SDL_image.h>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define TENSAI_SSE2 1
+#endif
+
+namespace {
+
+uint64_t hashBytes(const uint8_t *data, size_t size) {
+  uint64_t hash = 1469598103934665603ull;
+  for (size_t i = 0; i < size; i++) {
+    hash ^= data[i];
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+inline uint8_t mulDiv255(uint32_t value, uint32_t alpha) {
+  uint32_t x = value * alpha + 128;
+  return (uint8_t)((x + (x >> 8)) >> 8);
+}
+
+// RGBA32 (byte order R, G, B, A) to RGBA32 or BGRA32, optionally
+// premultiplying color by alpha.
+void convertPixels(const uint8_t *src, uint8_t *dst, size_t count, bool swapRB,
+                   bool premultiply) {
+  size_t i = 0;
+#ifdef TENSAI_SSE2
+  const __m128i rbMask = _mm_set1_epi32(0x00ff00ff);
+  const __m128i gaMask = _mm_set1_epi32((int)0xff00ff00);
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i bias = _mm_set1_epi16(128);
+  const __m128i colorLanes = _mm_set_epi16(0, -1, -1, -1, 0, -1, -1, -1);
+  const __m128i alphaLane = _mm_set_epi16(255, 0, 0, 0, 255, 0, 0, 0);
+  for (; i + 4 <= count; i += 4) {
+    __m128i px = _mm_loadu_si128((const __m128i *)(src + i * 4));
+    if (swapRB) {
+      __m128i rb = _mm_and_si128(px, rbMask);
+      rb = _mm_or_si128(_mm_slli_epi32(rb, 16), _mm_srli_epi32(rb, 16));
+      px = _mm_or_si128(rb, _mm_and_si128(px, gaMask));
+    }
+    if (premultiply) {
+      __m128i lo = _mm_unpacklo_epi8(px, zero);
+      __m128i hi = _mm_unpackhi_epi8(px, zero);
+      __m128i alo = _mm_shufflehi_epi16(_mm_shufflelo_epi16(lo, 0xff), 0xff);
+      __m128i ahi = _mm_shufflehi_epi16(_mm_shufflelo_epi16(hi, 0xff), 0xff);
+      alo = _mm_or_si128(_mm_and_si128(alo, colorLanes), alphaLane);
+      ahi = _mm_or_si128(_mm_and_si128(ahi, colorLanes), alphaLane);
+      lo = _mm_add_epi16(_mm_mullo_epi16(lo, alo), bias);
+      hi = _mm_add_epi16(_mm_mullo_epi16(hi, ahi), bias);
+      lo = _mm_srli_epi16(_mm_add_epi16(lo, _mm_srli_epi16(lo, 8)), 8);
+      hi = _mm_srli_epi16(_mm_add_epi16(hi, _mm_srli_epi16(hi, 8)), 8);
+      px = _mm_packus_epi16(lo, hi);
+    }
+    _mm_storeu_si128((__m128i *)(dst + i * 4), px);
+  }
+#endif
+  for (; i < count; i++) {
+    const uint8_t *s = src + i * 4;
+    uint8_t *d = dst + i * 4;
+    uint8_t r = s[0], g = s[1], b = s[2], a = s[3];
+    if (premultiply) {
+      r = mulDiv255(r, a);
+      g = mulDiv255(g, a);
+      b = mulDiv255(b, a);
+    }
+    d[0] = swapRB ? b : r;
+    d[1] = g;
+    d[2] = swapRB ? r : b;
+    d[3] = a;
+  }
+}
+
+} // namespace
+
+TextureCache::TextureCache(const std::string &directory, Uint32 format,
+                           bool premultiply, bool mirrorPixels)
+    : directory(directory), format(format), premultiply(premultiply),
+      mirrorPixels(mirrorPixels) {
+  std::error_code error;
+  std::filesystem::create_directories(directory, error);
+  if (error) {
+    fprintf(stderr, "Warning: Error creating texture cache directory: %s\n",
+            directory.c_str());
+  }
+}
+
+std::string TextureCache::entryPath(uint64_t hash) const {
+  char name[64];
+  snprintf(name, sizeof(name), "%016llx-%08x%s.ttex", (unsigned long long)hash,
+           (unsigned)format, premultiply ? "-pm" : "");
+  return (std::filesystem::path(directory) / name).string();
+}
+
+std::shared_ptr<Texture> TextureCache::load(SDL_Renderer *renderer,
+                                            const std::vector<uint8_t> &source) {
+  std::string path = entryPath(hashBytes(source.data(), source.size()));
+  int width = 0, height = 0;
+  SDL_RendererInfo info;
+  if (SDL_GetRendererInfo(renderer, &info) == 0) {
+    maxWidth = info.max_texture_width;
+    maxHeight = info.max_texture_height;
+  }
+  if (!readEntry(path, width, height)) {
+    if (!decode(source, width, height))
+      return nullptr;
+    writeEntry(path, width, height);
+  }
+  return upload(renderer, width, height);
+}
+
+bool TextureCache::readEntry(const std::string &path, int &width, int &height) {
+  FILE *file = fopen(path.c_str(), "rb");
+  if (!file)
+    return false;
+  uint32_t header[7];
+  bool ok = fread(header, sizeof(header), 1, file) == 1 &&
+            memcmp(header, "TTEX", 4) == 0 && header[1] == Version &&
+            header[2] == format &&
+            ((header[5] & FlagPremultiplied) != 0) == premultiply;
+  // Never trust the header's dimensions for the allocation: a damaged or
+  // foreign entry must match the file's size and the renderer's limits, or
+  // it is treated as a miss.
+  if (ok) {
+    uint64_t pixelBytes = (uint64_t)header[3] * header[4] * 4;
+    ok = header[3] > 0 && header[4] > 0 && header[3] <= 32768 && header[4] <= 32768 &&
+         (maxWidth <= 0 || header[3] <= (uint32_t)maxWidth) &&
+         (maxHeight <= 0 || header[4] <= (uint32_t)maxHeight) &&
+         fseek(file, 0, SEEK_END) == 0 &&
+         (uint64_t)ftell(file) == sizeof(header) + pixelBytes &&
+         fseek(file, (long)sizeof(header), SEEK_SET) == 0;
+  }
+  if (ok) {
+    width = (int)header[3];
+    height = (int)header[4];
+    pixels.resize((size_t)width * height * 4);
+    ok = fread(pixels.data(), 1, pixels.size(), file) == pixels.size();
+  }
+  fclose(file);
+  return ok;
+}
+
+void TextureCache::writeEntry(const std::string &path, int width, int height) {
+  // Write beside the final name and rename, so a crash never leaves a
+  // truncated entry that a later launch would trust.
+  std::string temp = path + ".tmp";
+  FILE *file = fopen(temp.c_str(), "wb");
+  if (!file)
+    return;
+  uint32_t header[7] = {0, Version, format, (uint32_t)width, (uint32_t)height,
+                        premultiply ? FlagPremultiplied : 0, 0};
+  memcpy(header, "TTEX", 4);
+  bool ok = fwrite(header, sizeof(header), 1, file) == 1 &&
+            fwrite(pixels.data(), 1, pixels.size(), file) == pixels.size();
+  ok = fclose(file) == 0 && ok;
+  std::error_code error;
+  if (ok)
+    std::filesystem::rename(temp, path, error);
+  if (!ok || error)
+    std::filesystem::remove(temp, error);
+}
+
+bool TextureCache::decode(const std::vector<uint8_t> &source, int &width,
+                          int &height) {
+  SDL_Surface *surface =
+      IMG_Load_RW(SDL_RWFromConstMem(source.data(), (int)source.size()), 1);
+  if (!surface)
+    return false;
+  if (surface->format->format != SDL_PIXELFORMAT_RGBA32) {
+    SDL_Surface *converted =
+        SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_RGBA32, 0);
+    SDL_FreeSurface(surface);
+    if (!converted)
+      return false;
+    surface = converted;
+  }
+
+  width = surface->w;
+  height = surface->h;
+  size_t rowBytes = (size_t)width * 4;
+  pixels.resize(rowBytes * height);
+  bool swapRB = format == SDL_PIXELFORMAT_BGRA32;
+  SDL_LockSurface(surface);
+  for (int y = 0; y < height; y++) {
+    const uint8_t *row = (const uint8_t *)surface->pixels + (size_t)y * surface->pitch;
+    convertPixels(row, pixels.data() + y * rowBytes, width, swapRB, premultiply);
+  }
+  SDL_UnlockSurface(surface);
+  SDL_FreeSurface(surface);
+
+  if (format != SDL_PIXELFORMAT_RGBA32 && format != SDL_PIXELFORMAT_BGRA32) {
+    // Uncommon renderer formats go through SDL's generic converter.
+    std::vector<uint8_t> native(pixels.size());
+    if (SDL_ConvertPixels(width, height, SDL_PIXELFORMAT_RGBA32, pixels.data(),
+                          (int)rowBytes, format, native.data(), (int)rowBytes) != 0)
+      return false;
+    pixels.swap(native);
+  }
+  return true;
+}
+
+std::shared_ptr<Texture> TextureCache::upload(SDL_Renderer *renderer, int width,
+                                              int height) {
+  SDL_Texture *handle = SDL_CreateTexture(renderer, format,
+                                          SDL_TEXTUREACCESS_STATIC, width, height);
+  if (!handle)
+    return nullptr;
+  if (SDL_UpdateTexture(handle, nullptr, pixels.data(), width * 4) != 0) {
+    SDL_DestroyTexture(handle);
+    return nullptr;
+  }
+  SDL_SetTextureBlendMode(handle, premultiply ? Texture::premultipliedBlendMode()
+                                              : SDL_BLENDMODE_BLEND);
+
+  auto texture = std::make_shared<Texture>();
+  texture->texture = handle;
+  texture->width = width;
+  texture->height = height;
+  texture->premultiplied = premultiply;
+  if (mirrorPixels)
+    texture->mirror(pixels.data(), width * 4, format);
+  return texture;
+}
@@ -0,0 +1,47 @@
+#ifndef TENSAI_TEXTURE_CACHE_H
+#define TENSAI_TEXTURE_CACHE_H
+
+#include "texture.h"
+#include <SDL2/SDL.h>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// On-disk cache of decoded texture pixels already in the renderer's native
+// format. Entries are keyed by a hash of the encoded source bytes plus the
+// target format and premultiply flag, so a hit is one file read and a single
+// SDL_UpdateTexture with no image decoding or format conversion.
+//
+// Entry layout: "TTEX", u32 version, u32 format, u32 width, u32 height,
+// u32 flags, u32 reserved, then width * height * 4 bytes of pixels.
+class TextureCache {
+public:
+  static constexpr uint32_t Version = 1;
+  static constexpr uint32_t FlagPremultiplied = 1;
+
+  // mirrorPixels keeps a CPU copy in each texture for the software renderer.
+  TextureCache(const std::string &directory, Uint32 format, bool premultiply,
+               bool mirrorPixels = false);
+
+  std::shared_ptr<Texture> load(SDL_Renderer *renderer,
+                                const std::vector<uint8_t> &source);
+
+private:
+  std::string directory;
+  Uint32 format;
+  bool premultiply;
+  bool mirrorPixels;
+  // The renderer's texture size limits, 0 when unknown.
+  int maxWidth = 0, maxHeight = 0;
+  std::vector<uint8_t> pixels;
+
+  std::string entryPath(uint64_t hash) const;
+  bool readEntry(const std::string &path, int &width, int &height);
+  void writeEntry(const std::string &path, int width, int height);
+  bool decode(const std::vector<uint8_t> &source, int &width, int &height);
+  std::shared_ptr<Texture> upload(SDL_Renderer *renderer, int width,
+                                  int height);
+};
+
+#endif // TENSAI_TEXTURE_CACHE_H
@@ -1,17 +1,29 @@
 #include "core/color.h"
+#include "core/thread_pool.h"
 #include "core/transform.h"
 #include "core/vec2.h"
+#include "modules/assets.h"
 #include "modules/audio.h"
 #include "modules/camera.h"
+#include "modules/capture.h"
+#include "modules/ecs.h"
 #include "modules/graphics.h"
 #include "modules/input.h"
+#include "modules/input_log.h"
+#include "modules/noise.h"
 #include "modules/physics.h"
+#include "modules/physics_world.h"
 #include "modules/random.h"
+#include "modules/simulation.h"
+#include "modules/spatial_index.h"
+#include "modules/texture_residency.h"
+#include "modules/tile_map.h"
 #include "modules/timer.h"
 #include "resources/font.h"
 #include "resources/music.h"
 #include "resources/sound.h"
 #include "resources/texture.h"
+#include "resources/texture_cache.h"
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_image.h>
 #include <SDL2/SDL_mixer.h>
@@ -19,6 +31,7 @@
 #include <algorithm>
 #include <chrono>
 #include <cmath>
+#include <limits>
 #include <memory>
 #include <napi.h>
 #include <random>
@@ -26,15 +39,72 @@
 #include <thread>
 #include <unordered_map>
 #include <vector>
+
+// As<Napi::Float32Array>() and friends do not check the element type, so
+// every typed array argument is checked here before its data is touched.
+bool IsTypedArrayOf(const Napi::Value &value, napi_typedarray_type type) {
+  return value.IsTypedArray() && value.As<Napi::TypedArray>().TypedArrayType() == type;
+}
+
+// Per-environment state. Each worker thread that loads the addon gets its
+// own constructors and stepAll pool, released with its environment.
+struct AddonData {
+  Napi::FunctionReference engine;
+  Napi::FunctionReference simulation;
+  std::unique_ptr<ThreadPool> pool;
+};
+
+// Body options shared by TensaiEngine#addBody and Simulation#addBody.
+PhysicsWorld::Object ParseBody(const Napi::Object &options) {
+  auto number = [&](const char *key, float fallback) {
+    return options.Has(key) ? options.Get(key).As<Napi::Number>().FloatValue()
+                            : fallback;
+  };
+  auto flag = [&](const char *key) {
+    return options.Has(key) && options.Get(key).As<Napi::Boolean>().Value();
+  };
+
+  PhysicsWorld::Object object;
+  object.body.position = Vec2(number("x", 0.0f), number("y", 0.0f));
+  object.body.velocity = Vec2(number("vx", 0.0f), number("vy", 0.0f));
+  object.body.mass = number("mass", 1.0f);
+  object.body.friction = number("friction", 0.0f);
+  object.body.restitution = number("restitution", 1.0f);
+  object.body.kinematic = flag("kinematic");
+  object.body.bullet = flag("bullet");
+  if (options.Has("width") || options.Has("height")) {
+    object.shape = PhysicsWorld::Shape::Box;
+    object.halfSize = Vec2(number("width", 1.0f), number("height", 1.0f)) * 0.5f;
+  } else {
+    object.shape = PhysicsWorld::Shape::Circle;
+    object.radius = number("radius", 0.5f);
+  }
+  return object;
+}
+
 class TensaiEngine : public Napi::ObjectWrap<TensaiEngine> {
 private:
   SDL_Window *window = nullptr;
   SDL_Renderer *renderer = nullptr;
+  std::unique_ptr<Assets> assets;
   std::unique_ptr<Graphics> graphics;
   std::unique_ptr<Input> input;
   std::unique_ptr<Timer> timer;
   std::unique_ptr<Random> random;
+  std::unique_ptr<Noise> noise;
   std::unique_ptr<Audio> audio;
+  std::unique_ptr<TextureCache> textureCache;
+  // Created by the first setTextureBudget call.
+  std::unique_ptr<TextureResidency> residency;
+  Color texturePlaceholder{128, 128, 128, 255};
+  // The last recording, kept after stopCapture so its totals stay readable.
+  std::shared_ptr<Capture> capture;
+  // Input recording and replay; frames count from each one's start.
+  std::unique_ptr<InputLogWriter> inputRecorder;
+  std::unique_ptr<InputLogReader> inputReplay;
+  uint32_t recordFrame = 0;
+  uint32_t replayFrame = 0;
+  double liveFixedStep = 0.0;
   Napi::FunctionReference loadCallback;
   Napi::FunctionReference updateCallback;
   Napi::FunctionReference drawCallback;
@@ -44,6 +114,65 @@ private:
   bool fullscreen, vsync;
   std::unordered_map<std::string, std::shared_ptr<Texture>> textures;
   std::unordered_map<std::string, std::shared_ptr<Font>> fonts;
+  // Resource memory budgets in bytes; 0 disables a limit. Crossing the soft
+  // budget warns once until usage drops back under it, loads that would
+  // exceed the hard budget fail. Sizes are measured once a resource is
+  // loaded, so a sound is decoded in full before it can be refused.
+  size_t memorySoftBudget = 0;
+  size_t memoryHardBudget = 0;
+  bool memorySoftWarned = false;
+  // Running byte totals of `textures` and `fonts`, so budget checks and
+  // getMemoryStats never walk the maps. Only StoreTexture, EraseTexture,
+  // the residency size callback and the font paths change them.
+  size_t textureBytes = 0;
+  size_t fontBytes = 0;
+  int nextCanvasId = 1;
+  int nextNoiseTextureId = 1;
+  std::vector<std::unique_ptr<SpatialIndex>> spatialIndices;
+  std::vector<int> queryResults;
+  std::vector<std::unique_ptr<TileMap>> tileMaps;
+  std::vector<std::unique_ptr<PhysicsWorld>> physicsWorlds;
+  EntityStore entities;
+  std::vector<uint32_t> entityResults;
+  // Sprite components hold a slot per texture key. Slots are resolved
+  // through `textures` on every draw, so unloading or reloading a key is
+  // picked up without holding on to the old texture.
+  std::vector<std::string> spriteTextureKeys;
+  std::unordered_map<std::string, int> spriteTextureSlots;
+  std::vector<std::shared_ptr<Texture>> spriteTextures;
+  // Live getColumn views keyed by archetype * FieldCount + field. They alias
+  // store memory, so a view is detached once its column reallocates.
+  struct ColumnViewEntry {
+    const void *data;
+    Napi::Reference<Napi::ArrayBuffer> buffer;
+  };
+  std::unordered_map<uint32_t, ColumnViewEntry> columnViews;
+  std::vector<float> noiseSamples;
+  std::vector<uint8_t> noisePixels;
+
+  // Substream id for noise permutation tables, so reseeding noise never
+  // depends on how many numbers the game has drawn from `random`.
+  static constexpr uint64_t NoiseStream = 0x6e6f697365;
+
+  struct MemoryUsage {
+    int textures = 0;
+    size_t textureBytes = 0;
+    int fonts = 0;
+    size_t fontBytes = 0;
+    Audio::MemoryStats audio;
+
+    size_t total() const {
+      return textureBytes + fontBytes + audio.soundBytes + audio.musicBytes;
+    }
+  };
+
+  struct NoiseRequest {
+    Noise::Params params;
+    float x = 0.0f, y = 0.0f, z = 0.0f;
+    bool hasZ = false;
+    float step = 1.0f;
+    int threads = 1;
+  };
 
 public:
   static Napi::Object Init(Napi::Env env, Napi::Object exports) {
@@ -54,10 +183,22 @@ public:
             InstanceAccessor("load", nullptr, &TensaiEngine::SetLoad),
             InstanceAccessor("update", nullptr, &TensaiEngine::SetUpdate),
             InstanceAccessor("draw", nullptr, &TensaiEngine::SetDraw),
+            InstanceMethod("mountPack", &TensaiEngine::MountPack),
+            InstanceMethod("setTextureCache", &TensaiEngine::SetTextureCache),
+            InstanceMethod("setTextureBudget", &TensaiEngine::SetTextureBudget),
+            InstanceMethod("setTexturePlaceholder", &TensaiEngine::SetTexturePlaceholder),
             InstanceMethod("loadTexture", &TensaiEngine::LoadTexture),
             InstanceMethod("loadFont", &TensaiEngine::LoadFont),
             InstanceMethod("loadSound", &TensaiEngine::LoadSound),
             InstanceMethod("loadMusic", &TensaiEngine::LoadMusic),
+            InstanceMethod("unloadSound", &TensaiEngine::UnloadSound),
+            InstanceMethod("unloadSoundBank", &TensaiEngine::UnloadSoundBank),
+            InstanceMethod("unloadMusic", &TensaiEngine::UnloadMusic),
+            InstanceMethod("getSoundBanks", &TensaiEngine::GetSoundBanks),
+            InstanceMethod("unloadTexture", &TensaiEngine::UnloadTexture),
+            InstanceMethod("unloadFont", &TensaiEngine::UnloadFont),
+            InstanceMethod("getMemoryStats", &TensaiEngine::GetMemoryStats),
+            InstanceMethod("setMemoryBudget", &TensaiEngine::SetMemoryBudget),
             InstanceMethod("getWidth", &TensaiEngine::GetWidth),
             InstanceMethod("getHeight", &TensaiEngine::GetHeight),
             InstanceMethod("setTitle", &TensaiEngine::SetTitle),
@@ -75,6 +216,11 @@ public:
             InstanceMethod("getDelta", &TensaiEngine::GetDelta),
             InstanceMethod("getTime", &TensaiEngine::GetTime),
             InstanceMethod("getFPS", &TensaiEngine::GetFPS),
+            InstanceMethod("setFixedTimestep", &TensaiEngine::SetFixedTimestep),
+            InstanceMethod("startRecording", &TensaiEngine::StartRecording),
+            InstanceMethod("stopRecording", &TensaiEngine::StopRecording),
+            InstanceMethod("startReplay", &TensaiEngine::StartReplay),
+            InstanceMethod("stopReplay", &TensaiEngine::StopReplay),
             InstanceMethod("clear", &TensaiEngine::Clear),
             InstanceMethod("setColor", &TensaiEngine::SetColor),
             InstanceMethod("drawPoint", &TensaiEngine::DrawPoint),
@@ -82,20 +228,96 @@ public:
             InstanceMethod("drawRect", &TensaiEngine::DrawRect),
             InstanceMethod("drawCircle", &TensaiEngine::DrawCircle),
             InstanceMethod("drawTexture", &TensaiEngine::DrawTexture),
+            InstanceMethod("createCanvas", &TensaiEngine::CreateCanvas),
+            InstanceMethod("setCanvas", &TensaiEngine::SetCanvas),
+            InstanceMethod("drawCanvas", &TensaiEngine::DrawTexture),
             InstanceMethod("drawText", &TensaiEngine::DrawText),
+            InstanceMethod("setDeferred", &TensaiEngine::SetDeferred),
+            InstanceMethod("setLayer", &TensaiEngine::SetLayer),
+            InstanceMethod("flush", &TensaiEngine::Flush),
+            InstanceMethod("setRenderThread", &TensaiEngine::SetRenderThread),
+            InstanceMethod("setRetained", &TensaiEngine::SetRetained),
+            InstanceMethod("setIdleFrameRate", &TensaiEngine::SetIdleFrameRate),
+            InstanceMethod("invalidate", &TensaiEngine::Invalidate),
+            InstanceMethod("startCapture", &TensaiEngine::StartCapture),
+            InstanceMethod("stopCapture", &TensaiEngine::StopCapture),
             InstanceMethod("drawPolygon", &TensaiEngine::DrawPolygon),
             InstanceMethod("setFont", &TensaiEngine::SetFont),
             InstanceMethod("playSound", &TensaiEngine::PlaySound),
+            InstanceMethod("playSoundAt", &TensaiEngine::PlaySoundAt),
             InstanceMethod("playMusic", &TensaiEngine::PlayMusic),
             InstanceMethod("stopMusic", &TensaiEngine::StopMusic),
+            InstanceMethod("preloadMusic", &TensaiEngine::PreloadMusic),
+            InstanceMethod("crossfadeMusic", &TensaiEngine::CrossfadeMusic),
+            InstanceMethod("setMusicLoopPoints", &TensaiEngine::SetMusicLoopPoints),
             InstanceMethod("setMusicVolume", &TensaiEngine::SetMusicVolume),
+            InstanceMethod("setVoices", &TensaiEngine::SetVoices),
+            InstanceMethod("setVoiceStealPolicy", &TensaiEngine::SetVoiceStealPolicy),
+            InstanceMethod("setSoundPriority", &TensaiEngine::SetSoundPriority),
+            InstanceMethod("setSoundMaxInstances", &TensaiEngine::SetSoundMaxInstances),
+            InstanceMethod("createEmitter", &TensaiEngine::CreateEmitter),
+            InstanceMethod("destroyEmitter", &TensaiEngine::DestroyEmitter),
+            InstanceMethod("setEmitterPosition", &TensaiEngine::SetEmitterPosition),
+            InstanceMethod("setEmitterPositions", &TensaiEngine::SetEmitterPositions),
+            InstanceMethod("setCamera", &TensaiEngine::SetCamera),
+            InstanceMethod("getStats", &TensaiEngine::GetStats),
+            InstanceMethod("createSpatialIndex", &TensaiEngine::CreateSpatialIndex),
+            InstanceMethod("destroySpatialIndex", &TensaiEngine::DestroySpatialIndex),
+            InstanceMethod("buildSpatialIndex", &TensaiEngine::BuildSpatialIndex),
+            InstanceMethod("updateSpatialIndex", &TensaiEngine::UpdateSpatialIndex),
+            InstanceMethod("removeFromSpatialIndex", &TensaiEngine::RemoveFromSpatialIndex),
+            InstanceMethod("queryAABB", &TensaiEngine::QueryAABB),
+            InstanceMethod("queryCircle", &TensaiEngine::QueryCircle),
+            InstanceMethod("raycast", &TensaiEngine::Raycast),
+            InstanceMethod("queryPairs", &TensaiEngine::QueryPairs),
+            InstanceMethod("createTileMap", &TensaiEngine::CreateTileMap),
+            InstanceMethod("destroyTileMap", &TensaiEngine::DestroyTileMap),
+            InstanceMethod("setTiles", &TensaiEngine::SetTiles),
+            InstanceMethod("setTile", &TensaiEngine::SetTile),
+            InstanceMethod("getTile", &TensaiEngine::GetTile),
+            InstanceMethod("moveAndCollide", &TensaiEngine::MoveAndCollide),
+            InstanceMethod("createPhysicsWorld", &TensaiEngine::CreatePhysicsWorld),
+            InstanceMethod("destroyPhysicsWorld", &TensaiEngine::DestroyPhysicsWorld),
+            InstanceMethod("setGravity", &TensaiEngine::SetGravity),
+            InstanceMethod("addBody", &TensaiEngine::AddBody),
+            InstanceMethod("removeBody", &TensaiEngine::RemoveBody),
+            InstanceMethod("setBodyPosition", &TensaiEngine::SetBodyPosition),
+            InstanceMethod("setBodyVelocity", &TensaiEngine::SetBodyVelocity),
+            InstanceMethod("setBodyBullet", &TensaiEngine::SetBodyBullet),
+            InstanceMethod("applyForce", &TensaiEngine::ApplyForce),
+            InstanceMethod("getBodyStates", &TensaiEngine::GetBodyStates),
+            InstanceMethod("stepPhysics", &TensaiEngine::StepPhysics),
+            InstanceMethod("getTextureId", &TensaiEngine::GetTextureId),
+            InstanceMethod("createEntity", &TensaiEngine::CreateEntity),
+            InstanceMethod("createEntities", &TensaiEngine::CreateEntities),
+            InstanceMethod("destroyEntity", &TensaiEngine::DestroyEntity),
+            InstanceMethod("isEntityAlive", &TensaiEngine::IsEntityAlive),
+            InstanceMethod("addComponents", &TensaiEngine::AddComponents),
+            InstanceMethod("removeComponents", &TensaiEngine::RemoveComponents),
+            InstanceMethod("setEntity", &TensaiEngine::SetEntity),
+            InstanceMethod("getEntity", &TensaiEngine::GetEntity),
+            InstanceMethod("getArchetypes", &TensaiEngine::GetArchetypes),
+            InstanceMethod("getArchetypeMask", &TensaiEngine::GetArchetypeMask),
+            InstanceMethod("getArchetypeSize", &TensaiEngine::GetArchetypeSize),
+            InstanceMethod("getColumn", &TensaiEngine::GetColumn),
+            InstanceMethod("updateEntities", &TensaiEngine::UpdateEntities),
+            InstanceMethod("cullEntities", &TensaiEngine::CullEntities),
+            InstanceMethod("collideEntities", &TensaiEngine::CollideEntities),
+            InstanceMethod("drawEntities", &TensaiEngine::DrawEntities),
             InstanceMethod("randomInt", &TensaiEngine::RandomInt),
             InstanceMethod("randomFloat", &TensaiEngine::RandomFloat),
             InstanceMethod("randomBool", &TensaiEngine::RandomBool),
+            InstanceMethod("setSeed", &TensaiEngine::SetSeed),
+            InstanceMethod("getSeed", &TensaiEngine::GetSeed),
+            InstanceMethod("fillRandomFloat", &TensaiEngine::FillRandomFloat),
+            InstanceMethod("fillRandomInt", &TensaiEngine::FillRandomInt),
+            InstanceMethod("noise", &TensaiEngine::NoiseSample),
+            InstanceMethod("fillNoise", &TensaiEngine::FillNoise),
+            InstanceMethod("sampleNoise", &TensaiEngine::SampleNoise),
+            InstanceMethod("createNoiseTexture", &TensaiEngine::CreateNoiseTexture),
+            InstanceMethod("updateNoiseTexture", &TensaiEngine::UpdateNoiseTexture),
         });
-    Napi::FunctionReference *constructor = new Napi::FunctionReference();
-    *constructor = Napi::Persistent(func);
-    env.SetInstanceData(constructor);
+    env.GetInstanceData<AddonData>()->engine = Napi::Persistent(func);
     exports.Set("TensaiEngine", func);
     return exports;
   }
@@ -115,6 +337,7 @@ public:
     windowHeight = info[2].As<Napi::Number>().Int32Value();
     fullscreen = info[3].As<Napi::Boolean>().Value();
     vsync = info[4].As<Napi::Boolean>().Value();
+    assets = std::make_unique<Assets>();
     if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO | SDL_INIT_EVENTS) != 0) {
       Napi::Error::New(env, "Failed to initialize SDL")
           .ThrowAsJavaScriptException();
@@ -136,7 +359,38 @@ public:
       return;
     }
 
-    Uint32 rendererFlags = SDL_RENDERER_ACCELERATED;
+    Graphics::Backend backend = Graphics::Backend::SDL;
+    int rasterThreads = 0;
+    bool renderThread = false;
+    int audioFrequency = 44100;
+    int audioBufferFrames = 2048;
+    if (info.Length() >= 6 && info[5].IsObject()) {
+      Napi::Object options = info[5].As<Napi::Object>();
+      if (options.Has("renderer") &&
+          options.Get("renderer").As<Napi::String>().Utf8Value() == "software")
+        backend = Graphics::Backend::Software;
+      if (options.Has("rasterThreads"))
+        rasterThreads = options.Get("rasterThreads").As<Napi::Number>().Int32Value();
+      if (options.Has("renderThread"))
+        renderThread = options.Get("renderThread").As<Napi::Boolean>().Value();
+      if (options.Has("audioLatency") &&
+          options.Get("audioLatency").As<Napi::String>().Utf8Value() == "low") {
+        audioFrequency = Audio::LowLatencyFrequency;
+        audioBufferFrames = Audio::LowLatencyBufferFrames;
+      }
+      if (options.Has("audioFrequency"))
+        audioFrequency = options.Get("audioFrequency").As<Napi::Number>().Int32Value();
+      if (options.Has("audioBufferFrames"))
+        audioBufferFrames =
+            options.Get("audioBufferFrames").As<Napi::Number>().Int32Value();
+    }
+
+    // The software backend targets hosts without a GPU, where SDL only
+    // offers its own software renderer.
+    // Render targets are optional; Graphics checks for them itself.
+    Uint32 rendererFlags = backend == Graphics::Backend::Software
+                               ? SDL_RENDERER_SOFTWARE
+                               : SDL_RENDERER_ACCELERATED;
     if (vsync)
       rendererFlags |= SDL_RENDERER_PRESENTVSYNC;
     renderer = SDL_CreateRenderer(window, -1, rendererFlags);
@@ -146,14 +400,26 @@ public:
       return;
     }
 
-    graphics = std::make_unique<Graphics>(renderer);
+    graphics = std::make_unique<Graphics>(renderer, backend, rasterThreads);
+    if (renderThread)
+      graphics->setThreaded(true);
     input = std::make_unique<Input>();
     timer = std::make_unique<Timer>();
     random = std::make_unique<Random>();
-    audio = std::make_unique<Audio>();
+    noise = std::make_unique<Noise>(random->substream(NoiseStream));
+    audio = std::make_unique<Audio>(*assets, audioFrequency, audioBufferFrames);
+    // Sounds and music load on play and in the background too; the budget
+    // applies to every path.
+    audio->setAdmission([this](const char *kind, const std::string &path, size_t bytes) {
+      return WithinMemoryBudget(MeasureMemory().total() + bytes, kind, path);
+    });
   }
 
   ~TensaiEngine() {
+    // Joins the render thread before the renderer goes away.
+    graphics.reset();
+    residency.reset();
+    capture.reset();
     if (renderer)
       SDL_DestroyRenderer(renderer);
     if (window)
@@ -184,49 +450,128 @@ public:
     running = true;
     SDL_Event event;
     while (running) {
-      timer->update();
       input->update();
+      if (inputReplay)
+        ReplayFrame();
+      timer->update();
+      if (inputRecorder && inputRecorder->getTimestep() == 0.0) {
+        InputEvent delta;
+        delta.frame = recordFrame;
+        delta.type = InputEvent::Delta;
+        delta.delta = (float)timer->getDelta();
+        inputRecorder->write(delta);
+      }
+      audio->update();
       while (SDL_PollEvent(&event)) {
+        InputEvent live;
         switch (event.type) {
         case SDL_QUIT:
-          running = false;
+          live.type = InputEvent::Quit;
           break;
         case SDL_KEYDOWN:
-          input->setKey(event.key.keysym.sym, true);
-          break;
         case SDL_KEYUP:
-          input->setKey(event.key.keysym.sym, false);
+          live.type = event.type == SDL_KEYDOWN ? InputEvent::KeyDown : InputEvent::KeyUp;
+          live.x = event.key.keysym.sym;
           break;
         case SDL_MOUSEBUTTONDOWN:
-          input->setMouse(event.button.button, true);
-          break;
         case SDL_MOUSEBUTTONUP:
-          input->setMouse(event.button.button, false);
+          live.type = event.type == SDL_MOUSEBUTTONDOWN ? InputEvent::MouseDown
+                                                        : InputEvent::MouseUp;
+          live.x = event.button.button;
           break;
         case SDL_MOUSEMOTION:
-          input->setMousePos(event.motion.x, event.motion.y);
+          live.type = InputEvent::MouseMove;
+          live.x = event.motion.x;
+          live.y = event.motion.y;
           break;
         case SDL_MOUSEWHEEL:
-          input->setMouseWheel(event.wheel.x, event.wheel.y);
+          live.type = InputEvent::Wheel;
+          live.x = event.wheel.x;
+          live.y = event.wheel.y;
           break;
+        default:
+          continue;
         }
+        // A replay owns the input; only closing the window gets through.
+        if (!inputReplay || live.type == InputEvent::Quit)
+          ApplyInput(live);
       }
 
       if (updateCallback) {
         updateCallback.Call({Napi::Number::New(env, timer->getDelta())});
       }
 
+      audio->updateSpatial(graphics->getCamera());
+
       if (drawCallback) {
         drawCallback.Call({});
       }
 
       graphics->present();
+      if (residency)
+        residency->endFrame();
+      graphics->getArena().reset();
+      recordFrame++;
+      replayFrame++;
     }
 
     return env.Undefined();
   }
 
-  Napi::Value LoadTexture(const Napi::CallbackInfo &info) {
+  void ApplyInput(const InputEvent &event) {
+    switch (event.type) {
+    case InputEvent::KeyDown:
+    case InputEvent::KeyUp:
+      input->setKey(event.x, event.type == InputEvent::KeyDown);
+      break;
+    case InputEvent::MouseDown:
+    case InputEvent::MouseUp:
+      input->setMouse(event.x, event.type == InputEvent::MouseDown);
+      break;
+    case InputEvent::MouseMove:
+      input->setMousePos(event.x, event.y);
+      break;
+    case InputEvent::Wheel:
+      input->setMouseWheel(event.x, event.y);
+      break;
+    case InputEvent::Quit:
+      running = false;
+      break;
+    case InputEvent::Delta:
+      return;
+    }
+    if (inputRecorder) {
+      InputEvent recorded = event;
+      recorded.frame = recordFrame;
+      inputRecorder->write(recorded);
+    }
+  }
+
+  void ReplayFrame() {
+    InputEvent event;
+    while (inputReplay->next(replayFrame, event)) {
+      if (event.type == InputEvent::Delta)
+        timer->setFixedStep(event.delta);
+      else
+        ApplyInput(event);
+    }
+    if (inputReplay->finished())
+      StopReplayInput();
+  }
+
+  void StopReplayInput() {
+    if (!inputReplay)
+      return;
+    inputReplay.reset();
+    timer->setFixedStep(liveFixedStep);
+  }
+
+  void Reseed(uint64_t seed) {
+    random->setSeed(seed);
+    noise->setSeed(random->substream(NoiseStream));
+  }
+
+  Napi::Value MountPack(const Napi::CallbackInfo &info) {
     Napi::Env env = info.Env();
     if (info.Length() < 1) {
       Napi::TypeError::New(env, "Expected path argument")
@@ -235,18 +580,124 @@ public:
     }
 
     std::string path = info[0].As<Napi::String>().Utf8Value();
-    SDL_Surface *surface = IMG_Load(path.c_str());
-    if (!surface) {
+    return Napi::Boolean::New(env, assets->mount(path));
+  }
+
+  Uint32 NativeTextureFormat() const {
+    SDL_RendererInfo rendererInfo;
+    if (SDL_GetRendererInfo(renderer, &rendererInfo) == 0) {
+      for (Uint32 i = 0; i < rendererInfo.num_texture_formats; i++) {
+        Uint32 format = rendererInfo.texture_formats[i];
+        if (format == SDL_PIXELFORMAT_BGRA32 || format == SDL_PIXELFORMAT_RGBA32)
+          return format;
+      }
+      if (rendererInfo.num_texture_formats > 0 &&
+          !SDL_ISPIXELFORMAT_FOURCC(rendererInfo.texture_formats[0]) &&
+          SDL_BYTESPERPIXEL(rendererInfo.texture_formats[0]) == 4)
+        return rendererInfo.texture_formats[0];
+    }
+    return SDL_PIXELFORMAT_BGRA32;
+  }
+
+  Napi::Value SetTextureCache(const Napi::CallbackInfo &info) {
+    if (info.Length() < 1 || !info[0].IsString()) {
+      textureCache.reset();
+      return info.Env().Undefined();
+    }
+
+    std::string directory = info[0].As<Napi::String>().Utf8Value();
+    bool premultiply =
+        info.Length() >= 2 ? info[1].As<Napi::Boolean>().Value() : false;
+    textureCache = std::make_unique<TextureCache>(directory, NativeTextureFormat(),
+                                                  premultiply, graphics->isSoftware());
+    return info.Env().Undefined();
+  }
+
+  Napi::Value SetTextureBudget(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || !info[0].IsNumber()) {
+      Napi::TypeError::New(env, "Expected budget in bytes")
+          .ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    if (!residency) {
+      residency = std::make_unique<TextureResidency>(*assets, *graphics, renderer,
+                                                     texturePlaceholder);
+      for (const auto &entry : textures)
+        residency->track(entry.second);
+      residency->setSizeChange([this](const Texture &texture, size_t removed, size_t added) {
+        // Retired textures may still be evicted; only loaded ones count.
+        auto it = textures.find(texture.source);
+        if (it != textures.end() && it->second.get() == &texture)
+          textureBytes = textureBytes - std::min(textureBytes, removed) + added;
+      });
+      graphics->setResidency(residency.get());
+    }
+    double bytes = info[0].As<Napi::Number>().DoubleValue();
+    residency->setBudget(bytes > 0.0 ? (size_t)bytes : 0);
+    return env.Undefined();
+  }
+
+  Napi::Value SetTexturePlaceholder(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 3) {
+      Napi::TypeError::New(env, "Expected r, g, b arguments")
+          .ThrowAsJavaScriptException();
       return env.Undefined();
     }
+    texturePlaceholder =
+        Color(info[0].As<Napi::Number>().Uint32Value(),
+              info[1].As<Napi::Number>().Uint32Value(),
+              info[2].As<Napi::Number>().Uint32Value(),
+              info.Length() >= 4 ? info[3].As<Napi::Number>().Uint32Value() : 255);
+    if (residency)
+      residency->setPlaceholder(texturePlaceholder);
+    return env.Undefined();
+  }
 
-    auto texture = std::make_shared<Texture>();
-    texture->texture = SDL_CreateTextureFromSurface(renderer, surface);
-    texture->width = surface->w;
-    texture->height = surface->h;
-    SDL_FreeSurface(surface);
-    if (texture->texture) {
-      textures[path] = texture;
+  Napi::Value LoadTexture(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1) {
+      Napi::TypeError::New(env, "Expected path argument")
+          .ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+
+    std::string path = info[0].As<Napi::String>().Utf8Value();
+    std::shared_ptr<Texture> texture;
+    if (textureCache) {
+      std::vector<uint8_t> source;
+      if (assets->read(path, source))
+        graphics->runOnRenderer([&] { texture = textureCache->load(renderer, source); });
+    } else {
+      SDL_Surface *surface = IMG_Load_RW(assets->open(path), 1);
+      if (!surface) {
+        return env.Undefined();
+      }
+
+      texture = std::make_shared<Texture>();
+      graphics->runOnRenderer([&] {
+        texture->texture = SDL_CreateTextureFromSurface(renderer, surface);
+      });
+      texture->width = surface->w;
+      texture->height = surface->h;
+      if (graphics->isSoftware())
+        texture->mirror(surface);
+      SDL_FreeSurface(surface);
+    }
+
+    if (texture && texture->texture) {
+      auto previous = textures.find(path);
+      size_t replaced = previous != textures.end() ? previous->second->bytes() : 0;
+      if (!WithinMemoryBudget(MeasureMemory().total() - replaced + texture->bytes(),
+                              "texture", path)) {
+        graphics->retire(std::move(texture));
+        return env.Undefined();
+      }
+      texture->source = path;
+      if (residency)
+        residency->track(texture);
+      StoreTexture(path, texture);
       return Napi::String::New(env, path);
     }
 
@@ -262,9 +713,15 @@ public:
     }
     std::string path = info[0].As<Napi::String>().Utf8Value();
     int size = info[1].As<Napi::Number>().Int32Value();
-    auto font = std::make_shared<Font>(path, size);
+    auto font = std::make_shared<Font>(assets->open(path), size);
     if (font->font) {
       std::string key = path + "_" + std::to_string(size);
+      auto previous = fonts.find(key);
+      size_t replaced = previous != fonts.end() ? previous->second->bytes() : 0;
+      if (!WithinMemoryBudget(MeasureMemory().total() - replaced + font->bytes(),
+                              "font", key))
+        return env.Undefined();
+      fontBytes = fontBytes - replaced + font->bytes();
       fonts[key] = font;
       return Napi::String::New(env, key);
     }
@@ -281,7 +738,10 @@ public:
     }
 
     std::string path = info[0].As<Napi::String>().Utf8Value();
-    auto sound = audio->loadSound(path);
+    std::string bank = info.Length() >= 2 && info[1].IsString()
+                           ? info[1].As<Napi::String>().Utf8Value()
+                           : "default";
+    auto sound = audio->loadSound(path, bank);
     return sound ? Napi::String::New(env, path) : env.Undefined();
   }
 
@@ -298,6 +758,152 @@ public:
     return music ? Napi::String::New(env, path) : env.Undefined();
   }
 
+  Napi::Value UnloadSound(const Napi::CallbackInfo &info) {
+    if (info.Length() >= 1) {
+      audio->unloadSound(info[0].As<Napi::String>().Utf8Value());
+    }
+    return info.Env().Undefined();
+  }
+
+  Napi::Value UnloadSoundBank(const Napi::CallbackInfo &info) {
+    if (info.Length() >= 1) {
+      audio->unloadBank(info[0].As<Napi::String>().Utf8Value());
+    }
+    return info.Env().Undefined();
+  }
+
+  Napi::Value UnloadMusic(const Napi::CallbackInfo &info) {
+    if (info.Length() >= 1) {
+      audio->unloadMusic(info[0].As<Napi::String>().Utf8Value());
+    }
+    return info.Env().Undefined();
+  }
+
+  Napi::Value GetSoundBanks(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+    Napi::Object banks = Napi::Object::New(env);
+    for (const auto &entry : audio->getBankStats()) {
+      Napi::Object bank = Napi::Object::New(env);
+      bank.Set("sounds", entry.second.sounds);
+      bank.Set("bytes", (double)entry.second.bytes);
+      banks.Set(entry.first, bank);
+    }
+    return banks;
+  }
+
+  Napi::Value UnloadTexture(const Napi::CallbackInfo &info) {
+    if (info.Length() >= 1 && info[0].IsString()) {
+      auto it = textures.find(info[0].As<Napi::String>().Utf8Value());
+      if (it != textures.end()) {
+        if (graphics->getCanvas() == it->second)
+          graphics->setCanvas(nullptr);
+        EraseTexture(it);
+      }
+    }
+    return info.Env().Undefined();
+  }
+
+  Napi::Value UnloadFont(const Napi::CallbackInfo &info) {
+    if (info.Length() >= 1 && info[0].IsString()) {
+      auto it = fonts.find(info[0].As<Napi::String>().Utf8Value());
+      if (it != fonts.end()) {
+        fontBytes -= it->second->bytes();
+        fonts.erase(it);
+      }
+    }
+    return info.Env().Undefined();
+  }
+
+  // Every texture enters and leaves `textures` through these two.
+  void StoreTexture(const std::string &key, std::shared_ptr<Texture> texture) {
+    std::shared_ptr<Texture> &slot = textures[key];
+    if (slot) {
+      textureBytes -= std::min(textureBytes, slot->bytes());
+      graphics->retire(std::move(slot));
+    }
+    textureBytes += texture->bytes();
+    slot = std::move(texture);
+  }
+
+  void EraseTexture(std::unordered_map<std::string, std::shared_ptr<Texture>>::iterator it) {
+    textureBytes -= std::min(textureBytes, it->second->bytes());
+    graphics->retire(std::move(it->second));
+    textures.erase(it);
+  }
+
+  MemoryUsage MeasureMemory() const {
+    MemoryUsage usage;
+    usage.textures = (int)textures.size();
+    usage.textureBytes = textureBytes;
+    usage.fonts = (int)fonts.size();
+    usage.fontBytes = fontBytes;
+    usage.audio = audio->getMemoryStats();
+    return usage;
+  }
+
+  // Checks the resource total a load would leave behind. Returns false when
+  // it breaks the hard budget, in which case the caller drops the resource.
+  bool WithinMemoryBudget(size_t total, const char *kind, const std::string &name) {
+    if (memoryHardBudget > 0 && total > memoryHardBudget) {
+      fprintf(stderr,
+              "Warning: Not loading %s %s: %zu bytes would exceed the hard "
+              "memory budget of %zu\n",
+              kind, name.c_str(), total, memoryHardBudget);
+      return false;
+    }
+    if (memorySoftBudget > 0 && total > memorySoftBudget) {
+      if (!memorySoftWarned)
+        fprintf(stderr,
+                "Warning: Loading %s %s raised resource memory to %zu bytes, over "
+                "the soft budget of %zu\n",
+                kind, name.c_str(), total, memorySoftBudget);
+      memorySoftWarned = true;
+    } else {
+      memorySoftWarned = false;
+    }
+    return true;
+  }
+
+  Napi::Value GetMemoryStats(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+    MemoryUsage usage = MeasureMemory();
+    auto group = [&](int count, size_t bytes) {
+      Napi::Object object = Napi::Object::New(env);
+      object.Set("count", count);
+      object.Set("bytes", (double)bytes);
+      return object;
+    };
+
+    Napi::Object stats = Napi::Object::New(env);
+    stats.Set("textures", group(usage.textures, usage.textureBytes));
+    stats.Set("fonts", group(usage.fonts, usage.fontBytes));
+    stats.Set("sounds", group(usage.audio.sounds, usage.audio.soundBytes));
+    stats.Set("music", group(usage.audio.music, usage.audio.musicBytes));
+    stats.Set("total", (double)usage.total());
+    Napi::Object budget = Napi::Object::New(env);
+    budget.Set("soft", (double)memorySoftBudget);
+    budget.Set("hard", (double)memoryHardBudget);
+    stats.Set("budget", budget);
+    return stats;
+  }
+
+  Napi::Value SetMemoryBudget(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || !info[0].IsNumber()) {
+      Napi::TypeError::New(env, "Expected soft budget in bytes")
+          .ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    double soft = info[0].As<Napi::Number>().DoubleValue();
+    double hard = info.Length() >= 2 && info[1].IsNumber()
+                      ? info[1].As<Napi::Number>().DoubleValue()
+                      : 0.0;
+    memorySoftBudget = soft > 0.0 ? (size_t)soft : 0;
+    memoryHardBudget = hard > 0.0 ? (size_t)hard : 0;
+    memorySoftWarned = false;
+    return env.Undefined();
+  }
+
   Napi::Value GetWidth(const Napi::CallbackInfo &info) {
     return Napi::Number::New(info.Env(), windowWidth);
   }
@@ -405,6 +1011,79 @@ public:
     return Napi::Number::New(info.Env(), timer->getFPS());
   }
 
+  Napi::Value SetFixedTimestep(const Napi::CallbackInfo &info) {
+    double seconds = info.Length() >= 1 && info[0].IsNumber()
+                         ? info[0].As<Napi::Number>().DoubleValue()
+                         : 0.0;
+    if (inputReplay)
+      liveFixedStep = seconds;
+    else
+      timer->setFixedStep(seconds);
+    return info.Env().Undefined();
+  }
+
+  // Records input from the next frame on. The random stream is reseeded
+  // (with options.seed or the current seed) so a replay starts from the
+  // same state; options.timestep fixes the clock for the session.
+  Napi::Value StartRecording(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || !info[0].IsString()) {
+      Napi::TypeError::New(env, "Expected path argument").ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    uint64_t seed = random->getSeed();
+    double timestep = timer->getFixedStep();
+    if (info.Length() >= 2 && info[1].IsObject()) {
+      Napi::Object options = info[1].As<Napi::Object>();
+      if (options.Has("seed"))
+        seed = (uint64_t)options.Get("seed").As<Napi::Number>().Int64Value();
+      if (options.Has("timestep"))
+        timestep = options.Get("timestep").As<Napi::Number>().DoubleValue();
+    }
+
+    inputRecorder.reset();
+    auto recorder = std::make_unique<InputLogWriter>(
+        info[0].As<Napi::String>().Utf8Value(), seed, std::max(0.0, timestep));
+    if (!recorder->isOpen())
+      return Napi::Boolean::New(env, false);
+    Reseed(seed);
+    timer->setFixedStep(timestep);
+    inputRecorder = std::move(recorder);
+    recordFrame = 0;
+    return Napi::Boolean::New(env, true);
+  }
+
+  Napi::Value StopRecording(const Napi::CallbackInfo &info) {
+    bool ok = inputRecorder && inputRecorder->close();
+    inputRecorder.reset();
+    return Napi::Boolean::New(info.Env(), ok);
+  }
+
+  // Replays a recording from the next frame on, in place of live input,
+  // with the recorded seed and clock. Live input resumes when it ends.
+  Napi::Value StartReplay(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || !info[0].IsString()) {
+      Napi::TypeError::New(env, "Expected path argument").ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    auto replay = std::make_unique<InputLogReader>(info[0].As<Napi::String>().Utf8Value());
+    if (!replay->isOpen())
+      return Napi::Boolean::New(env, false);
+    if (!inputReplay)
+      liveFixedStep = timer->getFixedStep();
+    Reseed(replay->getSeed());
+    timer->setFixedStep(replay->getTimestep());
+    inputReplay = std::move(replay);
+    replayFrame = 0;
+    return Napi::Boolean::New(env, true);
+  }
+
+  Napi::Value StopReplay(const Napi::CallbackInfo &info) {
+    StopReplayInput();
+    return info.Env().Undefined();
+  }
+
   Napi::Value Clear(const Napi::CallbackInfo &info) {
     if (info.Length() >= 4) {
       Color color(info[0].As<Napi::Number>().Uint32Value(),
@@ -524,6 +1203,142 @@ public:
     return info.Env().Undefined();
   }
 
+  Napi::Value CreateCanvas(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 2) {
+      Napi::TypeError::New(env, "Expected width and height arguments")
+          .ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+
+    int width = info[0].As<Napi::Number>().Int32Value();
+    int height = info[1].As<Napi::Number>().Int32Value();
+    auto canvas = graphics->createCanvas(width, height);
+    if (!canvas) {
+      return env.Undefined();
+    }
+
+    std::string key = "canvas:" + std::to_string(nextCanvasId++);
+    if (!WithinMemoryBudget(MeasureMemory().total() + canvas->bytes(), "canvas", key)) {
+      graphics->retire(std::move(canvas));
+      return env.Undefined();
+    }
+    StoreTexture(key, canvas);
+    return Napi::String::New(env, key);
+  }
+
+  Napi::Value SetCanvas(const Napi::CallbackInfo &info) {
+    if (info.Length() < 1 || !info[0].IsString()) {
+      graphics->setCanvas(nullptr);
+      return info.Env().Undefined();
+    }
+
+    std::string key = info[0].As<Napi::String>().Utf8Value();
+    auto it = textures.find(key);
+    if (it != textures.end()) {
+      graphics->setCanvas(it->second);
+    }
+    return info.Env().Undefined();
+  }
+
+  Napi::Value SetDeferred(const Napi::CallbackInfo &info) {
+    if (info.Length() >= 1) {
+      graphics->setDeferred(info[0].As<Napi::Boolean>().Value());
+    }
+    return info.Env().Undefined();
+  }
+
+  Napi::Value SetLayer(const Napi::CallbackInfo &info) {
+    if (info.Length() >= 1) {
+      graphics->setLayer(info[0].As<Napi::Number>().Int32Value());
+    }
+    return info.Env().Undefined();
+  }
+
+  Napi::Value SetRenderThread(const Napi::CallbackInfo &info) {
+    if (info.Length() >= 1)
+      graphics->setThreaded(info[0].As<Napi::Boolean>().Value());
+    return info.Env().Undefined();
+  }
+
+  Napi::Value SetRetained(const Napi::CallbackInfo &info) {
+    if (info.Length() >= 1)
+      graphics->setRetained(info[0].As<Napi::Boolean>().Value());
+    return info.Env().Undefined();
+  }
+
+  Napi::Value SetIdleFrameRate(const Napi::CallbackInfo &info) {
+    if (info.Length() >= 1 && info[0].IsNumber())
+      graphics->setIdleFrameRate(info[0].As<Napi::Number>().DoubleValue());
+    return info.Env().Undefined();
+  }
+
+  Napi::Value Invalidate(const Napi::CallbackInfo &info) {
+    graphics->invalidate();
+    return info.Env().Undefined();
+  }
+
+  Napi::Value StartCapture(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || !info[0].IsString()) {
+      Napi::TypeError::New(env, "Expected path argument").ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+
+    Capture::Options options;
+    options.path = info[0].As<Napi::String>().Utf8Value();
+    if (info.Length() >= 2 && info[1].IsObject()) {
+      Napi::Object object = info[1].As<Napi::Object>();
+      if (object.Has("format")) {
+        std::string format = object.Get("format").As<Napi::String>().Utf8Value();
+        if (format == "png")
+          options.format = Capture::Format::PNG;
+        else if (format == "y4m")
+          options.format = Capture::Format::Y4M;
+        else if (format == "rgba")
+          options.format = Capture::Format::RGBA;
+        else {
+          Napi::TypeError::New(env, "Unknown capture format: " + format)
+              .ThrowAsJavaScriptException();
+          return env.Undefined();
+        }
+      }
+      if (object.Has("buffers"))
+        options.buffers = object.Get("buffers").As<Napi::Number>().Int32Value();
+      if (object.Has("threads"))
+        options.threads = object.Get("threads").As<Napi::Number>().Int32Value();
+      if (object.Has("fps"))
+        options.fps = object.Get("fps").As<Napi::Number>().Int32Value();
+    }
+
+    StopCaptureOutput();
+    int width = 0, height = 0;
+    graphics->runOnRenderer([&] { SDL_GetRendererOutputSize(renderer, &width, &height); });
+    auto next = std::make_shared<Capture>(options, width, height);
+    if (!next->isOpen())
+      return Napi::Boolean::New(env, false);
+    capture = next;
+    graphics->setCapture(capture);
+    return Napi::Boolean::New(env, true);
+  }
+
+  Napi::Value StopCapture(const Napi::CallbackInfo &info) {
+    StopCaptureOutput();
+    return info.Env().Undefined();
+  }
+
+  void StopCaptureOutput() {
+    if (!capture)
+      return;
+    graphics->setCapture(nullptr);
+    capture->finish();
+  }
+
+  Napi::Value Flush(const Napi::CallbackInfo &info) {
+    graphics->flush();
+    return info.Env().Undefined();
+  }
+
   Napi::Value DrawText(const Napi::CallbackInfo &info) {
     if (info.Length() >= 3) {
       std::string text = info[0].As<Napi::String>().Utf8Value();
@@ -551,8 +1366,9 @@ public:
     }
 
     Napi::Array pointsArray = info[0].As<Napi::Array>();
-    std::vector<Vec2> vertices;
-    for (unsigned int i = 0; i < pointsArray.Length(); ++i) {
+    uint32_t count = pointsArray.Length();
+    Vec2 *vertices = graphics->getArena().alloc<Vec2>(count);
+    for (unsigned int i = 0; i < count; ++i) {
       Napi::Value pointValue = pointsArray[i];
       if (!pointValue.IsObject()) {
         Napi::TypeError::New(env, "Expected array of objects with x and y properties").ThrowAsJavaScriptException();
@@ -565,7 +1381,7 @@ public:
       }
       float x = pointObject.Get("x").As<Napi::Number>().FloatValue();
       float y = pointObject.Get("y").As<Napi::Number>().FloatValue();
-      vertices.push_back({x, y});
+      vertices[i] = Vec2(x, y);
     }
 
     bool filled = false;
@@ -573,7 +1389,7 @@ public:
       filled = info[1].As<Napi::Boolean>().Value();
     }
 
-    graphics->drawPolygon(vertices, filled);
+    graphics->drawPolygon(vertices, count, filled);
     return env.Undefined();
   }
 
@@ -601,6 +1417,21 @@ public:
     return info.Env().Undefined();
   }
 
+  Napi::Value PlaySoundAt(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+    if (info.Length() >= 2) {
+      std::string path = info[0].As<Napi::String>().Utf8Value();
+      int emitter = info[1].As<Napi::Number>().Int32Value();
+      auto sound = audio->loadSound(path);
+      if (sound) {
+        int volume =
+            info.Length() >= 3 ? info[2].As<Napi::Number>().Int32Value() : 128;
+        return Napi::Number::New(env, audio->playSoundAt(sound, emitter, volume));
+      }
+    }
+    return Napi::Number::New(env, -1);
+  }
+
   Napi::Value PlayMusic(const Napi::CallbackInfo &info) {
     if (info.Length() >= 1) {
       std::string path = info[0].As<Napi::String>().Utf8Value();
@@ -619,53 +1450,1462 @@ public:
     return info.Env().Undefined();
   }
 
-  Napi::Value SetMusicVolume(const Napi::CallbackInfo &info) {
+  Napi::Value PreloadMusic(const Napi::CallbackInfo &info) {
     if (info.Length() >= 1) {
-      int volume = info[0].As<Napi::Number>().Int32Value();
-      audio->setMusicVolume(volume);
+      audio->preloadMusic(info[0].As<Napi::String>().Utf8Value());
     }
     return info.Env().Undefined();
   }
 
-  Napi::Value RandomInt(const Napi::CallbackInfo &info) {
+  Napi::Value CrossfadeMusic(const Napi::CallbackInfo &info) {
     if (info.Length() >= 2) {
-      int min = info[0].As<Napi::Number>().Int32Value();
-      int max = info[1].As<Napi::Number>().Int32Value();
-      return Napi::Number::New(info.Env(), random->randomInt(min, max));
+      std::string path = info[0].As<Napi::String>().Utf8Value();
+      int fadeMs = info[1].As<Napi::Number>().Int32Value();
+      int loops =
+          info.Length() >= 3 ? info[2].As<Napi::Number>().Int32Value() : -1;
+      audio->crossfadeMusic(path, fadeMs, loops);
     }
-    return Napi::Number::New(info.Env(), random->randomInt(0, 1));
+    return info.Env().Undefined();
   }
 
-  Napi::Value RandomFloat(const Napi::CallbackInfo &info) {
+  Napi::Value SetMusicLoopPoints(const Napi::CallbackInfo &info) {
     if (info.Length() >= 2) {
-      float min = info[0].As<Napi::Number>().FloatValue();
-      float max = info[1].As<Napi::Number>().FloatValue();
-      return Napi::Number::New(info.Env(), random->randomFloat(min, max));
+      audio->setMusicLoopPoints(info[0].As<Napi::Number>().DoubleValue(),
+                                info[1].As<Napi::Number>().DoubleValue());
     }
-    return Napi::Number::New(info.Env(), random->randomFloat());
+    return info.Env().Undefined();
   }
 
-  Napi::Value RandomBool(const Napi::CallbackInfo &info) {
-    return Napi::Boolean::New(info.Env(), random->randomBool());
+  Napi::Value SetMusicVolume(const Napi::CallbackInfo &info) {
+    if (info.Length() >= 1) {
+      int volume = info[0].As<Napi::Number>().Int32Value();
+      audio->setMusicVolume(volume);
+    }
+    return info.Env().Undefined();
   }
-};
 
-Napi::Object CreateTensai(const Napi::CallbackInfo &info) {
-  Napi::Env env = info.Env();
+  Napi::Value SetVoices(const Napi::CallbackInfo &info) {
+    if (info.Length() >= 1) {
+      audio->setVoiceCount(info[0].As<Napi::Number>().Int32Value());
+    }
+    return info.Env().Undefined();
+  }
 
-  if (info.Length() < 5) {
-    Napi::TypeError::New(env, "Expected 5 arguments")
-        .ThrowAsJavaScriptException();
-    return Napi::Object::New(env);
+  Napi::Value SetVoiceStealPolicy(const Napi::CallbackInfo &info) {
+    if (info.Length() >= 1) {
+      std::string policy = info[0].As<Napi::String>().Utf8Value();
+      audio->setStealPolicy(policy == "quietest" ? Audio::StealPolicy::Quietest
+                                                 : Audio::StealPolicy::Oldest);
+    }
+    return info.Env().Undefined();
   }
 
-  Napi::FunctionReference *constructor =
-      env.GetInstanceData<Napi::FunctionReference>();
-  return constructor->New({info[0], info[1], info[2], info[3], info[4]});
+  Napi::Value SetSoundPriority(const Napi::CallbackInfo &info) {
+    if (info.Length() >= 2) {
+      auto sound = audio->getSound(info[0].As<Napi::String>().Utf8Value());
+      if (sound) {
+        sound->priority = info[1].As<Napi::Number>().Int32Value();
+      }
+    }
+    return info.Env().Undefined();
+  }
+
+  Napi::Value SetSoundMaxInstances(const Napi::CallbackInfo &info) {
+    if (info.Length() >= 2) {
+      auto sound = audio->getSound(info[0].As<Napi::String>().Utf8Value());
+      if (sound) {
+        sound->maxInstances = info[1].As<Napi::Number>().Int32Value();
+      }
+    }
+    return info.Env().Undefined();
+  }
+
+  Napi::Value CreateEmitter(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 3) {
+      Napi::TypeError::New(env, "Expected x, y and range arguments")
+          .ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    Vec2 pos(info[0].As<Napi::Number>().FloatValue(),
+             info[1].As<Napi::Number>().FloatValue());
+    float range = info[2].As<Napi::Number>().FloatValue();
+    return Napi::Number::New(env, audio->createEmitter(pos, range));
+  }
+
+  Napi::Value DestroyEmitter(const Napi::CallbackInfo &info) {
+    if (info.Length() >= 1) {
+      audio->destroyEmitter(info[0].As<Napi::Number>().Int32Value());
+    }
+    return info.Env().Undefined();
+  }
+
+  Napi::Value SetEmitterPosition(const Napi::CallbackInfo &info) {
+    if (info.Length() >= 3) {
+      Vec2 pos(info[1].As<Napi::Number>().FloatValue(),
+               info[2].As<Napi::Number>().FloatValue());
+      audio->setEmitterPosition(info[0].As<Napi::Number>().Int32Value(), pos);
+    }
+    return info.Env().Undefined();
+  }
+
+  Napi::Value SetEmitterPositions(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 2 || !IsTypedArrayOf(info[0], napi_int32_array) ||
+        !IsTypedArrayOf(info[1], napi_float32_array)) {
+      Napi::TypeError::New(env, "Expected Int32Array ids and Float32Array positions")
+          .ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    Napi::Int32Array ids = info[0].As<Napi::Int32Array>();
+    Napi::Float32Array positions = info[1].As<Napi::Float32Array>();
+    size_t count = std::min(ids.ElementLength(), positions.ElementLength() / 2);
+    audio->setEmitterPositions(ids.Data(), positions.Data(), count);
+    return env.Undefined();
+  }
+
+  Napi::Value SetCamera(const Napi::CallbackInfo &info) {
+    if (info.Length() >= 2) {
+      Camera &camera = graphics->getCamera();
+      camera.position = Vec2(info[0].As<Napi::Number>().FloatValue(),
+                             info[1].As<Napi::Number>().FloatValue());
+      if (info.Length() >= 3)
+        camera.rotation = info[2].As<Napi::Number>().FloatValue();
+      if (info.Length() >= 4) {
+        float zoom = info[3].As<Napi::Number>().FloatValue();
+        camera.scale = Vec2(zoom, zoom);
+      }
+    }
+    return info.Env().Undefined();
+  }
+
+  Napi::Value GetStats(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+    Napi::Object stats = Napi::Object::New(env);
+
+    Audio::VoiceStats voices = audio->getVoiceStats();
+    Napi::Object audioStats = Napi::Object::New(env);
+    audioStats.Set("voices", voices.voices);
+    audioStats.Set("activeVoices", voices.active);
+    audioStats.Set("peakVoices", voices.peak);
+    audioStats.Set("played", (double)voices.played);
+    audioStats.Set("stolen", (double)voices.stolen);
+    audioStats.Set("dropped", (double)voices.dropped);
+    Audio::MixerStats mixer = audio->getMixerStats();
+    audioStats.Set("frequency", mixer.frequency);
+    audioStats.Set("bufferFrames", mixer.bufferFrames);
+    audioStats.Set("bufferMs", mixer.bufferMs);
+    audioStats.Set("mixCallbacks", (double)mixer.callbacks);
+    audioStats.Set("underruns", (double)mixer.underruns);
+    audioStats.Set("avgCallbackGapMs", mixer.avgGapMs);
+    audioStats.Set("maxCallbackGapMs", mixer.maxGapMs);
+    stats.Set("audio", audioStats);
+
+    Napi::Object renderStats = Napi::Object::New(env);
+    renderStats.Set("backend", graphics->isSoftware() ? "software" : "sdl");
+    renderStats.Set("threaded", graphics->isThreaded());
+    renderStats.Set("commands", (double)graphics->getCommandCount());
+    renderStats.Set("presentWaitMs", graphics->getPresentWaitMs());
+    renderStats.Set("retained", graphics->isRetained());
+    SDL_Rect dirty = graphics->getDirtyBounds();
+    Napi::Object dirtyStats = Napi::Object::New(env);
+    dirtyStats.Set("x", dirty.x);
+    dirtyStats.Set("y", dirty.y);
+    dirtyStats.Set("width", dirty.w);
+    dirtyStats.Set("height", dirty.h);
+    renderStats.Set("dirty", dirtyStats);
+    renderStats.Set("dirtyRects", (double)graphics->getDirtyRectCount());
+    FrameArena &arena = graphics->getArena();
+    Napi::Object arenaStats = Napi::Object::New(env);
+    arenaStats.Set("used", (double)arena.getUsed());
+    arenaStats.Set("capacity", (double)arena.getCapacity());
+    arenaStats.Set("highWater", (double)arena.getHighWater());
+    renderStats.Set("arena", arenaStats);
+    if (residency) {
+      TextureResidency::Stats residencyStats = residency->getStats();
+      Napi::Object textureStats = Napi::Object::New(env);
+      textureStats.Set("budget", (double)residency->getBudget());
+      textureStats.Set("tracked", residencyStats.tracked);
+      textureStats.Set("resident", residencyStats.resident);
+      textureStats.Set("residentBytes", (double)residencyStats.residentBytes);
+      textureStats.Set("pending", residencyStats.pending);
+      textureStats.Set("evictions", (double)residencyStats.evictions);
+      textureStats.Set("reloads", (double)residencyStats.reloads);
+      textureStats.Set("failures", (double)residencyStats.failures);
+      renderStats.Set("residency", textureStats);
+    }
+    stats.Set("render", renderStats);
+
+    Napi::Object captureStats = Napi::Object::New(env);
+    Capture::Stats recorded = capture ? capture->getStats() : Capture::Stats();
+    captureStats.Set("recording", capture && capture->isOpen());
+    captureStats.Set("captured", (double)recorded.captured);
+    captureStats.Set("dropped", (double)recorded.dropped);
+    captureStats.Set("written", (double)recorded.written);
+    captureStats.Set("failed", (double)recorded.failed);
+    captureStats.Set("pending", (double)recorded.pending);
+    stats.Set("capture", captureStats);
+
+    Napi::Object inputStats = Napi::Object::New(env);
+    inputStats.Set("recording", inputRecorder != nullptr);
+    inputStats.Set("replaying", inputReplay != nullptr);
+    inputStats.Set("recordFrame", (double)recordFrame);
+    inputStats.Set("replayFrame", (double)replayFrame);
+    stats.Set("input", inputStats);
+
+    Napi::Object ecsStats = Napi::Object::New(env);
+    ecsStats.Set("entities", (double)entities.size());
+    ecsStats.Set("archetypes", (double)entities.archetypeCount());
+    stats.Set("ecs", ecsStats);
+
+    return stats;
+  }
+
+  Napi::Value RandomInt(const Napi::CallbackInfo &info) {
+    if (info.Length() >= 2) {
+      int min = info[0].As<Napi::Number>().Int32Value();
+      int max = info[1].As<Napi::Number>().Int32Value();
+      return Napi::Number::New(info.Env(), random->randomInt(min, max));
+    }
+    return Napi::Number::New(info.Env(), random->randomInt(0, 1));
+  }
+
+  Napi::Value RandomFloat(const Napi::CallbackInfo &info) {
+    if (info.Length() >= 2) {
+      float min = info[0].As<Napi::Number>().FloatValue();
+      float max = info[1].As<Napi::Number>().FloatValue();
+      return Napi::Number::New(info.Env(), random->randomFloat(min, max));
+    }
+    return Napi::Number::New(info.Env(), random->randomFloat());
+  }
+
+  Napi::Value RandomBool(const Napi::CallbackInfo &info) {
+    return Napi::Boolean::New(info.Env(), random->randomBool());
+  }
+
+  Napi::Value SetSeed(const Napi::CallbackInfo &info) {
+    if (info.Length() >= 1)
+      Reseed((uint64_t)info[0].As<Napi::Number>().Int64Value());
+    return info.Env().Undefined();
+  }
+
+  Napi::Value GetSeed(const Napi::CallbackInfo &info) {
+    return Napi::Number::New(info.Env(), (double)random->getSeed());
+  }
+
+  Napi::Value FillRandomFloat(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || !IsTypedArrayOf(info[0], napi_float32_array)) {
+      Napi::TypeError::New(env, "Expected a Float32Array")
+          .ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    Napi::Float32Array out = info[0].As<Napi::Float32Array>();
+    float min = info.Length() >= 2 ? info[1].As<Napi::Number>().FloatValue() : 0.0f;
+    float max = info.Length() >= 3 ? info[2].As<Napi::Number>().FloatValue() : 1.0f;
+    random->fillFloat(out.Data(), out.ElementLength(), min, max);
+    return out;
+  }
+
+  Napi::Value FillRandomInt(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 3 || !IsTypedArrayOf(info[0], napi_int32_array)) {
+      Napi::TypeError::New(env, "Expected an Int32Array, min and max")
+          .ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    Napi::Int32Array out = info[0].As<Napi::Int32Array>();
+    int min = info[1].As<Napi::Number>().Int32Value();
+    int max = info[2].As<Napi::Number>().Int32Value();
+    random->fillInt(out.Data(), out.ElementLength(), min, max);
+    return out;
+  }
+  SpatialIndex *GetSpatialIndex(const Napi::Value &value) {
+    if (!value.IsNumber())
+      return nullptr;
+    int handle = value.As<Napi::Number>().Int32Value();
+    if (handle < 0 || handle >= (int)spatialIndices.size())
+      return nullptr;
+    return spatialIndices[handle].get();
+  }
+
+  Napi::Value QueryResults(Napi::Env env) {
+    Napi::Int32Array result = Napi::Int32Array::New(env, queryResults.size());
+    std::copy(queryResults.begin(), queryResults.end(), result.Data());
+    return result;
+  }
+
+  Napi::Value CreateSpatialIndex(const Napi::CallbackInfo &info) {
+    float cellSize = 64.0f;
+    if (info.Length() >= 1 && info[0].IsNumber())
+      cellSize = info[0].As<Napi::Number>().FloatValue();
+    auto index = std::make_unique<SpatialIndex>(cellSize);
+
+    // Reuse destroyed slots so handles stay small.
+    for (size_t i = 0; i < spatialIndices.size(); i++) {
+      if (!spatialIndices[i]) {
+        spatialIndices[i] = std::move(index);
+        return Napi::Number::New(info.Env(), (double)i);
+      }
+    }
+    spatialIndices.push_back(std::move(index));
+    return Napi::Number::New(info.Env(), (double)(spatialIndices.size() - 1));
+  }
+
+  Napi::Value DestroySpatialIndex(const Napi::CallbackInfo &info) {
+    if (info.Length() >= 1 && GetSpatialIndex(info[0]))
+      spatialIndices[info[0].As<Napi::Number>().Int32Value()].reset();
+    return info.Env().Undefined();
+  }
+
+  Napi::Value BuildSpatialIndex(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+    SpatialIndex *index = info.Length() >= 2 ? GetSpatialIndex(info[0]) : nullptr;
+    if (!index || !IsTypedArrayOf(info[1], napi_float32_array)) {
+      Napi::TypeError::New(env, "Expected a spatial index and a Float32Array")
+          .ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    Napi::Float32Array boxes = info[1].As<Napi::Float32Array>();
+    index->build(boxes.Data(), boxes.ElementLength() / 4);
+    return env.Undefined();
+  }
+
+  Napi::Value UpdateSpatialIndex(const Napi::CallbackInfo &info) {
+    SpatialIndex *index = info.Length() >= 6 ? GetSpatialIndex(info[0]) : nullptr;
+    if (index) {
+      Physics::AABB box = {Vec2(info[2].As<Napi::Number>().FloatValue(),
+                                info[3].As<Napi::Number>().FloatValue()),
+                           Vec2(info[4].As<Napi::Number>().FloatValue(),
+                                info[5].As<Napi::Number>().FloatValue())};
+      index->update(info[1].As<Napi::Number>().Int32Value(), box);
+    }
+    return info.Env().Undefined();
+  }
+
+  Napi::Value RemoveFromSpatialIndex(const Napi::CallbackInfo &info) {
+    SpatialIndex *index = info.Length() >= 2 ? GetSpatialIndex(info[0]) : nullptr;
+    if (index)
+      index->remove(info[1].As<Napi::Number>().Int32Value());
+    return info.Env().Undefined();
+  }
+
+  Napi::Value QueryAABB(const Napi::CallbackInfo &info) {
+    queryResults.clear();
+    SpatialIndex *index = info.Length() >= 5 ? GetSpatialIndex(info[0]) : nullptr;
+    if (index) {
+      Physics::AABB box = {Vec2(info[1].As<Napi::Number>().FloatValue(),
+                                info[2].As<Napi::Number>().FloatValue()),
+                           Vec2(info[3].As<Napi::Number>().FloatValue(),
+                                info[4].As<Napi::Number>().FloatValue())};
+      index->queryAABB(box, queryResults);
+    }
+    return QueryResults(info.Env());
+  }
+
+  Napi::Value QueryCircle(const Napi::CallbackInfo &info) {
+    queryResults.clear();
+    SpatialIndex *index = info.Length() >= 4 ? GetSpatialIndex(info[0]) : nullptr;
+    if (index) {
+      Vec2 center(info[1].As<Napi::Number>().FloatValue(),
+                  info[2].As<Napi::Number>().FloatValue());
+      index->queryCircle(center, info[3].As<Napi::Number>().FloatValue(), queryResults);
+    }
+    return QueryResults(info.Env());
+  }
+
+  Napi::Value Raycast(const Napi::CallbackInfo &info) {
+    queryResults.clear();
+    SpatialIndex *index = info.Length() >= 5 ? GetSpatialIndex(info[0]) : nullptr;
+    if (index) {
+      Vec2 origin(info[1].As<Napi::Number>().FloatValue(),
+                  info[2].As<Napi::Number>().FloatValue());
+      Vec2 direction(info[3].As<Napi::Number>().FloatValue(),
+                     info[4].As<Napi::Number>().FloatValue());
+      float maxDistance = info.Length() >= 6 && info[5].IsNumber()
+                              ? info[5].As<Napi::Number>().FloatValue()
+                              : std::numeric_limits<float>::infinity();
+      index->raycast(origin, direction, maxDistance, queryResults);
+    }
+    return QueryResults(info.Env());
+  }
+
+  Napi::Value QueryPairs(const Napi::CallbackInfo &info) {
+    queryResults.clear();
+    SpatialIndex *index = info.Length() >= 1 ? GetSpatialIndex(info[0]) : nullptr;
+    if (index)
+      index->queryPairs(queryResults);
+    return QueryResults(info.Env());
+  }
+
+  TileMap *GetTileMap(const Napi::Value &value) {
+    if (!value.IsNumber())
+      return nullptr;
+    int handle = value.As<Napi::Number>().Int32Value();
+    if (handle < 0 || handle >= (int)tileMaps.size())
+      return nullptr;
+    return tileMaps[handle].get();
+  }
+
+  Napi::Value CreateTileMap(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 3) {
+      Napi::TypeError::New(env, "Expected width, height and tileSize arguments")
+          .ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    Vec2 origin;
+    if (info.Length() >= 5) {
+      origin = Vec2(info[3].As<Napi::Number>().FloatValue(),
+                    info[4].As<Napi::Number>().FloatValue());
+    }
+    auto map = std::make_unique<TileMap>(info[0].As<Napi::Number>().Int32Value(),
+                                         info[1].As<Napi::Number>().Int32Value(),
+                                         info[2].As<Napi::Number>().FloatValue(), origin);
+
+    for (size_t i = 0; i < tileMaps.size(); i++) {
+      if (!tileMaps[i]) {
+        tileMaps[i] = std::move(map);
+        return Napi::Number::New(env, (double)i);
+      }
+    }
+    tileMaps.push_back(std::move(map));
+    return Napi::Number::New(env, (double)(tileMaps.size() - 1));
+  }
+
+  Napi::Value DestroyTileMap(const Napi::CallbackInfo &info) {
+    if (info.Length() >= 1 && GetTileMap(info[0]))
+      tileMaps[info[0].As<Napi::Number>().Int32Value()].reset();
+    return info.Env().Undefined();
+  }
+
+  Napi::Value SetTiles(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+    TileMap *map = info.Length() >= 2 ? GetTileMap(info[0]) : nullptr;
+    if (!map || !IsTypedArrayOf(info[1], napi_uint8_array)) {
+      Napi::TypeError::New(env, "Expected a tile map and a Uint8Array")
+          .ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    Napi::Uint8Array data = info[1].As<Napi::Uint8Array>();
+    map->setTiles(data.Data(), data.ElementLength());
+    return env.Undefined();
+  }
+
+  Napi::Value SetTile(const Napi::CallbackInfo &info) {
+    TileMap *map = info.Length() >= 4 ? GetTileMap(info[0]) : nullptr;
+    if (map) {
+      map->setTile(info[1].As<Napi::Number>().Int32Value(),
+                   info[2].As<Napi::Number>().Int32Value(),
+                   (uint8_t)info[3].As<Napi::Number>().Uint32Value());
+    }
+    return info.Env().Undefined();
+  }
+
+  Napi::Value GetTile(const Napi::CallbackInfo &info) {
+    TileMap *map = info.Length() >= 3 ? GetTileMap(info[0]) : nullptr;
+    if (!map)
+      return Napi::Number::New(info.Env(), TileMap::Empty);
+    return Napi::Number::New(info.Env(),
+                             map->getTile(info[1].As<Napi::Number>().Int32Value(),
+                                          info[2].As<Napi::Number>().Int32Value()));
+  }
+
+  Napi::Value MoveAndCollide(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+    TileMap *map = info.Length() >= 4 ? GetTileMap(info[0]) : nullptr;
+    if (!map || !info[1].IsObject()) {
+      Napi::TypeError::New(env, "Expected a tile map, a body and dx, dy")
+          .ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+
+    // The body is any {x, y, width, height} object; x and y are written back,
+    // and vx/vy, when present, lose their component into each contact.
+    Napi::Object body = info[1].As<Napi::Object>();
+    float x = body.Get("x").As<Napi::Number>().FloatValue();
+    float y = body.Get("y").As<Napi::Number>().FloatValue();
+    Vec2 size(body.Get("width").As<Napi::Number>().FloatValue(),
+              body.Get("height").As<Napi::Number>().FloatValue());
+    Physics::AABB box = {Vec2(x, y), Vec2(x, y) + size};
+    Vec2 delta(info[2].As<Napi::Number>().FloatValue(),
+               info[3].As<Napi::Number>().FloatValue());
+    if (!std::isfinite(delta.x) || !std::isfinite(delta.y)) {
+      Napi::TypeError::New(env, "Expected finite dx and dy").ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    TileMap::MoveResult result = map->moveAndCollide(box, delta);
+    body.Set("x", Napi::Number::New(env, box.min.x));
+    body.Set("y", Napi::Number::New(env, box.min.y));
+
+    if (body.Has("vx") && body.Has("vy")) {
+      Vec2 velocity(body.Get("vx").As<Napi::Number>().FloatValue(),
+                    body.Get("vy").As<Napi::Number>().FloatValue());
+      for (const TileMap::Contact &contact : result.contacts) {
+        float into = velocity.dot(contact.normal);
+        if (into < 0.0f)
+          velocity = velocity - contact.normal * into;
+      }
+      body.Set("vx", Napi::Number::New(env, velocity.x));
+      body.Set("vy", Napi::Number::New(env, velocity.y));
+    }
+
+    Napi::Array normals = Napi::Array::New(env, result.contacts.size());
+    for (size_t i = 0; i < result.contacts.size(); i++) {
+      Napi::Object normal = Napi::Object::New(env);
+      normal.Set("x", Napi::Number::New(env, result.contacts[i].normal.x));
+      normal.Set("y", Napi::Number::New(env, result.contacts[i].normal.y));
+      normal.Set("tileX", Napi::Number::New(env, result.contacts[i].tileX));
+      normal.Set("tileY", Napi::Number::New(env, result.contacts[i].tileY));
+      normals.Set((uint32_t)i, normal);
+    }
+    Napi::Object out = Napi::Object::New(env);
+    out.Set("dx", Napi::Number::New(env, result.delta.x));
+    out.Set("dy", Napi::Number::New(env, result.delta.y));
+    out.Set("grounded", Napi::Boolean::New(env, result.grounded));
+    out.Set("contacts", normals);
+    return out;
+  }
+
+  PhysicsWorld *GetPhysicsWorld(const Napi::Value &value) {
+    if (!value.IsNumber())
+      return nullptr;
+    int handle = value.As<Napi::Number>().Int32Value();
+    if (handle < 0 || handle >= (int)physicsWorlds.size())
+      return nullptr;
+    return physicsWorlds[handle].get();
+  }
+
+  PhysicsWorld::Object *GetBody(const Napi::CallbackInfo &info) {
+    PhysicsWorld *world = info.Length() >= 2 ? GetPhysicsWorld(info[0]) : nullptr;
+    if (!world || !info[1].IsNumber())
+      return nullptr;
+    return world->get(info[1].As<Napi::Number>().Int32Value());
+  }
+
+  Napi::Value CreatePhysicsWorld(const Napi::CallbackInfo &info) {
+    float cellSize = 64.0f;
+    if (info.Length() >= 1 && info[0].IsNumber())
+      cellSize = info[0].As<Napi::Number>().FloatValue();
+    auto world = std::make_unique<PhysicsWorld>(cellSize);
+
+    for (size_t i = 0; i < physicsWorlds.size(); i++) {
+      if (!physicsWorlds[i]) {
+        physicsWorlds[i] = std::move(world);
+        return Napi::Number::New(info.Env(), (double)i);
+      }
+    }
+    physicsWorlds.push_back(std::move(world));
+    return Napi::Number::New(info.Env(), (double)(physicsWorlds.size() - 1));
+  }
+
+  Napi::Value DestroyPhysicsWorld(const Napi::CallbackInfo &info) {
+    if (info.Length() >= 1 && GetPhysicsWorld(info[0]))
+      physicsWorlds[info[0].As<Napi::Number>().Int32Value()].reset();
+    return info.Env().Undefined();
+  }
+
+  Napi::Value SetGravity(const Napi::CallbackInfo &info) {
+    PhysicsWorld *world = info.Length() >= 3 ? GetPhysicsWorld(info[0]) : nullptr;
+    if (world) {
+      world->setGravity(Vec2(info[1].As<Napi::Number>().FloatValue(),
+                             info[2].As<Napi::Number>().FloatValue()));
+    }
+    return info.Env().Undefined();
+  }
+
+  Napi::Value AddBody(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+    PhysicsWorld *world = info.Length() >= 2 ? GetPhysicsWorld(info[0]) : nullptr;
+    if (!world || !info[1].IsObject()) {
+      Napi::TypeError::New(env, "Expected a physics world and body options")
+          .ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+
+    return Napi::Number::New(env, world->add(ParseBody(info[1].As<Napi::Object>())));
+  }
+
+  Napi::Value RemoveBody(const Napi::CallbackInfo &info) {
+    PhysicsWorld *world = info.Length() >= 2 ? GetPhysicsWorld(info[0]) : nullptr;
+    if (world)
+      world->remove(info[1].As<Napi::Number>().Int32Value());
+    return info.Env().Undefined();
+  }
+
+  Napi::Value SetBodyPosition(const Napi::CallbackInfo &info) {
+    PhysicsWorld::Object *object = GetBody(info);
+    if (object && info.Length() >= 4) {
+      object->body.position = Vec2(info[2].As<Napi::Number>().FloatValue(),
+                                   info[3].As<Napi::Number>().FloatValue());
+    }
+    return info.Env().Undefined();
+  }
+
+  Napi::Value SetBodyVelocity(const Napi::CallbackInfo &info) {
+    PhysicsWorld::Object *object = GetBody(info);
+    if (object && info.Length() >= 4) {
+      object->body.velocity = Vec2(info[2].As<Napi::Number>().FloatValue(),
+                                   info[3].As<Napi::Number>().FloatValue());
+    }
+    return info.Env().Undefined();
+  }
+
+  Napi::Value SetBodyBullet(const Napi::CallbackInfo &info) {
+    PhysicsWorld::Object *object = GetBody(info);
+    if (object && info.Length() >= 3)
+      object->body.bullet = info[2].As<Napi::Boolean>().Value();
+    return info.Env().Undefined();
+  }
+
+  Napi::Value ApplyForce(const Napi::CallbackInfo &info) {
+    PhysicsWorld::Object *object = GetBody(info);
+    if (object && info.Length() >= 4) {
+      Physics::applyForce(object->body, Vec2(info[2].As<Napi::Number>().FloatValue(),
+                                             info[3].As<Napi::Number>().FloatValue()));
+    }
+    return info.Env().Undefined();
+  }
+
+  Napi::Value GetBodyStates(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+    PhysicsWorld *world = info.Length() >= 2 ? GetPhysicsWorld(info[0]) : nullptr;
+    if (!world || !IsTypedArrayOf(info[1], napi_float32_array)) {
+      Napi::TypeError::New(env, "Expected a physics world and a Float32Array")
+          .ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+
+    // Four floats per body id: x, y, vx, vy. Removed ids are left untouched.
+    Napi::Float32Array out = info[1].As<Napi::Float32Array>();
+    float *data = out.Data();
+    size_t count = std::min(world->capacity(), out.ElementLength() / 4);
+    for (size_t id = 0; id < count; id++) {
+      PhysicsWorld::Object *object = world->get((int)id);
+      if (!object)
+        continue;
+      data[id * 4] = object->body.position.x;
+      data[id * 4 + 1] = object->body.position.y;
+      data[id * 4 + 2] = object->body.velocity.x;
+      data[id * 4 + 3] = object->body.velocity.y;
+    }
+    return out;
+  }
+
+  Napi::Value StepPhysics(const Napi::CallbackInfo &info) {
+    queryResults.clear();
+    PhysicsWorld *world = info.Length() >= 2 ? GetPhysicsWorld(info[0]) : nullptr;
+    if (world)
+      world->step(info[1].As<Napi::Number>().FloatValue(), queryResults);
+    return QueryResults(info.Env());
+  }
+
+  int TextureSlot(const std::string &key) {
+    auto slot = spriteTextureSlots.find(key);
+    if (slot != spriteTextureSlots.end())
+      return slot->second;
+    if (textures.find(key) == textures.end())
+      return -1;
+    spriteTextureKeys.push_back(key);
+    int id = (int)spriteTextureKeys.size() - 1;
+    spriteTextureSlots[key] = id;
+    return id;
+  }
+
+  const void *ColumnData(uint32_t key) {
+    size_t index = key / EntityStore::FieldCount;
+    if (index >= entities.archetypeCount())
+      return nullptr;
+    EntityStore::Archetype &archetype = entities.getArchetype(index);
+    uint32_t field = key % EntityStore::FieldCount;
+    if (field < EntityStore::FloatFieldCount)
+      return archetype.floats[field].data();
+    if (field == EntityStore::Texture)
+      return archetype.textures.data();
+    if (field == EntityStore::Tint)
+      return archetype.tints.data();
+    return archetype.entities.data();
+  }
+
+  // Called after structural changes. Views whose column kept its storage stay
+  // usable (rows past the current size read stale values); only those whose
+  // column reallocated are detached.
+  void InvalidateColumns() {
+    for (auto it = columnViews.begin(); it != columnViews.end();) {
+      if (ColumnData(it->first) == it->second.data) {
+        ++it;
+        continue;
+      }
+      Napi::ArrayBuffer buffer = it->second.buffer.Value();
+      if (!buffer.IsEmpty() && !buffer.IsDetached())
+        buffer.Detach();
+      it = columnViews.erase(it);
+    }
+  }
+
+  void ApplyEntityProps(uint32_t entity, const Napi::Value &value) {
+    if (!value.IsObject())
+      return;
+    Napi::Object props = value.As<Napi::Object>();
+    for (int field = 0; field < EntityStore::FloatFieldCount; field++) {
+      const char *name = EntityStore::fieldName((EntityStore::Field)field);
+      float *target = entities.floatField(entity, (EntityStore::Field)field);
+      if (target && props.Has(name))
+        *target = props.Get(name).As<Napi::Number>().FloatValue();
+    }
+    if (int32_t *texture = entities.textureField(entity); texture && props.Has("texture")) {
+      Napi::Value key = props.Get("texture");
+      *texture = key.IsString() ? TextureSlot(key.As<Napi::String>().Utf8Value())
+                                : key.As<Napi::Number>().Int32Value();
+    }
+    if (uint32_t *tint = entities.tintField(entity); tint && props.Has("tint"))
+      *tint = props.Get("tint").As<Napi::Number>().Uint32Value();
+  }
+
+  Napi::Value EntityResults(Napi::Env env) {
+    Napi::Uint32Array result = Napi::Uint32Array::New(env, entityResults.size());
+    std::copy(entityResults.begin(), entityResults.end(), result.Data());
+    return result;
+  }
+
+  Napi::Value GetTextureId(const Napi::CallbackInfo &info) {
+    int slot = info.Length() >= 1 && info[0].IsString()
+                   ? TextureSlot(info[0].As<Napi::String>().Utf8Value())
+                   : -1;
+    return Napi::Number::New(info.Env(), slot);
+  }
+
+  Napi::Value CreateEntity(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || !info[0].IsNumber()) {
+      Napi::TypeError::New(env, "Expected a component mask")
+          .ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    uint32_t entity = entities.create(info[0].As<Napi::Number>().Uint32Value());
+    InvalidateColumns();
+    if (entity && info.Length() >= 2)
+      ApplyEntityProps(entity, info[1]);
+    return Napi::Number::New(env, entity);
+  }
+
+  Napi::Value CreateEntities(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 2 || !info[0].IsNumber() || !info[1].IsNumber()) {
+      Napi::TypeError::New(env, "Expected count and component mask arguments")
+          .ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    int count = info[0].As<Napi::Number>().Int32Value();
+    uint32_t mask = info[1].As<Napi::Number>().Uint32Value();
+    entityResults.clear();
+    // One reservation up front, so a batch moves each column at most once.
+    if (count > 0)
+      entities.reserve(mask, (size_t)std::min<int>(count, EntityStore::MaxEntities));
+    InvalidateColumns();
+    for (int i = 0; i < count; i++) {
+      uint32_t entity = entities.create(mask);
+      if (!entity)
+        break;
+      if (info.Length() >= 3)
+        ApplyEntityProps(entity, info[2]);
+      entityResults.push_back(entity);
+    }
+    return EntityResults(env);
+  }
+
+  Napi::Value DestroyEntity(const Napi::CallbackInfo &info) {
+    if (info.Length() >= 1 && info[0].IsNumber()) {
+      uint32_t entity = info[0].As<Napi::Number>().Uint32Value();
+      if (entities.alive(entity)) {
+        entities.destroy(entity);
+        InvalidateColumns();
+      }
+    }
+    return info.Env().Undefined();
+  }
+
+  Napi::Value IsEntityAlive(const Napi::CallbackInfo &info) {
+    bool alive = info.Length() >= 1 && info[0].IsNumber() &&
+                 entities.alive(info[0].As<Napi::Number>().Uint32Value());
+    return Napi::Boolean::New(info.Env(), alive);
+  }
+
+  Napi::Value ChangeComponents(const Napi::CallbackInfo &info, bool add) {
+    if (info.Length() >= 2) {
+      uint32_t entity = info[0].As<Napi::Number>().Uint32Value();
+      uint32_t bits = info[1].As<Napi::Number>().Uint32Value();
+      uint32_t mask = entities.getMask(entity);
+      uint32_t next = add ? mask | bits : mask & ~bits;
+      if (entities.alive(entity) && next != mask) {
+        entities.setMask(entity, next);
+        InvalidateColumns();
+        if (add && info.Length() >= 3)
+          ApplyEntityProps(entity, info[2]);
+      }
+    }
+    return info.Env().Undefined();
+  }
+
+  Napi::Value AddComponents(const Napi::CallbackInfo &info) {
+    return ChangeComponents(info, true);
+  }
+
+  Napi::Value RemoveComponents(const Napi::CallbackInfo &info) {
+    return ChangeComponents(info, false);
+  }
+
+  Napi::Value SetEntity(const Napi::CallbackInfo &info) {
+    if (info.Length() >= 2 && info[0].IsNumber())
+      ApplyEntityProps(info[0].As<Napi::Number>().Uint32Value(), info[1]);
+    return info.Env().Undefined();
+  }
+
+  Napi::Value GetEntity(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+    uint32_t entity =
+        info.Length() >= 1 && info[0].IsNumber() ? info[0].As<Napi::Number>().Uint32Value() : 0;
+    if (!entities.alive(entity))
+      return env.Undefined();
+
+    Napi::Object out = Napi::Object::New(env);
+    out.Set("mask", entities.getMask(entity));
+    for (int field = 0; field < EntityStore::FloatFieldCount; field++) {
+      if (float *value = entities.floatField(entity, (EntityStore::Field)field))
+        out.Set(EntityStore::fieldName((EntityStore::Field)field), *value);
+    }
+    if (int32_t *texture = entities.textureField(entity))
+      out.Set("texture", *texture);
+    if (uint32_t *tint = entities.tintField(entity))
+      out.Set("tint", *tint);
+    return out;
+  }
+
+  Napi::Value GetArchetypes(const Napi::CallbackInfo &info) {
+    queryResults.clear();
+    uint32_t mask = info.Length() >= 1 && info[0].IsNumber()
+                        ? info[0].As<Napi::Number>().Uint32Value()
+                        : 0;
+    entities.matching(mask, queryResults);
+    return QueryResults(info.Env());
+  }
+
+  EntityStore::Archetype *GetArchetype(const Napi::Value &value) {
+    if (!value.IsNumber())
+      return nullptr;
+    int index = value.As<Napi::Number>().Int32Value();
+    if (index < 0 || index >= (int)entities.archetypeCount())
+      return nullptr;
+    return &entities.getArchetype(index);
+  }
+
+  Napi::Value GetArchetypeMask(const Napi::CallbackInfo &info) {
+    EntityStore::Archetype *archetype = info.Length() >= 1 ? GetArchetype(info[0]) : nullptr;
+    return Napi::Number::New(info.Env(), archetype ? archetype->mask : 0);
+  }
+
+  Napi::Value GetArchetypeSize(const Napi::CallbackInfo &info) {
+    EntityStore::Archetype *archetype = info.Length() >= 1 ? GetArchetype(info[0]) : nullptr;
+    return Napi::Number::New(info.Env(), archetype ? (double)archetype->size() : 0.0);
+  }
+
+  template <typename T>
+  Napi::Value ColumnView(Napi::Env env, uint32_t key, std::vector<T> &column) {
+    if (column.empty())
+      return Napi::TypedArrayOf<T>::New(env, 0);
+    auto cached = columnViews.find(key);
+    Napi::ArrayBuffer buffer;
+    if (cached != columnViews.end())
+      buffer = cached->second.buffer.Value();
+    if (!buffer.IsEmpty() && cached->second.data != column.data()) {
+      if (!buffer.IsDetached())
+        buffer.Detach();
+      buffer = Napi::ArrayBuffer();
+    }
+    if (buffer.IsEmpty()) {
+      // One external buffer per column: V8 refuses to wrap the same memory
+      // twice, and sharing it keeps repeated getColumn calls allocation free.
+      // It spans the whole capacity so the column can grow in place.
+      buffer = Napi::ArrayBuffer::New(env, column.data(), column.capacity() * sizeof(T));
+      columnViews[key] = ColumnViewEntry{column.data(), Napi::Weak(buffer)};
+    }
+    return Napi::TypedArrayOf<T>::New(env, column.size(), buffer, 0);
+  }
+
+  Napi::Value GetColumn(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+    EntityStore::Archetype *archetype = info.Length() >= 2 ? GetArchetype(info[0]) : nullptr;
+    if (!archetype || !info[1].IsString()) {
+      Napi::TypeError::New(env, "Expected an archetype and a field name")
+          .ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+
+    bool found = false;
+    EntityStore::Field field =
+        EntityStore::fieldByName(info[1].As<Napi::String>().Utf8Value().c_str(), found);
+    if (!found || (EntityStore::fieldComponent(field) &&
+                   !(archetype->mask & EntityStore::fieldComponent(field))))
+      return env.Undefined();
+
+    uint32_t key = (uint32_t)info[0].As<Napi::Number>().Int32Value() * EntityStore::FieldCount +
+                   field;
+    if (field < EntityStore::FloatFieldCount)
+      return ColumnView(env, key, archetype->floats[field]);
+    if (field == EntityStore::Texture)
+      return ColumnView(env, key, archetype->textures);
+    if (field == EntityStore::Tint)
+      return ColumnView(env, key, archetype->tints);
+    return ColumnView(env, key, archetype->entities);
+  }
+
+  Napi::Value UpdateEntities(const Napi::CallbackInfo &info) {
+    float dt = info.Length() >= 1 && info[0].IsNumber()
+                   ? info[0].As<Napi::Number>().FloatValue()
+                   : (float)timer->getDelta();
+    entityResults.clear();
+    entities.integrate(dt);
+    entities.expire(dt, entityResults);
+    if (!entityResults.empty())
+      InvalidateColumns();
+    return EntityResults(info.Env());
+  }
+
+  Napi::Value CullEntities(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 4) {
+      Napi::TypeError::New(env, "Expected x, y, width and height arguments")
+          .ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    Rect bounds{info[0].As<Napi::Number>().FloatValue(),
+                info[1].As<Napi::Number>().FloatValue(),
+                info[2].As<Napi::Number>().FloatValue(),
+                info[3].As<Napi::Number>().FloatValue()};
+    uint32_t mask = info.Length() >= 5 && info[4].IsNumber()
+                        ? info[4].As<Napi::Number>().Uint32Value()
+                        : 0;
+    entityResults.clear();
+    entities.cull(bounds, mask, entityResults);
+    if (!entityResults.empty())
+      InvalidateColumns();
+    return EntityResults(env);
+  }
+
+  Napi::Value CollideEntities(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 2) {
+      Napi::TypeError::New(env, "Expected two component masks")
+          .ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    entityResults.clear();
+    entities.collide(info[0].As<Napi::Number>().Uint32Value(),
+                     info[1].As<Napi::Number>().Uint32Value(), entityResults);
+    return EntityResults(env);
+  }
+
+  Napi::Value DrawEntities(const Napi::CallbackInfo &info) {
+    spriteTextures.resize(spriteTextureKeys.size());
+    for (size_t slot = 0; slot < spriteTextureKeys.size(); slot++) {
+      auto it = textures.find(spriteTextureKeys[slot]);
+      spriteTextures[slot] = it != textures.end() ? it->second : nullptr;
+    }
+    entities.render(*graphics, spriteTextures);
+    // Drop the references again so an unloaded texture is freed right away.
+    std::fill(spriteTextures.begin(), spriteTextures.end(), nullptr);
+    return info.Env().Undefined();
+  }
+
+  NoiseRequest ParseNoiseOptions(const Napi::Value &value) {
+    NoiseRequest request;
+    if (!value.IsObject())
+      return request;
+    Napi::Object options = value.As<Napi::Object>();
+    if (options.Has("type")) {
+      std::string type = options.Get("type").As<Napi::String>().Utf8Value();
+      if (type == "value")
+        request.params.type = Noise::Type::Value;
+      else if (type == "simplex")
+        request.params.type = Noise::Type::Simplex;
+      else
+        request.params.type = Noise::Type::Perlin;
+    }
+    if (options.Has("octaves"))
+      request.params.octaves = options.Get("octaves").As<Napi::Number>().Int32Value();
+    if (options.Has("frequency"))
+      request.params.frequency = options.Get("frequency").As<Napi::Number>().FloatValue();
+    if (options.Has("lacunarity"))
+      request.params.lacunarity = options.Get("lacunarity").As<Napi::Number>().FloatValue();
+    if (options.Has("gain"))
+      request.params.gain = options.Get("gain").As<Napi::Number>().FloatValue();
+    if (options.Has("x"))
+      request.x = options.Get("x").As<Napi::Number>().FloatValue();
+    if (options.Has("y"))
+      request.y = options.Get("y").As<Napi::Number>().FloatValue();
+    if (options.Has("z")) {
+      request.z = options.Get("z").As<Napi::Number>().FloatValue();
+      request.hasZ = true;
+    }
+    if (options.Has("step"))
+      request.step = options.Get("step").As<Napi::Number>().FloatValue();
+    if (options.Has("threads"))
+      request.threads = options.Get("threads").As<Napi::Number>().Int32Value();
+    return request;
+  }
+
+  void FillNoiseGrid(float *out, int width, int height, const NoiseRequest &request) {
+    if (request.hasZ) {
+      noise->fillGrid(out, width, height, request.x, request.y, request.z,
+                      request.step, request.params, request.threads);
+    } else {
+      noise->fillGrid(out, width, height, request.x, request.y, request.step,
+                      request.params, request.threads);
+    }
+  }
+
+  Napi::Value NoiseSample(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || !info[0].IsNumber()) {
+      Napi::TypeError::New(env, "Expected a coordinate").ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+
+    // Trailing coordinates are optional; an options object may follow them.
+    float coords[3];
+    size_t dimensions = 0;
+    while (dimensions < 3 && dimensions < info.Length() && info[dimensions].IsNumber()) {
+      coords[dimensions] = info[dimensions].As<Napi::Number>().FloatValue();
+      dimensions++;
+    }
+    Noise::Params params = dimensions < info.Length()
+                               ? ParseNoiseOptions(info[dimensions]).params
+                               : Noise::Params();
+
+    float value = dimensions == 1   ? noise->sample(coords[0], params)
+                  : dimensions == 2 ? noise->sample(coords[0], coords[1], params)
+                                    : noise->sample(coords[0], coords[1], coords[2], params);
+    return Napi::Number::New(env, value);
+  }
+
+  Napi::Value FillNoise(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 3 || !IsTypedArrayOf(info[0], napi_float32_array)) {
+      Napi::TypeError::New(env, "Expected a Float32Array, width and height")
+          .ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    Napi::Float32Array out = info[0].As<Napi::Float32Array>();
+    int width = info[1].As<Napi::Number>().Int32Value();
+    int height = info[2].As<Napi::Number>().Int32Value();
+    if (width <= 0 || height <= 0 || out.ElementLength() < (size_t)width * height) {
+      Napi::RangeError::New(env, "Float32Array is smaller than width * height")
+          .ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    NoiseRequest request =
+        ParseNoiseOptions(info.Length() >= 4 ? info[3] : env.Undefined());
+    FillNoiseGrid(out.Data(), width, height, request);
+    return out;
+  }
+
+  Napi::Value SampleNoise(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 3 || !IsTypedArrayOf(info[0], napi_float32_array) ||
+        !IsTypedArrayOf(info[1], napi_float32_array)) {
+      Napi::TypeError::New(env, "Expected Float32Array points, Float32Array out and dimensions")
+          .ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    Napi::Float32Array points = info[0].As<Napi::Float32Array>();
+    Napi::Float32Array out = info[1].As<Napi::Float32Array>();
+    int dimensions = info[2].As<Napi::Number>().Int32Value();
+    if (dimensions < 1 || dimensions > 3) {
+      Napi::RangeError::New(env, "Dimensions must be 1, 2 or 3")
+          .ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    size_t count = std::min(points.ElementLength() / dimensions, out.ElementLength());
+    Noise::Params params = info.Length() >= 4 ? ParseNoiseOptions(info[3]).params
+                                              : Noise::Params();
+    noise->fillPoints(out.Data(), points.Data(), count, dimensions, params);
+    return out;
+  }
+
+  bool UploadNoise(const std::shared_ptr<Texture> &texture, const NoiseRequest &request) {
+    size_t count = (size_t)texture->width * texture->height;
+    noiseSamples.resize(count);
+    noisePixels.resize(count * 4);
+    FillNoiseGrid(noiseSamples.data(), texture->width, texture->height, request);
+    for (size_t i = 0; i < count; i++) {
+      float v = std::min(1.0f, std::max(-1.0f, noiseSamples[i]));
+      uint8_t level = (uint8_t)((v * 0.5f + 0.5f) * 255.0f + 0.5f);
+      uint8_t *pixel = &noisePixels[i * 4];
+      pixel[0] = pixel[1] = pixel[2] = level;
+      pixel[3] = 255;
+    }
+    bool updated = false;
+    graphics->runOnRenderer([&] {
+      updated = SDL_UpdateTexture(texture->texture, nullptr, noisePixels.data(),
+                                  texture->width * 4) == 0;
+      if (graphics->isSoftware())
+        texture->mirror(noisePixels.data(), texture->width * 4, SDL_PIXELFORMAT_RGBA32);
+    });
+    return updated;
+  }
+
+  Napi::Value CreateNoiseTexture(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 2) {
+      Napi::TypeError::New(env, "Expected width and height arguments")
+          .ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+
+    int width = info[0].As<Napi::Number>().Int32Value();
+    int height = info[1].As<Napi::Number>().Int32Value();
+    SDL_Texture *handle = nullptr;
+    graphics->runOnRenderer([&] {
+      handle = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA32,
+                                 SDL_TEXTUREACCESS_STREAMING, width, height);
+    });
+    if (!handle) {
+      return env.Undefined();
+    }
+
+    auto texture = std::make_shared<Texture>();
+    texture->texture = handle;
+    texture->width = width;
+    texture->height = height;
+    NoiseRequest request =
+        ParseNoiseOptions(info.Length() >= 3 ? info[2] : env.Undefined());
+    if (info.Length() < 3 || !info[2].IsObject() ||
+        !info[2].As<Napi::Object>().Has("step")) {
+      // Four lattice cells across the texture unless told otherwise.
+      request.step = 4.0f / std::max(1, width);
+    }
+    std::string key = "noise:" + std::to_string(nextNoiseTextureId++);
+    if (!WithinMemoryBudget(MeasureMemory().total() + texture->bytes(), "noise texture",
+                            key)) {
+      graphics->retire(std::move(texture));
+      return env.Undefined();
+    }
+    UploadNoise(texture, request);
+    StoreTexture(key, texture);
+    return Napi::String::New(env, key);
+  }
+
+  Napi::Value UpdateNoiseTexture(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || !info[0].IsString()) {
+      Napi::TypeError::New(env, "Expected a noise texture").ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+
+    std::string key = info[0].As<Napi::String>().Utf8Value();
+    auto it = textures.find(key);
+    if (it == textures.end() || key.compare(0, 6, "noise:") != 0) {
+      return Napi::Boolean::New(env, false);
+    }
+    NoiseRequest request =
+        ParseNoiseOptions(info.Length() >= 2 ? info[1] : env.Undefined());
+    if (info.Length() < 2 || !info[1].IsObject() ||
+        !info[1].As<Napi::Object>().Has("step")) {
+      request.step = 4.0f / std::max(1, it->second->width);
+    }
+    // New pixels under an unchanged draw call are invisible to retained mode.
+    graphics->invalidate();
+    return Napi::Boolean::New(env, UploadNoise(it->second, request));
+  }
+};
+
+// Headless simulation: no SDL initialization, so any number can live in a
+// server process. stepAll advances many of them across a shared pool.
+class TensaiSimulation : public Napi::ObjectWrap<TensaiSimulation> {
+private:
+  std::unique_ptr<Simulation> simulation;
+
+  static ThreadPool &Pool(Napi::Env env) {
+    AddonData *data = env.GetInstanceData<AddonData>();
+    if (!data->pool)
+      data->pool = std::make_unique<ThreadPool>();
+    return *data->pool;
+  }
+
+  static Napi::Object Snapshot(Napi::Env env, const Simulation::Snapshot &snapshot) {
+    Napi::Object out = Napi::Object::New(env);
+    out.Set("tick", (double)snapshot.tick);
+    out.Set("time", snapshot.time);
+    Napi::Float32Array bodies = Napi::Float32Array::New(env, snapshot.bodies.size());
+    std::copy(snapshot.bodies.begin(), snapshot.bodies.end(), bodies.Data());
+    out.Set("bodies", bodies);
+    Napi::Int32Array contacts = Napi::Int32Array::New(env, snapshot.contacts.size());
+    std::copy(snapshot.contacts.begin(), snapshot.contacts.end(), contacts.Data());
+    out.Set("contacts", contacts);
+    return out;
+  }
+
+  PhysicsWorld::Object *GetBody(const Napi::CallbackInfo &info) {
+    if (info.Length() < 1 || !info[0].IsNumber())
+      return nullptr;
+    return simulation->getWorld().get(info[0].As<Napi::Number>().Int32Value());
+  }
+
+  static int Ticks(const Napi::CallbackInfo &info, size_t index) {
+    return info.Length() > index && info[index].IsNumber()
+               ? std::max(0, info[index].As<Napi::Number>().Int32Value())
+               : 1;
+  }
+
+public:
+  static Napi::Object Init(Napi::Env env, Napi::Object exports) {
+    Napi::Function func = DefineClass(
+        env, "Simulation",
+        {
+            StaticMethod("stepAll", &TensaiSimulation::StepAll),
+            InstanceMethod("step", &TensaiSimulation::Step),
+            InstanceMethod("getTick", &TensaiSimulation::GetTick),
+            InstanceMethod("getTime", &TensaiSimulation::GetTime),
+            InstanceMethod("setGravity", &TensaiSimulation::SetGravity),
+            InstanceMethod("addBody", &TensaiSimulation::AddBody),
+            InstanceMethod("removeBody", &TensaiSimulation::RemoveBody),
+            InstanceMethod("setBodyPosition", &TensaiSimulation::SetBodyPosition),
+            InstanceMethod("setBodyVelocity", &TensaiSimulation::SetBodyVelocity),
+            InstanceMethod("applyForce", &TensaiSimulation::ApplyForce),
+            InstanceMethod("setKey", &TensaiSimulation::SetKey),
+            InstanceMethod("setMouse", &TensaiSimulation::SetMouse),
+            InstanceMethod("isKeyDown", &TensaiSimulation::IsKeyDown),
+            InstanceMethod("isKeyPressed", &TensaiSimulation::IsKeyPressed),
+            InstanceMethod("isKeyReleased", &TensaiSimulation::IsKeyReleased),
+            InstanceMethod("isMouseDown", &TensaiSimulation::IsMouseDown),
+            InstanceMethod("randomInt", &TensaiSimulation::RandomInt),
+            InstanceMethod("randomFloat", &TensaiSimulation::RandomFloat),
+            InstanceMethod("randomBool", &TensaiSimulation::RandomBool),
+            InstanceMethod("getSeed", &TensaiSimulation::GetSeed),
+        });
+    env.GetInstanceData<AddonData>()->simulation = Napi::Persistent(func);
+    exports.Set("Simulation", func);
+    return exports;
+  }
+
+  TensaiSimulation(const Napi::CallbackInfo &info)
+      : Napi::ObjectWrap<TensaiSimulation>(info) {
+    uint64_t seed = Random().getSeed();
+    float cellSize = 64.0f;
+    double timestep = 1.0 / 60.0;
+    if (info.Length() >= 1 && info[0].IsObject()) {
+      Napi::Object options = info[0].As<Napi::Object>();
+      if (options.Has("seed"))
+        seed = (uint64_t)options.Get("seed").As<Napi::Number>().Int64Value();
+      if (options.Has("cellSize"))
+        cellSize = options.Get("cellSize").As<Napi::Number>().FloatValue();
+      if (options.Has("timestep"))
+        timestep = options.Get("timestep").As<Napi::Number>().DoubleValue();
+    }
+    simulation = std::make_unique<Simulation>(seed, cellSize, timestep);
+  }
+
+  // Steps each simulation `ticks` times, spread across the pool, and
+  // returns their snapshots in order.
+  static Napi::Value StepAll(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || !info[0].IsArray()) {
+      Napi::TypeError::New(env, "Expected an array of simulations")
+          .ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    Napi::Array list = info[0].As<Napi::Array>();
+    Napi::Function constructor = env.GetInstanceData<AddonData>()->simulation.Value();
+    std::vector<Simulation *> simulations;
+    for (uint32_t i = 0; i < list.Length(); i++) {
+      Napi::Value item = list.Get(i);
+      if (!item.IsObject() || !item.As<Napi::Object>().InstanceOf(constructor)) {
+        Napi::TypeError::New(env, "Expected an array of simulations")
+            .ThrowAsJavaScriptException();
+        return env.Undefined();
+      }
+      simulations.push_back(Unwrap(item.As<Napi::Object>())->simulation.get());
+    }
+
+    // The same simulation twice would be stepped from two threads at once.
+    std::vector<Simulation *> unique = simulations;
+    std::sort(unique.begin(), unique.end());
+    if (std::adjacent_find(unique.begin(), unique.end()) != unique.end()) {
+      Napi::TypeError::New(env, "Simulations must not repeat")
+          .ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+
+    int ticks = Ticks(info, 1);
+    Pool(env).parallelFor((int)simulations.size(),
+                          [&](int i) { simulations[i]->step(ticks); });
+    Napi::Array out = Napi::Array::New(env, simulations.size());
+    for (uint32_t i = 0; i < simulations.size(); i++)
+      out.Set(i, Snapshot(env, simulations[i]->getSnapshot()));
+    return out;
+  }
+
+  Napi::Value Step(const Napi::CallbackInfo &info) {
+    simulation->step(Ticks(info, 0));
+    return Snapshot(info.Env(), simulation->getSnapshot());
+  }
+
+  Napi::Value GetTick(const Napi::CallbackInfo &info) {
+    return Napi::Number::New(info.Env(), (double)simulation->getTick());
+  }
+
+  Napi::Value GetTime(const Napi::CallbackInfo &info) {
+    return Napi::Number::New(info.Env(), simulation->getTimer().getTime());
+  }
+
+  Napi::Value SetGravity(const Napi::CallbackInfo &info) {
+    if (info.Length() >= 2) {
+      simulation->getWorld().setGravity(Vec2(info[0].As<Napi::Number>().FloatValue(),
+                                             info[1].As<Napi::Number>().FloatValue()));
+    }
+    return info.Env().Undefined();
+  }
+
+  Napi::Value AddBody(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || !info[0].IsObject()) {
+      Napi::TypeError::New(env, "Expected body options").ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    return Napi::Number::New(
+        env, simulation->getWorld().add(ParseBody(info[0].As<Napi::Object>())));
+  }
+
+  Napi::Value RemoveBody(const Napi::CallbackInfo &info) {
+    if (GetBody(info))
+      simulation->getWorld().remove(info[0].As<Napi::Number>().Int32Value());
+    return info.Env().Undefined();
+  }
+
+  Napi::Value SetBodyPosition(const Napi::CallbackInfo &info) {
+    PhysicsWorld::Object *object = GetBody(info);
+    if (object && info.Length() >= 3) {
+      object->body.position = Vec2(info[1].As<Napi::Number>().FloatValue(),
+                                   info[2].As<Napi::Number>().FloatValue());
+    }
+    return info.Env().Undefined();
+  }
+
+  Napi::Value SetBodyVelocity(const Napi::CallbackInfo &info) {
+    PhysicsWorld::Object *object = GetBody(info);
+    if (object && info.Length() >= 3) {
+      object->body.velocity = Vec2(info[1].As<Napi::Number>().FloatValue(),
+                                   info[2].As<Napi::Number>().FloatValue());
+    }
+    return info.Env().Undefined();
+  }
+
+  Napi::Value ApplyForce(const Napi::CallbackInfo &info) {
+    PhysicsWorld::Object *object = GetBody(info);
+    if (object && info.Length() >= 3) {
+      Physics::applyForce(object->body, Vec2(info[1].As<Napi::Number>().FloatValue(),
+                                             info[2].As<Napi::Number>().FloatValue()));
+    }
+    return info.Env().Undefined();
+  }
+
+  // setKey(key, pressed, tick?): without a tick the change lands on the next
+  // step.
+  Napi::Value SetKey(const Napi::CallbackInfo &info) {
+    if (info.Length() >= 2) {
+      uint64_t tick = info.Length() >= 3 && info[2].IsNumber()
+                          ? (uint64_t)info[2].As<Napi::Number>().Int64Value()
+                          : simulation->getTick();
+      simulation->queueKey(tick, info[0].As<Napi::Number>().Int32Value(),
+                           info[1].As<Napi::Boolean>().Value());
+    }
+    return info.Env().Undefined();
+  }
+
+  Napi::Value SetMouse(const Napi::CallbackInfo &info) {
+    if (info.Length() >= 2) {
+      uint64_t tick = info.Length() >= 3 && info[2].IsNumber()
+                          ? (uint64_t)info[2].As<Napi::Number>().Int64Value()
+                          : simulation->getTick();
+      simulation->queueMouse(tick, info[0].As<Napi::Number>().Int32Value(),
+                             info[1].As<Napi::Boolean>().Value());
+    }
+    return info.Env().Undefined();
+  }
+
+  Napi::Value IsKeyDown(const Napi::CallbackInfo &info) {
+    return Napi::Boolean::New(info.Env(), info.Length() >= 1 &&
+                                              simulation->getInput().isDown(
+                                                  info[0].As<Napi::Number>().Int32Value()));
+  }
+
+  Napi::Value IsKeyPressed(const Napi::CallbackInfo &info) {
+    return Napi::Boolean::New(info.Env(), info.Length() >= 1 &&
+                                              simulation->getInput().isPressed(
+                                                  info[0].As<Napi::Number>().Int32Value()));
+  }
+
+  Napi::Value IsKeyReleased(const Napi::CallbackInfo &info) {
+    return Napi::Boolean::New(info.Env(), info.Length() >= 1 &&
+                                              simulation->getInput().isReleased(
+                                                  info[0].As<Napi::Number>().Int32Value()));
+  }
+
+  Napi::Value IsMouseDown(const Napi::CallbackInfo &info) {
+    return Napi::Boolean::New(info.Env(), info.Length() >= 1 &&
+                                              simulation->getInput().isMouseDown(
+                                                  info[0].As<Napi::Number>().Int32Value()));
+  }
+
+  Napi::Value RandomInt(const Napi::CallbackInfo &info) {
+    Random &random = simulation->getRandom();
+    if (info.Length() >= 2) {
+      return Napi::Number::New(info.Env(),
+                               random.randomInt(info[0].As<Napi::Number>().Int32Value(),
+                                                info[1].As<Napi::Number>().Int32Value()));
+    }
+    return Napi::Number::New(info.Env(), random.randomInt(0, 1));
+  }
+
+  Napi::Value RandomFloat(const Napi::CallbackInfo &info) {
+    Random &random = simulation->getRandom();
+    if (info.Length() >= 2) {
+      return Napi::Number::New(info.Env(),
+                               random.randomFloat(info[0].As<Napi::Number>().FloatValue(),
+                                                  info[1].As<Napi::Number>().FloatValue()));
+    }
+    return Napi::Number::New(info.Env(), random.randomFloat());
+  }
+
+  Napi::Value RandomBool(const Napi::CallbackInfo &info) {
+    return Napi::Boolean::New(info.Env(), simulation->getRandom().randomBool());
+  }
+
+  Napi::Value GetSeed(const Napi::CallbackInfo &info) {
+    return Napi::Number::New(info.Env(), (double)simulation->getRandom().getSeed());
+  }
+};
+
+Napi::Object CreateTensai(const Napi::CallbackInfo &info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 5) {
+    Napi::TypeError::New(env, "Expected 5 arguments")
+        .ThrowAsJavaScriptException();
+    return Napi::Object::New(env);
+  }
+
+  Napi::FunctionReference &constructor = env.GetInstanceData<AddonData>()->engine;
+  if (info.Length() >= 6) {
+    return constructor.New({info[0], info[1], info[2], info[3], info[4], info[5]});
+  }
+  return constructor.New({info[0], info[1], info[2], info[3], info[4]});
 }
 
 Napi::Object Init(Napi::Env env, Napi::Object exports) {
+  env.SetInstanceData(new AddonData());
   TensaiEngine::Init(env, exports);
+  TensaiSimulation::Init(env, exports);
   exports.Set("Tensai", Napi::Function::New(env, CreateTensai));
 
   Napi::Object keys = Napi::Object::New(env);
@@ -740,6 +2980,25 @@ Napi::Object Init(Napi::Env env, Napi::Object exports) {
   mouse.Set("RIGHT", Napi::Number::New(env, SDL_BUTTON_RIGHT));
   exports.Set("Mouse", mouse);
 
+  Napi::Object tiles = Napi::Object::New(env);
+  tiles.Set("EMPTY", Napi::Number::New(env, TileMap::Empty));
+  tiles.Set("SOLID", Napi::Number::New(env, TileMap::Solid));
+  tiles.Set("ONE_WAY", Napi::Number::New(env, TileMap::OneWay));
+  tiles.Set("SLOPE_UP", Napi::Number::New(env, TileMap::SlopeUp));
+  tiles.Set("SLOPE_DOWN", Napi::Number::New(env, TileMap::SlopeDown));
+  exports.Set("Tiles", tiles);
+
+  Napi::Object components = Napi::Object::New(env);
+  components.Set("TRANSFORM", Napi::Number::New(env, EntityStore::Transform));
+  components.Set("VELOCITY", Napi::Number::New(env, EntityStore::Velocity));
+  components.Set("LIFETIME", Napi::Number::New(env, EntityStore::Lifetime));
+  components.Set("SPRITE", Napi::Number::New(env, EntityStore::Sprite));
+  components.Set("COLLIDER", Napi::Number::New(env, EntityStore::Collider));
+  for (int i = 0; i < 8; i++) {
+    components.Set("TAG" + std::to_string(i), Napi::Number::New(env, 1 << (8 + i)));
+  }
+  exports.Set("Components", components);
+
   return exports;
 }
 
@@ -5,7 +5,7 @@ Attachments: test/test.js
 */
 
 
-const { Tensai, Keys, Mouse } = require('../index.js');
+const { Tensai, Keys, Mouse, Tiles } = require('../index.js');
 const tensai = Tensai("Tensai Platformer", 1280, 720, true, true);
 const GRAVITY = 980;
 const JUMP_FORCE = -450;
@@ -30,6 +30,10 @@ let player = {
 
 let camera = { x: 0, y: 0 };
 let platforms = [];
+const TILE_SIZE = 10;
+const MAP_WIDTH = 280;
+const MAP_HEIGHT = 72;
+const levelMap = tensai.createTileMap(MAP_WIDTH, MAP_HEIGHT, TILE_SIZE);
 let enemies = [];
 let collectibles = [];
 let particles = [];
@@ -68,6 +72,16 @@ function generateLevel() {
     { x: 2500, y: 200, width: 200, height: 20, type: "platform" },
   ];
 
+  const tiles = new Uint8Array(MAP_WIDTH * MAP_HEIGHT);
+  for (const platform of platforms) {
+    for (let ty = platform.y / TILE_SIZE; ty < (platform.y + platform.height) / TILE_SIZE; ty++) {
+      for (let tx = platform.x / TILE_SIZE; tx < (platform.x + platform.width) / TILE_SIZE; tx++) {
+        tiles[ty * MAP_WIDTH + tx] = Tiles.SOLID;
+      }
+    }
+  }
+  tensai.setTiles(levelMap, tiles);
+
   enemies = [
     { x: 300, y: 540, vx: 50, width: 24, height: 24, health: 1, dir: 1, platform: 1 },
     { x: 700, y: 340, vx: 30, width: 24, height: 24, health: 1, dir: -1, platform: 3 },
@@ -142,31 +156,15 @@ tensai.update = (dt) => {
     player.vx *= GROUND_FRICTION;
   } else {
     player.vx *= AIR_RESISTANCE;
-    player.vy += GRAVITY * dt;
   }
+  // Gravity always applies so a grounded player keeps probing the floor.
+  player.vy += GRAVITY * dt;
   
-  player.x += player.vx * dt;
-  player.y += player.vy * dt;
-  player.grounded = false;
-  for (const platform of platforms) {
-    if (checkCollision(player, platform)) {
-      if (prevY + player.height <= platform.y && player.vy >= 0) {
-        player.y = platform.y - player.height;
-        player.vy = 0;
-        player.grounded = true;
-        player.canJump = true;
-        player.jumpCount = 0;
-      } else if (prevY >= platform.y + platform.height && player.vy <= 0) {
-        player.y = platform.y + platform.height;
-        player.vy = 0;
-      } else if (prevX + player.width <= platform.x) {
-        player.x = platform.x - player.width;
-        player.vx = 0;
-      } else if (prevX >= platform.x + platform.width) {
-        player.x = platform.x + platform.width;
-        player.vx = 0;
-      }
-    }
+  const move = tensai.moveAndCollide(levelMap, player, player.vx * dt, player.vy * dt);
+  player.grounded = move.grounded;
+  if (move.grounded) {
+    player.canJump = true;
+    player.jumpCount = 0;
   }
   
   for (let i = enemies.length - 1; i >= 0; i--) {
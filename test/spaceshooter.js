@@ -455,27 +455,51 @@ function updateStars(dt) {
     }
 }
 
+const enemyIndex = tensai.createSpatialIndex(128);
+let enemyBoxes = new Float32Array(64);
+
 function handleCollisions() {
+    if (enemyBoxes.length < enemies.length * 4) {
+        enemyBoxes = new Float32Array(enemies.length * 8);
+    }
+    enemies.forEach((enemy, j) => {
+        enemyBoxes[j * 4] = enemy.x;
+        enemyBoxes[j * 4 + 1] = enemy.y;
+        enemyBoxes[j * 4 + 2] = enemy.x + enemy.width;
+        enemyBoxes[j * 4 + 3] = enemy.y + enemy.height;
+    });
+    tensai.buildSpatialIndex(enemyIndex, enemyBoxes.subarray(0, enemies.length * 4));
+
+    const killed = new Set();
     for (let i = bullets.length - 1; i >= 0; i--) {
         const bullet = bullets[i];
-        for (let j = enemies.length - 1; j >= 0; j--) {
-            const enemy = enemies[j];
-            if (checkCollision(bullet, enemy)) {
-                enemy.health -= bullet.damage;
-                bullets.splice(i, 1);
-                if (enemy.health <= 0) {
-                    score += enemy.points;
-                    createExplosion(enemy.x + enemy.width/2, enemy.y + enemy.height/2);
-                    if (Math.random() < 0.3) {
-                        createPowerup(enemy.x, enemy.y);
-                    }
-                    
-                    enemies.splice(j, 1);
-                }
-                break;
+        const nearby = tensai.queryAABB(enemyIndex, bullet.x, bullet.y,
+                                        bullet.x + bullet.width, bullet.y + bullet.height);
+        let target = -1;
+        for (const j of nearby) {
+            if (j > target && !killed.has(j) && checkCollision(bullet, enemies[j])) {
+                target = j;
+            }
+        }
+        if (target < 0) {
+            continue;
+        }
+
+        const enemy = enemies[target];
+        enemy.health -= bullet.damage;
+        bullets.splice(i, 1);
+        if (enemy.health <= 0) {
+            score += enemy.points;
+            createExplosion(enemy.x + enemy.width/2, enemy.y + enemy.height/2);
+            if (Math.random() < 0.3) {
+                createPowerup(enemy.x, enemy.y);
             }
+            killed.add(target);
         }
     }
+    if (killed.size > 0) {
+        enemies = enemies.filter((_, j) => !killed.has(j));
+    }
     
     for (let i = enemyBullets.length - 1; i >= 0; i--) {
         const bullet = enemyBullets[i];
@@ -0,0 +1,144 @@
+#!/usr/bin/env node
+// Builds a .tpak asset pack for TensaiEngine#mountPack.
+//
+//   node tools/pack.js <out.tpak> [--lz4] <file|dir>...
+//
+// Entry names are the paths as given (relative to the current directory,
+// forward slashes), so they match the paths passed to loadTexture & co.
+// With --lz4 each entry is LZ4-compressed when that makes it smaller.
+const fs = require('fs');
+const path = require('path');
+
+const VERSION = 1;
+const FLAG_LZ4 = 1;
+const HEADER_SIZE = 32;
+const ALIGNMENT = 16;
+
+function collect(target, out) {
+  const stat = fs.statSync(target);
+  if (stat.isDirectory()) {
+    for (const name of fs.readdirSync(target).sort()) {
+      collect(path.join(target, name), out);
+    }
+  } else if (stat.isFile()) {
+    out.push(target);
+  }
+}
+
+function normalize(name) {
+  return name.split(path.sep).join('/').replace(/^(\.\/)+/, '');
+}
+
+function writeLength(out, length) {
+  while (length >= 255) {
+    out.push(255);
+    length -= 255;
+  }
+  out.push(length);
+}
+
+function writeSequence(out, src, literalStart, literalEnd, offset, matchLength) {
+  const literals = literalEnd - literalStart;
+  const matchCode = offset ? matchLength - 4 : 0;
+  out.push((Math.min(literals, 15) << 4) | Math.min(matchCode, 15));
+  if (literals >= 15) writeLength(out, literals - 15);
+  for (let i = literalStart; i < literalEnd; i++) out.push(src[i]);
+  if (!offset) return;
+  out.push(offset & 0xff, offset >> 8);
+  if (matchCode >= 15) writeLength(out, matchCode - 15);
+}
+
+// Greedy single-probe LZ4 block compressor; output is readable by any LZ4
+// block decoder, including the one in src/resources/asset_pack.cpp.
+function lz4Compress(src) {
+  const out = [];
+  const table = new Int32Array(1 << 16).fill(-1);
+  const matchLimit = src.length - 12;
+  const hash = (p) => Math.imul(src.readUInt32LE(p), 2654435761) >>> 16;
+  let anchor = 0;
+  let i = 0;
+  while (i < matchLimit) {
+    const h = hash(i);
+    const ref = table[h];
+    table[h] = i;
+    if (ref >= 0 && i - ref <= 65535 && src.readUInt32LE(ref) === src.readUInt32LE(i)) {
+      let length = 4;
+      const maxLength = src.length - 5 - i;
+      while (length < maxLength && src[ref + length] === src[i + length]) length++;
+      writeSequence(out, src, anchor, i, i - ref, length);
+      i += length;
+      anchor = i;
+    } else {
+      i++;
+    }
+  }
+  writeSequence(out, src, anchor, src.length, 0, 0);
+  return Buffer.from(out);
+}
+
+function main(argv) {
+  const args = argv.slice(2);
+  const compress = args.includes('--lz4');
+  const positional = args.filter((a) => a !== '--lz4');
+  if (positional.length < 2) {
+    console.error('Usage: node tools/pack.js <out.tpak> [--lz4] <file|dir>...');
+    process.exit(1);
+  }
+
+  const [output, ...inputs] = positional;
+  const files = [];
+  for (const input of inputs) collect(input, files);
+
+  const fd = fs.openSync(output, 'w');
+  let offset = HEADER_SIZE;
+  const index = [];
+  for (const file of files) {
+    const raw = fs.readFileSync(file);
+    let stored = raw;
+    let flags = 0;
+    if (compress && raw.length > 16) {
+      const packed = lz4Compress(raw);
+      if (packed.length < raw.length) {
+        stored = packed;
+        flags |= FLAG_LZ4;
+      }
+    }
+    offset = Math.ceil(offset / ALIGNMENT) * ALIGNMENT;
+    fs.writeSync(fd, stored, 0, stored.length, offset);
+    index.push({ name: normalize(file), offset, size: stored.length, rawSize: raw.length, flags });
+    offset += stored.length;
+  }
+
+  const records = index.map((entry) => {
+    const name = Buffer.from(entry.name, 'utf8');
+    const record = Buffer.alloc(32 + name.length);
+    record.writeBigUInt64LE(BigInt(entry.offset), 0);
+    record.writeBigUInt64LE(BigInt(entry.size), 8);
+    record.writeBigUInt64LE(BigInt(entry.rawSize), 16);
+    record.writeUInt32LE(entry.flags, 24);
+    record.writeUInt32LE(name.length, 28);
+    name.copy(record, 32);
+    return record;
+  });
+  const indexBuffer = Buffer.concat(records);
+  fs.writeSync(fd, indexBuffer, 0, indexBuffer.length, offset);
+
+  const header = Buffer.alloc(HEADER_SIZE);
+  header.write('TPAK', 0, 'ascii');
+  header.writeUInt32LE(VERSION, 4);
+  header.writeUInt32LE(index.length, 8);
+  header.writeBigUInt64LE(BigInt(offset), 12);
+  header.writeBigUInt64LE(BigInt(indexBuffer.length), 20);
+  fs.writeSync(fd, header, 0, header.length, 0);
+  fs.closeSync(fd);
+
+  const stored = index.reduce((sum, e) => sum + e.size, 0);
+  const raw = index.reduce((sum, e) => sum + e.rawSize, 0);
+  console.log(`${output}: ${index.length} entries, ${stored} bytes stored (${raw} raw)`);
+}
+
+if (require.main === module) {
+  main(process.argv);
+}
+
+module.exports = { lz4Compress };